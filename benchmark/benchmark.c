@@ -0,0 +1,730 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <sys/time.h>
+
+#include "bilinear.h"
+#include "dither.h"
+#include "image.h"
+#include "nearestNeighbour.h"
+#include "pixelPipeline.h"
+#include "resizeDispmanX.h"
+#include "rotate.h"
+#include "transition.h"
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+
+#define ITERATIONS 20
+
+//-------------------------------------------------------------------------
+
+void
+printElapsed(
+    const char *name,
+    const struct timeval *start_time,
+    int iterations)
+{
+    struct timeval end_time;
+    struct timeval diff;
+
+    gettimeofday(&end_time, NULL);
+    timersub(&end_time, start_time, &diff);
+
+    uint32_t total = (diff.tv_sec * 1000000) + diff.tv_usec;
+    uint32_t each = total / iterations;
+
+    printf("    %s took - %d.%06d seconds (%d.%06d each)\n",
+           name,
+           (int)diff.tv_sec,
+           (int)diff.tv_usec,
+           each / 1000000,
+           each % 1000000);
+}
+
+//-------------------------------------------------------------------------
+
+uint8_t *
+createRGB888(
+    int16_t width,
+    int16_t height)
+{
+    uint8_t *rgb = malloc(width * height * 3);
+
+    if (rgb == NULL)
+    {
+        perror("benchmark: memory exhausted");
+        exit(EXIT_FAILURE);
+    }
+
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        int16_t i;
+        for (i = 0 ; i < width ; i++)
+        {
+            uint8_t *pixel = rgb + ((i + (j * width)) * 3);
+
+            pixel[0] = (i * 255) / width;
+            pixel[1] = (j * 255) / height;
+            pixel[2] = ((i + j) * 255) / (width + height);
+        }
+    }
+
+    return rgb;
+}
+
+//-------------------------------------------------------------------------
+
+void
+benchmarkErrorDiffusion(
+    const uint8_t *rgb,
+    IMAGE_T *image,
+    bool serpentine)
+{
+    ERROR_DIFFUSION_T ed;
+    initErrorDiffusion(&ed, image->width, serpentine);
+
+    struct timeval start_time;
+    gettimeofday(&start_time, NULL);
+
+    int n;
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        int16_t j;
+        for (j = 0 ; j < image->height ; j++)
+        {
+            errorDiffuseRow(&ed,
+                            rgb + (j * image->width * 3),
+                            3,
+                            image->buffer + (j * image->width));
+        }
+    }
+
+    printElapsed((serpentine) ? "error diffusion (serpentine)"
+                              : "error diffusion",
+                 &start_time,
+                 ITERATIONS);
+
+    destroyErrorDiffusion(&ed);
+}
+
+//-------------------------------------------------------------------------
+
+void
+benchmarkDither(
+    int16_t width,
+    int16_t height)
+{
+    printf("dither %dx%d RGB888 to RGB565\n", width, height);
+
+    uint8_t *rgb = createRGB888(width, height);
+
+    struct timeval start_time;
+
+    //---------------------------------------------------------------------
+
+    IMAGE_T image;
+    initImage(&image, width, height, true);
+
+    gettimeofday(&start_time, NULL);
+
+    int n;
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        int16_t j;
+        for (j = 0 ; j < height ; j++)
+        {
+            int16_t i;
+            for (i = 0 ; i < width ; i++)
+            {
+                uint8_t *pixel = rgb + ((i + (j * width)) * 3);
+
+                RGB8_T colour = { pixel[0], pixel[1], pixel[2] };
+                setPixelRGB(&image, i, j, &colour);
+            }
+        }
+    }
+
+    printElapsed("ordered (setPixelRGB)", &start_time, ITERATIONS);
+
+    //---------------------------------------------------------------------
+
+    benchmarkErrorDiffusion(rgb, &image, false);
+    benchmarkErrorDiffusion(rgb, &image, true);
+
+    //---------------------------------------------------------------------
+
+    destroyImage(&image);
+    free(rgb);
+
+    printf("\n");
+}
+
+//-------------------------------------------------------------------------
+
+void
+benchmarkResize(
+    int16_t sWidth,
+    int16_t sHeight,
+    int16_t dWidth,
+    int16_t dHeight)
+{
+    printf("resize %dx%d to %dx%d RGB565\n", sWidth, sHeight, dWidth, dHeight);
+
+    uint8_t *rgb = createRGB888(sWidth, sHeight);
+
+    IMAGE_T source;
+    initImage(&source, sWidth, sHeight, false);
+
+    int16_t j;
+    for (j = 0 ; j < sHeight ; j++)
+    {
+        int16_t i;
+        for (i = 0 ; i < sWidth ; i++)
+        {
+            uint8_t *pixel = rgb + ((i + (j * sWidth)) * 3);
+
+            RGB8_T colour = { pixel[0], pixel[1], pixel[2] };
+            setPixelRGB(&source, i, j, &colour);
+        }
+    }
+
+    IMAGE_T image;
+    initImage(&image, dWidth, dHeight, false);
+
+    struct timeval start_time;
+    int n;
+
+    //---------------------------------------------------------------------
+
+    NEAREST_NEIGHBOUR_T nn;
+    initNearestNeighbour(&nn, dWidth, dHeight, sWidth, sHeight, false);
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        resizeNearestNeighbour(&nn,
+                               image.buffer,
+                               image.width * sizeof(uint16_t),
+                               source.buffer,
+                               source.width * sizeof(uint16_t));
+    }
+
+    printElapsed("nearest neighbour", &start_time, ITERATIONS);
+
+    destroyNearestNeighbour(&nn);
+
+    //---------------------------------------------------------------------
+
+    BILINEAR_T bl;
+    initBilinear(&bl, dWidth, dHeight, sWidth, sHeight, false);
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        resizeBilinear(&bl,
+                       image.buffer,
+                       image.width * sizeof(uint16_t),
+                       source.buffer,
+                       source.width * sizeof(uint16_t));
+    }
+
+    printElapsed("bilinear", &start_time, ITERATIONS);
+
+    destroyBilinear(&bl);
+
+    //---------------------------------------------------------------------
+
+    RESIZE_DISPMANX_T rd;
+    initResizeDispmanX(&rd, dWidth, dHeight, sWidth, sHeight, false);
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        resizeDispmanX(&rd,
+                       image.buffer,
+                       image.width * sizeof(uint16_t),
+                       source.buffer,
+                       source.width * sizeof(uint16_t));
+    }
+
+    printElapsed("area average (software dispmanx)", &start_time, ITERATIONS);
+
+    destroyResizeDispmanX(&rd);
+
+    //---------------------------------------------------------------------
+
+    destroyImage(&image);
+    destroyImage(&source);
+    free(rgb);
+
+    printf("\n");
+}
+
+//-------------------------------------------------------------------------
+//
+// RGB888 (as from libjpeg) to big-endian RGB565 for the LCD, first as
+// separate passes (convert with ordered dither, resize, byte swap) and
+// then fused into a single pass per row.
+//
+
+void
+benchmarkPipeline(
+    int16_t sWidth,
+    int16_t sHeight,
+    int16_t dWidth,
+    int16_t dHeight)
+{
+    printf("RGB888 %dx%d to big-endian RGB565 %dx%d\n",
+           sWidth,
+           sHeight,
+           dWidth,
+           dHeight);
+
+    uint8_t *rgb = createRGB888(sWidth, sHeight);
+
+    uint32_t *xrgb = malloc(sWidth * sHeight * sizeof(uint32_t));
+
+    if (xrgb == NULL)
+    {
+        perror("benchmark: memory exhausted");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t k;
+    for (k = 0 ; k < sWidth * sHeight ; k++)
+    {
+        const uint8_t *pixel = rgb + (k * 3);
+
+        xrgb[k] = (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+    }
+
+    IMAGE_T source;
+    initImage(&source, sWidth, sHeight, true);
+
+    IMAGE_T image;
+    initImage(&image, dWidth, dHeight, false);
+
+    struct timeval start_time;
+    int n;
+
+    //---------------------------------------------------------------------
+
+    NEAREST_NEIGHBOUR_T nn;
+    initNearestNeighbour(&nn, dWidth, dHeight, sWidth, sHeight, false);
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        int16_t j;
+        for (j = 0 ; j < sHeight ; j++)
+        {
+            int16_t i;
+            for (i = 0 ; i < sWidth ; i++)
+            {
+                uint8_t *pixel = rgb + ((i + (j * sWidth)) * 3);
+
+                RGB8_T colour = { pixel[0], pixel[1], pixel[2] };
+                setPixelRGB(&source, i, j, &colour);
+            }
+        }
+
+        resizeNearestNeighbour(&nn,
+                               image.buffer,
+                               image.width * sizeof(uint16_t),
+                               source.buffer,
+                               source.width * sizeof(uint16_t));
+
+        htonsRGB565(image.buffer, image.buffer, dWidth * dHeight);
+    }
+
+    printElapsed("convert, resize, swap", &start_time, ITERATIONS);
+
+    destroyNearestNeighbour(&nn);
+
+    //---------------------------------------------------------------------
+
+    PIXEL_PIPELINE_T pipeline;
+
+    initPixelPipeline(&pipeline,
+                      PIXEL_FORMAT_RGB888,
+                      IMAGE_BYTE_ORDER_BIG_ENDIAN,
+                      true,
+                      dWidth,
+                      dHeight,
+                      sWidth,
+                      sHeight,
+                      false);
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        pixelPipelineRows(&pipeline,
+                          image.buffer,
+                          image.width * sizeof(uint16_t),
+                          rgb,
+                          sWidth * 3,
+                          0,
+                          dHeight);
+    }
+
+    printElapsed("fused pipeline (RGB888)", &start_time, ITERATIONS);
+
+    destroyPixelPipeline(&pipeline);
+
+    //---------------------------------------------------------------------
+
+    initPixelPipeline(&pipeline,
+                      PIXEL_FORMAT_XRGB8888,
+                      IMAGE_BYTE_ORDER_BIG_ENDIAN,
+                      true,
+                      dWidth,
+                      dHeight,
+                      sWidth,
+                      sHeight,
+                      false);
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        pixelPipelineRows(&pipeline,
+                          image.buffer,
+                          image.width * sizeof(uint16_t),
+                          xrgb,
+                          sWidth * sizeof(uint32_t),
+                          0,
+                          dHeight);
+    }
+
+    printElapsed("fused pipeline (XRGB8888)", &start_time, ITERATIONS);
+
+    destroyPixelPipeline(&pipeline);
+
+    //---------------------------------------------------------------------
+
+    destroyImage(&image);
+    destroyImage(&source);
+    free(xrgb);
+    free(rgb);
+
+    printf("\n");
+}
+
+//-------------------------------------------------------------------------
+
+void
+benchmarkTransition(
+    int16_t width,
+    int16_t height)
+{
+    printf("transition %dx%d RGB565\n", width, height);
+
+    IMAGE_T from;
+    IMAGE_T to;
+    IMAGE_T frame;
+
+    initImage(&from, width, height, false);
+    initImage(&to, width, height, false);
+    initImage(&frame, width, height, false);
+
+    clearImageRGB565(&from, packRGB565(255, 0, 0));
+    clearImageRGB565(&to, packRGB565(0, 0, 255));
+
+    struct timeval start_time;
+    int n;
+
+    //---------------------------------------------------------------------
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        uint8_t alpha = (n * 255) / ITERATIONS;
+
+        int32_t i;
+        for (i = 0 ; i < (width * height) ; i++)
+        {
+            frame.buffer[i] = blendRGB565(alpha,
+                                          to.buffer[i],
+                                          from.buffer[i]);
+        }
+    }
+
+    printElapsed("blendRGB565", &start_time, ITERATIONS);
+
+    //---------------------------------------------------------------------
+
+    static const char *names[] = { "fade", "wipe", "slide" };
+    static const TRANSITION_T transitions[] =
+    {
+        TRANSITION_FADE,
+        TRANSITION_WIPE,
+        TRANSITION_SLIDE
+    };
+
+    int t;
+    for (t = 0 ; t < 3 ; t++)
+    {
+        gettimeofday(&start_time, NULL);
+
+        for (n = 0 ; n < ITERATIONS ; n++)
+        {
+            transitionFrame(transitions[t],
+                            (n * TRANSITION_STEPS) / ITERATIONS,
+                            &from,
+                            &to,
+                            &frame);
+        }
+
+        printElapsed(names[t], &start_time, ITERATIONS);
+    }
+
+    //---------------------------------------------------------------------
+
+    destroyImage(&from);
+    destroyImage(&to);
+    destroyImage(&frame);
+
+    printf("\n");
+}
+
+//-------------------------------------------------------------------------
+
+void
+benchmarkRotate(
+    int16_t width,
+    int16_t height)
+{
+    printf("rotate %dx%d RGB565\n", width, height);
+
+    IMAGE_T image;
+    IMAGE_T rotated;
+    IMAGE_T flipped;
+
+    initImage(&image, width, height, false);
+    initImage(&rotated, height, width, false);
+    initImage(&flipped, width, height, false);
+
+    int32_t pixel;
+    for (pixel = 0 ; pixel < (width * height) ; pixel++)
+    {
+        image.buffer[pixel] = pixel;
+    }
+
+    struct timeval start_time;
+    int n;
+
+    //---------------------------------------------------------------------
+
+    gettimeofday(&start_time, NULL);
+
+    for (n = 0 ; n < ITERATIONS ; n++)
+    {
+        int16_t j;
+        for (j = 0 ; j < height ; j++)
+        {
+            int16_t i;
+            for (i = 0 ; i < width ; i++)
+            {
+                rotated.buffer[(height - 1 - j) + (i * height)] =
+                    image.buffer[i + (j * width)];
+            }
+        }
+    }
+
+    printElapsed("90 (per pixel)", &start_time, ITERATIONS);
+
+    //---------------------------------------------------------------------
+
+    static const char *names[] =
+    {
+        "90",
+        "180",
+        "270",
+        "flip horizontal",
+        "flip vertical"
+    };
+
+    static const ROTATE_T rotations[] =
+    {
+        ROTATE_90,
+        ROTATE_180,
+        ROTATE_270,
+        ROTATE_FLIP_HORIZONTAL,
+        ROTATE_FLIP_VERTICAL
+    };
+
+    int r;
+    for (r = 0 ; r < 5 ; r++)
+    {
+        bool swap = (rotations[r] == ROTATE_90) ||
+                    (rotations[r] == ROTATE_270);
+
+        gettimeofday(&start_time, NULL);
+
+        for (n = 0 ; n < ITERATIONS ; n++)
+        {
+            rotateImage((swap) ? &rotated : &flipped, &image, rotations[r]);
+        }
+
+        printElapsed(names[r], &start_time, ITERATIONS);
+    }
+
+    //---------------------------------------------------------------------
+
+    destroyImage(&image);
+    destroyImage(&rotated);
+    destroyImage(&flipped);
+
+    printf("\n");
+}
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    IMAGE_T *image;
+    const uint8_t *rgb;
+} CONVERT_JOB_T;
+
+static void
+convertJob(
+    void *context,
+    int32_t start,
+    int32_t end)
+{
+    const CONVERT_JOB_T *job = context;
+
+    convertRowsRGB(job->image,
+                   job->rgb,
+                   job->image->width * 3,
+                   3,
+                   NULL,
+                   start,
+                   end);
+}
+
+//-------------------------------------------------------------------------
+
+void
+benchmarkThreads(
+    int16_t sWidth,
+    int16_t sHeight,
+    int16_t dWidth,
+    int16_t dHeight)
+{
+    printf("threads %dx%d to %dx%d RGB565\n",
+           sWidth,
+           sHeight,
+           dWidth,
+           dHeight);
+
+    uint8_t *rgb = createRGB888(sWidth, sHeight);
+
+    IMAGE_T source;
+    initImage(&source, sWidth, sHeight, true);
+
+    IMAGE_T image;
+    initImage(&image, dWidth, dHeight, false);
+
+    NEAREST_NEIGHBOUR_T nn;
+    initNearestNeighbour(&nn, dWidth, dHeight, sWidth, sHeight, false);
+
+    CONVERT_JOB_T job = { &source, rgb };
+
+    struct timeval start_time;
+    char name[64];
+    int n;
+
+    //---------------------------------------------------------------------
+
+    int16_t threads;
+    for (threads = 1 ; threads <= 4 ; threads++)
+    {
+        WORKER_POOL_T pool;
+
+        if (initWorkerPool(&pool, threads) == false)
+        {
+            perror("benchmark: cannot start worker threads");
+            exit(EXIT_FAILURE);
+        }
+
+        gettimeofday(&start_time, NULL);
+
+        for (n = 0 ; n < ITERATIONS ; n++)
+        {
+            runWorkerPool(&pool, convertJob, &job, sHeight);
+        }
+
+        snprintf(name, sizeof(name), "convert (%d threads)", threads);
+        printElapsed(name, &start_time, ITERATIONS);
+
+        gettimeofday(&start_time, NULL);
+
+        for (n = 0 ; n < ITERATIONS ; n++)
+        {
+            resizeNearestNeighbourThreaded(&nn,
+                                           &pool,
+                                           image.buffer,
+                                           image.width * sizeof(uint16_t),
+                                           source.buffer,
+                                           source.width * sizeof(uint16_t));
+        }
+
+        snprintf(name,
+                 sizeof(name),
+                 "nearest neighbour (%d threads)",
+                 threads);
+        printElapsed(name, &start_time, ITERATIONS);
+
+        destroyWorkerPool(&pool);
+    }
+
+    //---------------------------------------------------------------------
+
+    destroyNearestNeighbour(&nn);
+    destroyImage(&image);
+    destroyImage(&source);
+    free(rgb);
+
+    printf("\n");
+}
+
+//-------------------------------------------------------------------------
+
+int
+main(void)
+{
+    benchmarkDither(320, 240);
+    benchmarkDither(640, 480);
+
+    benchmarkResize(640, 480, 320, 240);
+    benchmarkResize(960, 720, 320, 240);
+    benchmarkResize(1280, 960, 320, 240);
+    benchmarkResize(1024, 768, 320, 240);
+    benchmarkResize(160, 120, 320, 240);
+
+    benchmarkPipeline(320, 240, 320, 240);
+    benchmarkPipeline(640, 480, 320, 240);
+    benchmarkPipeline(1024, 768, 320, 240);
+
+    benchmarkThreads(1024, 768, 320, 240);
+    benchmarkThreads(1920, 1080, 640, 480);
+
+    benchmarkTransition(320, 240);
+
+    benchmarkRotate(320, 240);
+    benchmarkRotate(640, 480);
+
+    return 0 ;
+}
@@ -0,0 +1,369 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "bilinear.h"
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// Calculate the source position (in 16.16 fixed point) of the centre of
+// each destination pixel, and split it into an index and a weight for the
+// following pixel. At the far edge the weight is zero so the following
+// pixel is never read.
+//
+
+static void
+sourcePosition(
+    int32_t i,
+    int32_t ratio,
+    int16_t sourceLength,
+    int16_t *index,
+    uint8_t *weight)
+{
+    int32_t position = (((2 * i + 1) * ratio) / 2) - 0x8000;
+
+    if (position < 0)
+    {
+        position = 0;
+    }
+
+    int32_t whole = position >> 16;
+    int32_t fraction = ((position & 0xFFFF)
+                     + (1 << (15 - BILINEAR_WEIGHT_BITS)))
+                     >> (16 - BILINEAR_WEIGHT_BITS);
+
+    if (fraction == BILINEAR_WEIGHT_ONE)
+    {
+        whole += 1;
+        fraction = 0;
+    }
+
+    if (whole >= (sourceLength - 1))
+    {
+        whole = sourceLength - 1;
+        fraction = 0;
+    }
+
+    *index = whole;
+    *weight = fraction;
+}
+
+//-------------------------------------------------------------------------
+//
+// The two source pixels of each destination pixel are gathered eight at a
+// time, then the fields of all eight are blended at once as in
+// crossFadeRGB565, but with each pixel's own weight.
+//
+
+static void
+interpolateRow(
+    const BILINEAR_T *bl,
+    uint16_t *dst,
+    const uint16_t *src)
+{
+    int32_t width = bl->destinationWidth;
+    int32_t i = 0;
+
+#if defined(__ARM_NEON) || defined(__SSE2__)
+
+    for ( ; (i + 8) <= width ; i += 8)
+    {
+        uint16_t left[8];
+        uint16_t right[8];
+
+        int k;
+        for (k = 0 ; k < 8 ; k++)
+        {
+            int16_t x = bl->xIndex[i + k];
+
+            left[k] = src[x];
+            right[k] = src[x + (bl->xWeight[i + k] != 0)];
+        }
+
+#if defined(__ARM_NEON)
+
+        uint16x8_t wb = vmovl_u8(vld1_u8(bl->xWeight + i));
+        uint16x8_t wa = vsubq_u16(vdupq_n_u16(BILINEAR_WEIGHT_ONE), wb);
+        uint16x8_t mask5 = vdupq_n_u16(0x1F);
+        uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+        uint16x8_t pa = vld1q_u16(left);
+        uint16x8_t pb = vld1q_u16(right);
+
+        uint16x8_t red = vmlaq_u16(vmulq_u16(vshrq_n_u16(pa, 11), wa),
+                                   vshrq_n_u16(pb, 11),
+                                   wb);
+
+        uint16x8_t green =
+            vmlaq_u16(vmulq_u16(vandq_u16(vshrq_n_u16(pa, 5), mask6), wa),
+                      vandq_u16(vshrq_n_u16(pb, 5), mask6),
+                      wb);
+
+        uint16x8_t blue = vmlaq_u16(vmulq_u16(vandq_u16(pa, mask5), wa),
+                                    vandq_u16(pb, mask5),
+                                    wb);
+
+        red = vrshrq_n_u16(red, BILINEAR_WEIGHT_BITS);
+        green = vrshrq_n_u16(green, BILINEAR_WEIGHT_BITS);
+        blue = vrshrq_n_u16(blue, BILINEAR_WEIGHT_BITS);
+
+        vst1q_u16(dst + i,
+                  vorrq_u16(vshlq_n_u16(red, 11),
+                            vorrq_u16(vshlq_n_u16(green, 5), blue)));
+
+#else
+
+        __m128i weights = _mm_loadl_epi64((const __m128i *)(bl->xWeight + i));
+        __m128i wb = _mm_unpacklo_epi8(weights, _mm_setzero_si128());
+        __m128i wa = _mm_sub_epi16(_mm_set1_epi16(BILINEAR_WEIGHT_ONE), wb);
+        __m128i mask5 = _mm_set1_epi16(0x1F);
+        __m128i mask6 = _mm_set1_epi16(0x3F);
+        __m128i round = _mm_set1_epi16(BILINEAR_WEIGHT_ONE / 2);
+
+        __m128i pa = _mm_loadu_si128((const __m128i *)left);
+        __m128i pb = _mm_loadu_si128((const __m128i *)right);
+
+        __m128i red =
+            _mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(pa, 11), wa),
+                          _mm_mullo_epi16(_mm_srli_epi16(pb, 11), wb));
+
+        __m128i green =
+            _mm_add_epi16(
+                _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(pa, 5), mask6),
+                                wa),
+                _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(pb, 5), mask6),
+                                wb));
+
+        __m128i blue =
+            _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(pa, mask5), wa),
+                          _mm_mullo_epi16(_mm_and_si128(pb, mask5), wb));
+
+        red = _mm_srli_epi16(_mm_add_epi16(red, round),
+                             BILINEAR_WEIGHT_BITS);
+        green = _mm_srli_epi16(_mm_add_epi16(green, round),
+                               BILINEAR_WEIGHT_BITS);
+        blue = _mm_srli_epi16(_mm_add_epi16(blue, round),
+                              BILINEAR_WEIGHT_BITS);
+
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_or_si128(_mm_slli_epi16(red, 11),
+                                      _mm_or_si128(_mm_slli_epi16(green, 5),
+                                                   blue)));
+
+#endif
+
+    }
+
+#endif
+
+    for ( ; i < width ; i++)
+    {
+        int16_t x = bl->xIndex[i];
+        uint32_t weight = bl->xWeight[i];
+
+        uint32_t a = spreadRGB565(src[x]);
+        uint32_t b = spreadRGB565(src[x + (weight != 0)]);
+
+        uint32_t blended = (a * (BILINEAR_WEIGHT_ONE - weight))
+                         + (b * weight)
+                         + RGB565_SPREAD_ROUND;
+
+        dst[i] = packSpreadRGB565(blended >> BILINEAR_WEIGHT_BITS);
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Return the row buffer holding source row y interpolated horizontally,
+// reusing the buffers from the previous destination row where possible.
+//
+
+static const uint16_t *
+sourceRow(
+    BILINEAR_T *bl,
+    int16_t y,
+    const void *src,
+    int16_t sPitch)
+{
+    if (bl->rowIndex[0] == y)
+    {
+        return bl->rows[0];
+    }
+
+    if (bl->rowIndex[1] == y)
+    {
+        return bl->rows[1];
+    }
+
+    // replace the buffer holding the lower numbered row, it will not be
+    // needed again as the destination rows are produced in order.
+
+    int older = (bl->rowIndex[0] < bl->rowIndex[1]) ? 0 : 1;
+
+    interpolateRow(bl, bl->rows[older], src + (y * sPitch));
+    bl->rowIndex[older] = y;
+
+    return bl->rows[older];
+}
+
+//-------------------------------------------------------------------------
+
+void
+initBilinear(
+    BILINEAR_T *bl,
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight,
+    bool keepAspectRatio)
+{
+    int16_t width = dWidth;
+    int16_t height = dHeight;
+
+    bl->xRatio = ((int32_t)sWidth << 16) / width;
+    bl->yRatio = ((int32_t)sHeight << 16) / height;
+
+    bl->destinationWidth = width;
+    bl->destinationHeight = height;
+
+    if (keepAspectRatio)
+    {
+        if (bl->xRatio < bl->yRatio)
+        {
+            bl->xRatio = bl->yRatio;
+            bl->destinationWidth = (sWidth * dHeight) / sHeight;
+        }
+        else
+        {
+            bl->yRatio = bl->xRatio;
+            bl->destinationHeight = (dWidth * sHeight) / sWidth;
+        }
+    }
+
+    bl->sourceWidth = sWidth;
+    bl->sourceHeight = sHeight;
+
+    //---------------------------------------------------------------------
+
+    bl->xIndex = malloc(bl->destinationWidth * sizeof(int16_t));
+    bl->xWeight = malloc(bl->destinationWidth * sizeof(uint8_t));
+    bl->rows[0] = malloc(bl->destinationWidth * sizeof(uint16_t));
+    bl->rows[1] = malloc(bl->destinationWidth * sizeof(uint16_t));
+
+    if ((bl->xIndex == NULL) ||
+        (bl->xWeight == NULL) ||
+        (bl->rows[0] == NULL) ||
+        (bl->rows[1] == NULL))
+    {
+        perror("bilinear: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t i;
+    for (i = 0 ; i < bl->destinationWidth ; i++)
+    {
+        sourcePosition(i,
+                       bl->xRatio,
+                       sWidth,
+                       &(bl->xIndex[i]),
+                       &(bl->xWeight[i]));
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+resizeBilinear(
+    BILINEAR_T *bl,
+    void *dst,
+    int16_t dPitch,
+    void *src,
+    int16_t sPitch)
+{
+    // The source changes from frame to frame, so the row buffers can not
+    // be carried over from the last call.
+
+    bl->rowIndex[0] = -1;
+    bl->rowIndex[1] = -1;
+
+    int32_t j;
+    for (j = 0 ; j < bl->destinationHeight ; j++)
+    {
+        int16_t y;
+        uint8_t weight;
+
+        sourcePosition(j, bl->yRatio, bl->sourceHeight, &y, &weight);
+
+        uint16_t *row = dst + (j * dPitch);
+        const uint16_t *a = sourceRow(bl, y, src, sPitch);
+
+        if (weight == 0)
+        {
+            memcpy(row, a, bl->destinationWidth * sizeof(uint16_t));
+        }
+        else
+        {
+            const uint16_t *b = sourceRow(bl, y + 1, src, sPitch);
+            crossFadeRGB565(row, a, b, weight, bl->destinationWidth);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyBilinear(
+    BILINEAR_T *bl)
+{
+    free(bl->xIndex);
+    free(bl->xWeight);
+    free(bl->rows[0]);
+    free(bl->rows[1]);
+
+    bl->xIndex = NULL;
+    bl->xWeight = NULL;
+    bl->rows[0] = NULL;
+    bl->rows[1] = NULL;
+}
+
+//-------------------------------------------------------------------------
+
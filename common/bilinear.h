@@ -0,0 +1,93 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef BILINEAR_H
+#define BILINEAR_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// Bilinear RGB565 scaler. The source column and weight for each
+// destination column are calculated once by initBilinear. Each source row
+// is interpolated horizontally at most once per frame into one of two row
+// buffers (a sliding window), and the destination rows are blended
+// vertically from those two buffers. Weights are 5 bit (0 to 32).
+//
+
+#define BILINEAR_WEIGHT_BITS RGB565_FADE_BITS
+#define BILINEAR_WEIGHT_ONE (1 << BILINEAR_WEIGHT_BITS)
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    int16_t destinationWidth;
+    int16_t destinationHeight;
+    int16_t sourceWidth;
+    int16_t sourceHeight;
+    int32_t xRatio;
+    int32_t yRatio;
+    int16_t *xIndex;
+    uint8_t *xWeight;
+    uint16_t *rows[2];
+    int16_t rowIndex[2];
+} BILINEAR_T;
+
+//-------------------------------------------------------------------------
+
+void
+initBilinear(
+    BILINEAR_T *bl,
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight,
+    bool keepAspectRatio);
+
+void
+resizeBilinear(
+    BILINEAR_T *bl,
+    void *dst,
+    int16_t dPitch,
+    void *src,
+    int16_t sPitch);
+
+void
+destroyBilinear(
+    BILINEAR_T *bl);
+
+//-------------------------------------------------------------------------
+
+#endif
+
@@ -0,0 +1,461 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "boxFilter.h"
+
+//-------------------------------------------------------------------------
+
+// Destination pixels done at a time, so that the column sums fit on the
+// stack of each thread.
+
+#define BOX_FILTER_CHUNK 64
+
+//-------------------------------------------------------------------------
+
+int16_t
+boxFilterFactor(
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight)
+{
+    int16_t factor;
+    for (factor = BOX_FILTER_MIN_FACTOR ;
+         factor <= BOX_FILTER_MAX_FACTOR ;
+         factor++)
+    {
+        if (((dWidth * factor) == sWidth) && ((dHeight * factor) == sHeight))
+        {
+            return factor;
+        }
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+//
+// Sum each field of length source columns, starting at column first, down
+// the factor rows of a block. At most 4 x 63 so the sums fit in 16 bits.
+//
+
+static void
+sumColumns(
+    const uint16_t *rows[],
+    int16_t factor,
+    int32_t first,
+    int32_t length,
+    uint16_t *red,
+    uint16_t *green,
+    uint16_t *blue)
+{
+    int32_t i = 0;
+
+#if defined(__ARM_NEON)
+
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        uint16x8_t r = vdupq_n_u16(0);
+        uint16x8_t g = vdupq_n_u16(0);
+        uint16x8_t b = vdupq_n_u16(0);
+
+        int16_t k;
+        for (k = 0 ; k < factor ; k++)
+        {
+            uint16x8_t pixels = vld1q_u16(rows[k] + first + i);
+
+            r = vaddq_u16(r, vshrq_n_u16(pixels, 11));
+            g = vaddq_u16(g, vandq_u16(vshrq_n_u16(pixels, 5), mask6));
+            b = vaddq_u16(b, vandq_u16(pixels, mask5));
+        }
+
+        vst1q_u16(red + i, r);
+        vst1q_u16(green + i, g);
+        vst1q_u16(blue + i, b);
+    }
+
+#elif defined(__SSE2__)
+
+    __m128i mask5 = _mm_set1_epi16(0x1F);
+    __m128i mask6 = _mm_set1_epi16(0x3F);
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        __m128i r = _mm_setzero_si128();
+        __m128i g = _mm_setzero_si128();
+        __m128i b = _mm_setzero_si128();
+
+        int16_t k;
+        for (k = 0 ; k < factor ; k++)
+        {
+            __m128i pixels =
+                _mm_loadu_si128((const __m128i *)(rows[k] + first + i));
+
+            r = _mm_add_epi16(r, _mm_srli_epi16(pixels, 11));
+            g = _mm_add_epi16(g,
+                              _mm_and_si128(_mm_srli_epi16(pixels, 5),
+                                            mask6));
+            b = _mm_add_epi16(b, _mm_and_si128(pixels, mask5));
+        }
+
+        _mm_storeu_si128((__m128i *)(red + i), r);
+        _mm_storeu_si128((__m128i *)(green + i), g);
+        _mm_storeu_si128((__m128i *)(blue + i), b);
+    }
+
+#endif
+
+    for ( ; i < length ; i++)
+    {
+        uint16_t r = 0;
+        uint16_t g = 0;
+        uint16_t b = 0;
+
+        int16_t k;
+        for (k = 0 ; k < factor ; k++)
+        {
+            uint16_t pixel = rows[k][first + i];
+
+            r += pixel >> 11;
+            g += (pixel >> 5) & 0x3F;
+            b += pixel & 0x1F;
+        }
+
+        red[i] = r;
+        green[i] = g;
+        blue[i] = b;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static inline uint16_t
+sumAcross(
+    const uint16_t *sums,
+    int16_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+
+        return sums[0] + sums[1];
+
+    case 3:
+
+        return sums[0] + sums[1] + sums[2];
+
+    default:
+
+        return sums[0] + sums[1] + sums[2] + sums[3];
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Divide by the area of the block, rounding to nearest. For 3 x 3 blocks
+// (sum + 4) * 7282 / 65536 is exactly (sum + 4) / 9 for every sum that a
+// 6 bit field can produce.
+//
+
+static inline uint16_t
+divide(
+    uint16_t sum,
+    int16_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+
+        return (sum + 2) >> 2;
+
+    case 3:
+
+        return ((sum + 4) * 7282) >> 16;
+
+    default:
+
+        return (sum + 8) >> 4;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+#if defined(__ARM_NEON)
+
+// Sum factor adjacent column sums for each of 8 destination pixels.
+
+static inline uint16x8_t
+sumAcrossNeon(
+    const uint16_t *sums,
+    int16_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+    {
+        uint16x8x2_t s = vld2q_u16(sums);
+        return vaddq_u16(s.val[0], s.val[1]);
+    }
+    case 3:
+    {
+        uint16x8x3_t s = vld3q_u16(sums);
+        return vaddq_u16(vaddq_u16(s.val[0], s.val[1]), s.val[2]);
+    }
+    default:
+    {
+        uint16x8x4_t s = vld4q_u16(sums);
+        return vaddq_u16(vaddq_u16(s.val[0], s.val[1]),
+                         vaddq_u16(s.val[2], s.val[3]));
+    }
+    }
+}
+
+// As divide, above.
+
+static inline uint16x8_t
+divideNeon(
+    uint16x8_t sum,
+    int16_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+
+        return vrshrq_n_u16(sum, 2);
+
+    case 3:
+
+        sum = vaddq_u16(sum, vdupq_n_u16(4));
+
+        return vreinterpretq_u16_s16(
+                   vqdmulhq_s16(vreinterpretq_s16_u16(sum),
+                                vdupq_n_s16(7282 / 2)));
+
+    default:
+
+        return vrshrq_n_u16(sum, 4);
+    }
+}
+
+#elif defined(__SSE2__)
+
+// Sum pairs of adjacent 16 bit lanes of a and b, in order.
+
+static inline __m128i
+sumPairsSse2(
+    __m128i a,
+    __m128i b)
+{
+    __m128i ones = _mm_set1_epi16(1);
+
+    return _mm_packs_epi32(_mm_madd_epi16(a, ones), _mm_madd_epi16(b, ones));
+}
+
+static inline __m128i
+loadSse2(
+    const uint16_t *sums)
+{
+    return _mm_loadu_si128((const __m128i *)sums);
+}
+
+// Sum factor (2 or 4) adjacent column sums for each of 8 destination
+// pixels.
+
+static inline __m128i
+sumAcrossSse2(
+    const uint16_t *sums,
+    int16_t factor)
+{
+    __m128i pairs = sumPairsSse2(loadSse2(sums), loadSse2(sums + 8));
+
+    if (factor == 4)
+    {
+        pairs = sumPairsSse2(pairs,
+                             sumPairsSse2(loadSse2(sums + 16),
+                                          loadSse2(sums + 24)));
+    }
+
+    return pairs;
+}
+
+static inline __m128i
+divideSse2(
+    __m128i sum,
+    int16_t factor)
+{
+    if (factor == 2)
+    {
+        return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+    }
+
+    return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(8)), 4);
+}
+
+#endif
+
+//-------------------------------------------------------------------------
+//
+// Average factor adjacent column sums into each of length destination
+// pixels.
+//
+
+static void
+averageColumns(
+    int16_t factor,
+    int32_t length,
+    const uint16_t *red,
+    const uint16_t *green,
+    const uint16_t *blue,
+    uint16_t *dst)
+{
+    int32_t i = 0;
+
+#if defined(__ARM_NEON)
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        int32_t first = i * factor;
+
+        uint16x8_t r = divideNeon(sumAcrossNeon(red + first, factor), factor);
+        uint16x8_t g = divideNeon(sumAcrossNeon(green + first, factor),
+                                  factor);
+        uint16x8_t b = divideNeon(sumAcrossNeon(blue + first, factor),
+                                  factor);
+
+        vst1q_u16(dst + i,
+                  vorrq_u16(vshlq_n_u16(r, 11),
+                            vorrq_u16(vshlq_n_u16(g, 5), b)));
+    }
+
+#elif defined(__SSE2__)
+
+    // 16 bit lanes can not be split into threes, so 3:1 is left to the
+    // scalar loop below.
+
+    if (factor != 3)
+    {
+        for ( ; (i + 8) <= length ; i += 8)
+        {
+            int32_t first = i * factor;
+
+            __m128i r = divideSse2(sumAcrossSse2(red + first, factor),
+                                   factor);
+            __m128i g = divideSse2(sumAcrossSse2(green + first, factor),
+                                   factor);
+            __m128i b = divideSse2(sumAcrossSse2(blue + first, factor),
+                                   factor);
+
+            __m128i pixels = _mm_or_si128(_mm_slli_epi16(r, 11),
+                                          _mm_or_si128(_mm_slli_epi16(g, 5),
+                                                       b));
+
+            _mm_storeu_si128((__m128i *)(dst + i), pixels);
+        }
+    }
+
+#endif
+
+    for ( ; i < length ; i++)
+    {
+        int32_t first = i * factor;
+
+        dst[i] = (divide(sumAcross(red + first, factor), factor) << 11)
+               | (divide(sumAcross(green + first, factor), factor) << 5)
+               | divide(sumAcross(blue + first, factor), factor);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+boxFilterRows(
+    int16_t factor,
+    int16_t dWidth,
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t start,
+    int16_t end)
+{
+    uint16_t red[BOX_FILTER_CHUNK * BOX_FILTER_MAX_FACTOR];
+    uint16_t green[BOX_FILTER_CHUNK * BOX_FILTER_MAX_FACTOR];
+    uint16_t blue[BOX_FILTER_CHUNK * BOX_FILTER_MAX_FACTOR];
+
+    const uint16_t *rows[BOX_FILTER_MAX_FACTOR];
+
+    int16_t j;
+    for (j = start ; j < end ; j++)
+    {
+        int16_t k;
+        for (k = 0 ; k < factor ; k++)
+        {
+            rows[k] = src + (((j * factor) + k) * sPitch);
+        }
+
+        uint16_t *row = dst + (j * dPitch);
+
+        int16_t i;
+        for (i = 0 ; i < dWidth ; i += BOX_FILTER_CHUNK)
+        {
+            int16_t length = dWidth - i;
+
+            if (length > BOX_FILTER_CHUNK)
+            {
+                length = BOX_FILTER_CHUNK;
+            }
+
+            sumColumns(rows,
+                       factor,
+                       i * factor,
+                       length * factor,
+                       red,
+                       green,
+                       blue);
+
+            averageColumns(factor, length, red, green, blue, row + i);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,78 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef BOX_FILTER_H
+#define BOX_FILTER_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+//
+// Box filter RGB565 downscalers for sources that are exactly 2, 3 or 4
+// times the size of the destination in both directions. Each destination
+// pixel is the average (rounded to nearest) of the factor by factor block
+// of source pixels that it covers. The fields are first summed down the
+// columns of each block and then across, in NEON or SSE2 registers where
+// available.
+//
+
+#define BOX_FILTER_MIN_FACTOR 2
+#define BOX_FILTER_MAX_FACTOR 4
+
+//-------------------------------------------------------------------------
+
+// Returns the factor if the source is exactly 2, 3 or 4 times the
+// destination in both directions, otherwise 0.
+
+int16_t
+boxFilterFactor(
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight);
+
+// Downscale destination rows start to end - 1. Bands of rows may be
+// downscaled at the same time by different threads.
+
+void
+boxFilterRows(
+    int16_t factor,
+    int16_t dWidth,
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t start,
+    int16_t end);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,189 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dither.h"
+
+//-------------------------------------------------------------------------
+
+bool
+parseDither(
+    const char *name,
+    DITHER_T *dither)
+{
+    if (strcmp(name, "none") == 0)
+    {
+        *dither = DITHER_NONE;
+    }
+    else if (strcmp(name, "ordered") == 0)
+    {
+        *dither = DITHER_ORDERED;
+    }
+    else if (strcmp(name, "diffusion") == 0)
+    {
+        *dither = DITHER_ERROR_DIFFUSION;
+    }
+    else if (strcmp(name, "serpentine") == 0)
+    {
+        *dither = DITHER_SERPENTINE;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initErrorDiffusion(
+    ERROR_DIFFUSION_T *ed,
+    int16_t width,
+    bool serpentine)
+{
+    ed->width = width;
+    ed->serpentine = serpentine;
+    ed->reverse = false;
+
+    // one column of padding at either end so the edges need no tests.
+
+    ed->errors = calloc((width + 2) * 3, sizeof(int16_t));
+
+    if (ed->errors == NULL)
+    {
+        perror("dither: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+errorDiffuseRow(
+    ERROR_DIFFUSION_T *ed,
+    const uint8_t *rgb,
+    int16_t bytesPerPixel,
+    uint16_t *row)
+{
+    // Number of bits kept in each of red, green and blue.
+
+    static const int16_t shift[3] = { 3, 2, 3 };
+
+    int16_t direction = 1;
+    int16_t x = 0;
+
+    if (ed->reverse)
+    {
+        direction = -1;
+        x = ed->width - 1;
+    }
+
+    // Errors (in 1/16ths) for the pixel to the right on this row, and
+    // for the columns behind and under the current pixel on the next row.
+
+    int32_t right[3] = { 0, 0, 0 };
+    int32_t behind[3] = { 0, 0, 0 };
+    int32_t under[3] = { 0, 0, 0 };
+
+    int16_t *errors = ed->errors + ((x + 1) * 3);
+    int16_t step = direction * 3;
+
+    int16_t n;
+    for (n = 0 ; n < ed->width ; n++)
+    {
+        const uint8_t *pixel = rgb + (x * bytesPerPixel);
+        int16_t levels[3];
+
+        int c;
+        for (c = 0 ; c < 3 ; c++)
+        {
+            int32_t value = pixel[c] + ((right[c] + errors[c] + 8) >> 4);
+
+            if (value < 0)
+            {
+                value = 0;
+            }
+            else if (value > 255)
+            {
+                value = 255;
+            }
+
+            int16_t bits = 8 - shift[c];
+            int16_t level = value >> shift[c];
+            int32_t error = value - ((level << shift[c])
+                                  | (level >> (bits - shift[c])));
+
+            levels[c] = level;
+
+            right[c] = error * 7;
+            errors[c - step] = behind[c] + (error * 3);
+            behind[c] = under[c] + (error * 5);
+            under[c] = error;
+        }
+
+        row[x] = (levels[0] << 11) | (levels[1] << 5) | levels[2];
+
+        x += direction;
+        errors += step;
+    }
+
+    int c;
+    for (c = 0 ; c < 3 ; c++)
+    {
+        errors[c - step] = behind[c];
+    }
+
+    if (ed->serpentine)
+    {
+        ed->reverse = !(ed->reverse);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyErrorDiffusion(
+    ERROR_DIFFUSION_T *ed)
+{
+    free(ed->errors);
+
+    ed->width = 0;
+    ed->errors = NULL;
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,90 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef DITHER_H
+#define DITHER_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+
+typedef enum
+{
+    DITHER_NONE,
+    DITHER_ORDERED,
+    DITHER_ERROR_DIFFUSION,
+    DITHER_SERPENTINE
+} DITHER_T;
+
+//-------------------------------------------------------------------------
+//
+// Floyd-Steinberg error diffusion from 24 bit RGB to RGB565 a row at a
+// time. The error carried to the next row is held in a single row buffer
+// (in 1/16ths) and the error carried along the current row in registers.
+// With serpentine set, alternate rows are processed right to left.
+//
+
+typedef struct
+{
+    int16_t width;
+    bool serpentine;
+    bool reverse;
+    int16_t *errors;
+} ERROR_DIFFUSION_T;
+
+//-------------------------------------------------------------------------
+
+bool
+parseDither(
+    const char *name,
+    DITHER_T *dither);
+
+bool
+initErrorDiffusion(
+    ERROR_DIFFUSION_T *ed,
+    int16_t width,
+    bool serpentine);
+
+void
+errorDiffuseRow(
+    ERROR_DIFFUSION_T *ed,
+    const uint8_t *rgb,
+    int16_t bytesPerPixel,
+    uint16_t *row);
+
+void
+destroyErrorDiffusion(
+    ERROR_DIFFUSION_T *ed);
+
+//-------------------------------------------------------------------------
+
+#endif
+
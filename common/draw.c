@@ -0,0 +1,446 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <arpa/inet.h>
+
+#include "draw.h"
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// All of the primitives are built from horizontal and vertical spans.
+// Each span is clipped once and then written without further checks.
+// The pixel value passed to the span functions is already in the byte
+// order of the image.
+//
+
+static uint16_t
+imagePixel(
+    const IMAGE_T *image,
+    uint16_t rgb)
+{
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+    {
+        rgb = htons(rgb);
+    }
+
+    return rgb;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+horizontalSpan(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint16_t pixel)
+{
+    if ((y < 0) || (y >= image->height))
+    {
+        return;
+    }
+
+    if (x < 0)
+    {
+        length += x;
+        x = 0;
+    }
+
+    if ((x + length) > image->width)
+    {
+        length = image->width - x;
+    }
+
+    if (length > 0)
+    {
+        fillRGB565(image->buffer + x + (y * image->width), pixel, length);
+        damageImage(image, x, y, length, 1);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+verticalSpan(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint16_t pixel)
+{
+    if ((x < 0) || (x >= image->width))
+    {
+        return;
+    }
+
+    if (y < 0)
+    {
+        length += y;
+        y = 0;
+    }
+
+    if ((y + length) > image->height)
+    {
+        length = image->height - y;
+    }
+
+    uint16_t *buffer = image->buffer + x + (y * image->width);
+
+    int16_t j;
+    for (j = 0 ; j < length ; j++)
+    {
+        *buffer = pixel;
+        buffer += image->width;
+    }
+
+    damageImage(image, x, y, 1, length);
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawHorizontalLineRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint16_t rgb)
+{
+    horizontalSpan(image, x, y, length, imagePixel(image, rgb));
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawVerticalLineRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint16_t rgb)
+{
+    verticalSpan(image, x, y, length, imagePixel(image, rgb));
+}
+
+//-------------------------------------------------------------------------
+//
+// Bresenham's line algorithm. Rather than plotting each pixel, the
+// pixels that share a row (or column for steep lines) are collected into
+// a run and written as a single span.
+//
+
+void
+drawLineRGB565(
+    IMAGE_T *image,
+    int16_t x0,
+    int16_t y0,
+    int16_t x1,
+    int16_t y1,
+    uint16_t rgb)
+{
+    uint16_t pixel = imagePixel(image, rgb);
+
+    int16_t dx = abs(x1 - x0);
+    int16_t dy = abs(y1 - y0);
+    int16_t sx = (x0 < x1) ? 1 : -1;
+    int16_t sy = (y0 < y1) ? 1 : -1;
+
+    if (dx >= dy)
+    {
+        int32_t error = (2 * dy) - dx;
+        int16_t start = x0;
+        int16_t x = x0;
+        int16_t y = y0;
+
+        int16_t i;
+        for (i = 0 ; i <= dx ; i++)
+        {
+            if ((i == dx) || (error > 0))
+            {
+                int16_t left = (start < x) ? start : x;
+                horizontalSpan(image, left, y, abs(x - start) + 1, pixel);
+
+                y += sy;
+                error -= 2 * dx;
+                start = x + sx;
+            }
+
+            error += 2 * dy;
+            x += sx;
+        }
+    }
+    else
+    {
+        int32_t error = (2 * dx) - dy;
+        int16_t start = y0;
+        int16_t x = x0;
+        int16_t y = y0;
+
+        int16_t i;
+        for (i = 0 ; i <= dy ; i++)
+        {
+            if ((i == dy) || (error > 0))
+            {
+                int16_t top = (start < y) ? start : y;
+                verticalSpan(image, x, top, abs(y - start) + 1, pixel);
+
+                x += sx;
+                error -= 2 * dy;
+                start = y + sy;
+            }
+
+            error += 2 * dx;
+            y += sy;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawBoxRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    uint16_t rgb)
+{
+    if ((width < 1) || (height < 1))
+    {
+        return;
+    }
+
+    uint16_t pixel = imagePixel(image, rgb);
+
+    horizontalSpan(image, x, y, width, pixel);
+    horizontalSpan(image, x, y + height - 1, width, pixel);
+    verticalSpan(image, x, y + 1, height - 2, pixel);
+    verticalSpan(image, x + width - 1, y + 1, height - 2, pixel);
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawFilledBoxRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    uint16_t rgb)
+{
+    if (x < 0)
+    {
+        width += x;
+        x = 0;
+    }
+
+    if (y < 0)
+    {
+        height += y;
+        y = 0;
+    }
+
+    if ((x + width) > image->width)
+    {
+        width = image->width - x;
+    }
+
+    if ((y + height) > image->height)
+    {
+        height = image->height - y;
+    }
+
+    if ((width < 1) || (height < 1))
+    {
+        return;
+    }
+
+    uint16_t pixel = imagePixel(image, rgb);
+    uint16_t *buffer = image->buffer + x + (y * image->width);
+
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        fillRGB565(buffer, pixel, width);
+        buffer += image->width;
+    }
+
+    damageImage(image, x, y, width, height);
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawFilledCircleRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t radius,
+    uint16_t rgb)
+{
+    if (radius < 0)
+    {
+        return;
+    }
+
+    uint16_t pixel = imagePixel(image, rgb);
+
+    int32_t radiusSquared = (int32_t)radius * radius;
+    int32_t halfWidth = radius;
+
+    int32_t dy;
+    for (dy = 0 ; dy <= radius ; dy++)
+    {
+        while (((halfWidth * halfWidth) + (dy * dy)) > radiusSquared)
+        {
+            --halfWidth;
+        }
+
+        int16_t length = (2 * halfWidth) + 1;
+
+        horizontalSpan(image, x - halfWidth, y + dy, length, pixel);
+
+        if (dy != 0)
+        {
+            horizontalSpan(image, x - halfWidth, y - dy, length, pixel);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Scan convert a convex polygon. Every row crosses the boundary of a
+// convex polygon at most twice, so each row is a single span between the
+// leftmost and rightmost edge crossings.
+//
+
+void
+drawFilledConvexPolygonRGB565(
+    IMAGE_T *image,
+    const POINT_T *points,
+    int16_t numberOfPoints,
+    uint16_t rgb)
+{
+    if (numberOfPoints < 1)
+    {
+        return;
+    }
+
+    uint16_t pixel = imagePixel(image, rgb);
+
+    int16_t yMin = points[0].y;
+    int16_t yMax = points[0].y;
+
+    int16_t p;
+    for (p = 1 ; p < numberOfPoints ; p++)
+    {
+        if (points[p].y < yMin)
+        {
+            yMin = points[p].y;
+        }
+
+        if (points[p].y > yMax)
+        {
+            yMax = points[p].y;
+        }
+    }
+
+    if (yMin < 0)
+    {
+        yMin = 0;
+    }
+
+    if (yMax >= image->height)
+    {
+        yMax = image->height - 1;
+    }
+
+    int16_t y;
+    for (y = yMin ; y <= yMax ; y++)
+    {
+        int32_t xLeft = INT16_MAX;
+        int32_t xRight = INT16_MIN;
+
+        for (p = 0 ; p < numberOfPoints ; p++)
+        {
+            const POINT_T *a = &(points[p]);
+            const POINT_T *b = &(points[(p + 1) % numberOfPoints]);
+
+            if (((y < a->y) && (y < b->y)) || ((y > a->y) && (y > b->y)))
+            {
+                continue;
+            }
+
+            int32_t x0 = a->x;
+            int32_t x1 = b->x;
+
+            if (a->y != b->y)
+            {
+                x0 = a->x + (((int32_t)(y - a->y) * (b->x - a->x))
+                             / (b->y - a->y));
+                x1 = x0;
+            }
+
+            if (x0 < xLeft)
+            {
+                xLeft = x0;
+            }
+
+            if (x1 < xLeft)
+            {
+                xLeft = x1;
+            }
+
+            if (x0 > xRight)
+            {
+                xRight = x0;
+            }
+
+            if (x1 > xRight)
+            {
+                xRight = x1;
+            }
+        }
+
+        if (xLeft <= xRight)
+        {
+            horizontalSpan(image, xLeft, y, xRight - xLeft + 1, pixel);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,110 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef DRAW_H
+#define DRAW_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+} POINT_T;
+
+//-------------------------------------------------------------------------
+
+void
+drawHorizontalLineRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint16_t rgb);
+
+void
+drawVerticalLineRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint16_t rgb);
+
+void
+drawLineRGB565(
+    IMAGE_T *image,
+    int16_t x0,
+    int16_t y0,
+    int16_t x1,
+    int16_t y1,
+    uint16_t rgb);
+
+void
+drawBoxRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    uint16_t rgb);
+
+void
+drawFilledBoxRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    uint16_t rgb);
+
+void
+drawFilledCircleRGB565(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t radius,
+    uint16_t rgb);
+
+void
+drawFilledConvexPolygonRGB565(
+    IMAGE_T *image,
+    const POINT_T *points,
+    int16_t numberOfPoints,
+    uint16_t rgb);
+
+//-------------------------------------------------------------------------
+
+#endif
+
@@ -26,6 +26,18 @@
 //
 //-------------------------------------------------------------------------
 
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "bits.h"
 #include "font.h"
 
@@ -4643,78 +4655,737 @@ uint8_t font[256][FONT_HEIGHT] =
     }
 };
 
+//-------------------------------------------------------------------------
+//
+// The built in font is code page 437. These are the code points of its
+// top 128 glyphs; the bottom 128 are taken to be ASCII.
+//
+
+static const uint16_t cp437[128] =
+{
+    0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7,
+    0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+    0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9,
+    0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+    0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA,
+    0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+    0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+    0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4,
+    0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+    0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248,
+    0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0
+};
+
+//-------------------------------------------------------------------------
+
+static int32_t
+findGlyphCP437(
+    const FONT_T *font,
+    uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        return codePoint;
+    }
+
+    int32_t c;
+    for (c = 0 ; c < 128 ; c++)
+    {
+        if (cp437[c] == codePoint)
+        {
+            return 0x80 + c;
+        }
+    }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+
+const FONT_T defaultFont =
+{
+    .id = 0,
+    .width = FONT_WIDTH,
+    .height = FONT_HEIGHT,
+    .bitsPerPixel = 1,
+    .bytesPerRow = 1,
+    .bytesPerGlyph = FONT_HEIGHT,
+    .glyphs = 256,
+    .bitmaps = &(font[0][0]),
+    .map = NULL,
+    .mapLength = 0,
+    .buffer = NULL,
+    .findGlyph = findGlyphCP437,
+    .loadGlyph = NULL,
+    .store = NULL
+};
+
+//-------------------------------------------------------------------------
+//
+// Each byte of a glyph row expands to eight pixel masks, all ones where
+// the bit is set, so eight pixels can be drawn with one masked store
+// instead of testing each bit.
+//
+
+#define FONT_MASK_WIDTH 8
+
+static uint16_t fontMaskRGB565[256][FONT_MASK_WIDTH];
+static uint8_t fontMaskIndexed[256][FONT_MASK_WIDTH];
+static bool fontMasksInitialised = false;
+
+static void
+initFontMasks(void)
+{
+    int16_t byte;
+    for (byte = 0 ; byte < 256 ; byte++)
+    {
+        int16_t i;
+        for (i = 0 ; i < FONT_MASK_WIDTH ; i++)
+        {
+            bool set = (byte >> (FONT_MASK_WIDTH - i - 1)) & 1;
+
+            fontMaskRGB565[byte][i] = (set) ? 0xFFFF : 0;
+            fontMaskIndexed[byte][i] = (set) ? 0xFF : 0;
+        }
+    }
+
+    fontMasksInitialised = true;
+}
+
+//-------------------------------------------------------------------------
+
+static inline void
+maskedStoreRGB565(
+    uint16_t *dst,
+    const uint16_t *mask,
+    uint16_t pixel)
+{
+#if defined(__ARM_NEON)
+
+    vst1q_u16(dst, vbslq_u16(vld1q_u16(mask),
+                             vdupq_n_u16(pixel),
+                             vld1q_u16(dst)));
+
+#elif defined(__SSE2__)
+
+    __m128i m = _mm_loadu_si128((const __m128i *)mask);
+    __m128i d = _mm_loadu_si128((const __m128i *)dst);
+
+    d = _mm_or_si128(_mm_andnot_si128(m, d),
+                     _mm_and_si128(m, _mm_set1_epi16(pixel)));
+
+    _mm_storeu_si128((__m128i *)dst, d);
+
+#else
+
+    int16_t i;
+    for (i = 0 ; i < FONT_MASK_WIDTH ; i++)
+    {
+        dst[i] = (dst[i] & ~mask[i]) | (pixel & mask[i]);
+    }
+
+#endif
+}
+
+//-------------------------------------------------------------------------
+//
+// As maskedStoreRGB565, but the pixels not in the mask are set to the
+// background, so every pixel is written.
+//
+
+static inline void
+selectStoreRGB565(
+    uint16_t *dst,
+    const uint16_t *mask,
+    uint16_t foreground,
+    uint16_t background)
+{
+#if defined(__ARM_NEON)
+
+    vst1q_u16(dst, vbslq_u16(vld1q_u16(mask),
+                             vdupq_n_u16(foreground),
+                             vdupq_n_u16(background)));
+
+#elif defined(__SSE2__)
+
+    __m128i m = _mm_loadu_si128((const __m128i *)mask);
+
+    __m128i d = _mm_or_si128(_mm_andnot_si128(m, _mm_set1_epi16(background)),
+                             _mm_and_si128(m, _mm_set1_epi16(foreground)));
+
+    _mm_storeu_si128((__m128i *)dst, d);
+
+#else
+
+    int16_t i;
+    for (i = 0 ; i < FONT_MASK_WIDTH ; i++)
+    {
+        dst[i] = (background & ~mask[i]) | (foreground & mask[i]);
+    }
+
+#endif
+}
+
+//-------------------------------------------------------------------------
+
+static inline void
+maskedStoreIndexed(
+    uint8_t *dst,
+    const uint8_t *mask,
+    uint8_t index)
+{
+    uint64_t d;
+    uint64_t m;
+
+    memcpy(&d, dst, sizeof(d));
+    memcpy(&m, mask, sizeof(m));
+
+    d = (d & ~m) | ((UINT64_C(0x0101010101010101) * index) & m);
+
+    memcpy(dst, &d, sizeof(d));
+}
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    int16_t iStart;
+    int16_t iEnd;
+    int16_t jStart;
+    int16_t jEnd;
+} GLYPH_CLIP_T;
+
+//-------------------------------------------------------------------------
+//
+// Clip a glyph at (x, y) once, rather than each pixel. Returns false if
+// none of it is visible.
+//
+
+static bool
+clipGlyph(
+    const FONT_T *font,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    GLYPH_CLIP_T *clip)
+{
+    clip->iStart = (x < 0) ? -x : 0;
+    clip->jStart = (y < 0) ? -y : 0;
+    clip->iEnd = font->width;
+    clip->jEnd = font->height;
+
+    if ((x + clip->iEnd) > width)
+    {
+        clip->iEnd = width - x;
+    }
+
+    if ((y + clip->jEnd) > height)
+    {
+        clip->jEnd = height - y;
+    }
+
+    return (clip->iStart < clip->iEnd) && (clip->jStart < clip->jEnd);
+}
+
+//-------------------------------------------------------------------------
+
+int32_t
+findGlyphFont(
+    const FONT_T *font,
+    uint32_t codePoint)
+{
+    if (font->findGlyph != NULL)
+    {
+        return font->findGlyph(font, codePoint);
+    }
+
+    return (codePoint < (uint32_t)font->glyphs) ? (int32_t)codePoint : -1;
+}
+
+//-------------------------------------------------------------------------
+//
+// Returns the code point of a UTF-8 sequence, or -1 if the bytes are not
+// a valid (shortest form) sequence. length is set to the bytes it used.
+//
+
+static int32_t
+decodeUtf8(
+    const uint8_t *bytes,
+    int *length)
+{
+    static const uint32_t minimum[4] = { 0, 0x80, 0x800, 0x10000 };
+
+    uint8_t first = bytes[0];
+    int32_t codePoint = 0;
+    int count = 0;
+
+    *length = 1;
+
+    if (first < 0x80)
+    {
+        return first;
+    }
+    else if ((first & 0xE0) == 0xC0)
+    {
+        codePoint = first & 0x1F;
+        count = 1;
+    }
+    else if ((first & 0xF0) == 0xE0)
+    {
+        codePoint = first & 0x0F;
+        count = 2;
+    }
+    else if ((first & 0xF8) == 0xF0)
+    {
+        codePoint = first & 0x07;
+        count = 3;
+    }
+    else
+    {
+        return -1;
+    }
+
+    int i;
+    for (i = 1 ; i <= count ; i++)
+    {
+        if ((bytes[i] & 0xC0) != 0x80)
+        {
+            return -1;
+        }
+
+        codePoint = (codePoint << 6) | (bytes[i] & 0x3F);
+    }
+
+    if ((codePoint < minimum[count]) ||
+        (codePoint > 0x10FFFF) ||
+        ((codePoint >= 0xD800) && (codePoint <= 0xDFFF)))
+    {
+        return -1;
+    }
+
+    *length = count + 1;
+
+    return codePoint;
+}
+
+//-------------------------------------------------------------------------
+
+int32_t
+nextGlyphFont(
+    const FONT_T *font,
+    const char **string)
+{
+    const uint8_t *bytes = (const uint8_t *)*string;
+    int length = 1;
+    int32_t codePoint = decodeUtf8(bytes, &length);
+
+    *string += length;
+
+    // A stray byte is a code page 437 character. In fonts that do not map
+    // code points (and the built in font) that is the glyph itself.
+
+    if (codePoint == -1)
+    {
+        if ((font->findGlyph == NULL) || (font->findGlyph == findGlyphCP437))
+        {
+            return (bytes[0] < font->glyphs) ? bytes[0] : -1;
+        }
+
+        codePoint = cp437[bytes[0] - 0x80];
+    }
+
+    int32_t glyph = findGlyphFont(font, codePoint);
+
+    if (glyph == -1)
+    {
+        glyph = findGlyphFont(font, 0xFFFD);
+    }
+
+    if (glyph == -1)
+    {
+        glyph = findGlyphFont(font, '?');
+    }
+
+    return glyph;
+}
+
+//-------------------------------------------------------------------------
+
+const uint8_t *
+getGlyphFont(
+    const FONT_T *font,
+    uint32_t c)
+{
+    if (c >= (uint32_t)font->glyphs)
+    {
+        return NULL;
+    }
+
+    if (font->loadGlyph != NULL)
+    {
+        return font->loadGlyph(font, c);
+    }
+
+    return font->bitmaps + ((size_t)c * font->bytesPerGlyph);
+}
+
+//-------------------------------------------------------------------------
+//
+// Returns the bitmap of a glyph, or NULL if the font has no glyph for c.
+// Rows are font->bytesPerRow bytes, most significant bit leftmost.
+//
+
+static inline const uint8_t *
+glyphBitmap(
+    const FONT_T *font,
+    uint32_t c)
+{
+    if (font->bitsPerPixel != 1)
+    {
+        return NULL;
+    }
+
+    return getGlyphFont(font, c);
+}
+
+//-------------------------------------------------------------------------
+//
+// A byte of glyph row is drawn with a single store when all eight of its
+// pixels are visible, otherwise pixel by pixel within the clip. This also
+// keeps the padding bits at the end of each row from being drawn.
+//
+
+static inline bool
+wholeByte(
+    const GLYPH_CLIP_T *clip,
+    int16_t i)
+{
+    return (i >= clip->iStart) && ((i + FONT_MASK_WIDTH) <= clip->iEnd);
+}
+
+//-------------------------------------------------------------------------
+//
+// True if every column of the glyph is visible and it is a whole number
+// of bytes wide, so each byte can be stored without checking the clip.
+//
+
+static inline bool
+isWholeGlyph(
+    const FONT_T *font,
+    const GLYPH_CLIP_T *clip)
+{
+    return (clip->iStart == 0) &&
+           (clip->iEnd == font->width) &&
+           ((font->width % FONT_MASK_WIDTH) == 0);
+}
+
 //-------------------------------------------------------------------------
 
 FONT_POSITION_T
-drawCharRGB(
+drawCharFontRGB(
     int16_t x,
     int16_t y,
-    uint8_t c,
+    uint32_t c,
     const RGB8_T *rgb,
+    const FONT_T *font,
+    IMAGE_T *image)
+{
+    FONT_POSITION_T position = { x + font->width, y };
+    const uint8_t *glyph = glyphBitmap(font, c);
+    GLYPH_CLIP_T clip;
+
+    if ((glyph == NULL) ||
+        (image->setPixel == NULL) ||
+        (clipGlyph(font, x, y, image->width, image->height, &clip) == false))
+    {
+        return position;
+    }
+
+    // The pixels may be dithered, so each one still goes through the
+    // image's setPixel, but without checking its bounds.
+
+    int16_t j;
+    for (j = clip.jStart ; j < clip.jEnd ; j++)
+    {
+        const uint8_t *bits = glyph + (j * font->bytesPerRow);
+
+        int16_t i;
+        for (i = clip.iStart ; i < clip.iEnd ; ++i)
+        {
+            if ((bits[i / 8] >> (7 - (i % 8))) & 1)
+            {
+                image->setPixel(image, x + i, y + j, rgb);
+            }
+        }
+    }
+
+    damageImage(image,
+                x + clip.iStart,
+                y + clip.jStart,
+                clip.iEnd - clip.iStart,
+                clip.jEnd - clip.jStart);
+
+    return position;
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawCharFontRGB565(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint16_t rgb,
+    const FONT_T *font,
     IMAGE_T *image)
 {
+    FONT_POSITION_T position = { x + font->width, y };
+    const uint8_t *glyph = glyphBitmap(font, c);
+    GLYPH_CLIP_T clip;
+
+    if ((glyph == NULL) ||
+        (image->setPixel == NULL) ||
+        (clipGlyph(font, x, y, image->width, image->height, &clip) == false))
+    {
+        return position;
+    }
+
+    if (fontMasksInitialised == false)
+    {
+        initFontMasks();
+    }
+
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+    {
+        rgb = htons(rgb);
+    }
+
+    int16_t bytesPerRow = font->bytesPerRow;
+    int16_t pitch = image->width;
+
+    uint16_t *row = image->buffer + x + ((y + clip.jStart) * pitch);
+
+    bool whole = isWholeGlyph(font, &clip);
+
     int16_t j;
-    for (j = 0 ; j < FONT_HEIGHT ; j++)
+    for (j = clip.jStart ; j < clip.jEnd ; j++, row += pitch)
     {
-        uint8_t byte = font[c][j];
+        const uint8_t *bits = glyph + (j * bytesPerRow);
 
-        if (byte != 0)
+        if (whole)
         {
-            int16_t i;
-            for (i = 0 ; i < FONT_WIDTH ; ++i)
+            int16_t b;
+            for (b = 0 ; b < bytesPerRow ; b++)
+            {
+                if (bits[b] != 0)
+                {
+                    maskedStoreRGB565(row + (b * FONT_MASK_WIDTH),
+                                      fontMaskRGB565[bits[b]],
+                                      rgb);
+                }
+            }
+
+            continue;
+        }
+
+        int16_t b;
+        for (b = 0 ; b < bytesPerRow ; b++)
+        {
+            if (bits[b] == 0)
+            {
+                continue;
+            }
+
+            const uint16_t *mask = fontMaskRGB565[bits[b]];
+            int16_t i = b * FONT_MASK_WIDTH;
+
+            if (wholeByte(&clip, i))
+            {
+                maskedStoreRGB565(row + i, mask, rgb);
+                continue;
+            }
+
+            int16_t k;
+            for (k = 0 ; k < FONT_MASK_WIDTH ; k++, i++)
             {
-                if ((byte >> (FONT_WIDTH - i - 1)) & 1 )
+                if ((i >= clip.iStart) && (i < clip.iEnd))
                 {
-                    setPixelRGB(image, x + i, y + j, rgb);
+                    row[i] = (row[i] & ~mask[k]) | (rgb & mask[k]);
                 }
             }
         }
     }
 
-    FONT_POSITION_T position = { x + FONT_WIDTH, y };
+    damageImage(image,
+                x + clip.iStart,
+                y + clip.jStart,
+                clip.iEnd - clip.iStart,
+                clip.jEnd - clip.jStart);
+
     return position;
 }
 
 //-------------------------------------------------------------------------
 
 FONT_POSITION_T
-drawCharRGB565(
+drawCharOpaqueFontRGB565(
     int16_t x,
     int16_t y,
-    uint8_t c,
-    uint16_t rgb,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
     IMAGE_T *image)
 {
+    FONT_POSITION_T position = { x + font->width, y };
+    const uint8_t *glyph = glyphBitmap(font, c);
+    GLYPH_CLIP_T clip;
+
+    if ((image->setPixel == NULL) ||
+        (clipGlyph(font, x, y, image->width, image->height, &clip) == false))
+    {
+        return position;
+    }
+
+    if (fontMasksInitialised == false)
+    {
+        initFontMasks();
+    }
+
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+    {
+        foreground = htons(foreground);
+        background = htons(background);
+    }
+
+    int16_t bytesPerRow = font->bytesPerRow;
+    int16_t pitch = image->width;
+
+    uint16_t *row = image->buffer + x + ((y + clip.jStart) * pitch);
+
     int16_t j;
-    for (j = 0 ; j < FONT_HEIGHT ; j++)
+    for (j = clip.jStart ; j < clip.jEnd ; j++, row += pitch)
     {
-        uint8_t byte = font[c][j];
+        // A missing glyph is drawn as an empty cell.
+
+        const uint8_t *bits = (glyph != NULL)
+                            ? glyph + (j * bytesPerRow)
+                            : NULL;
 
-        if (byte != 0)
+        int16_t b;
+        for (b = 0 ; b < bytesPerRow ; b++)
         {
-            int16_t i;
-            for (i = 0 ; i < FONT_WIDTH ; ++i)
+            const uint16_t *mask = fontMaskRGB565[(bits) ? bits[b] : 0];
+            int16_t i = b * FONT_MASK_WIDTH;
+
+            if (wholeByte(&clip, i))
             {
-                if ((byte >> (FONT_WIDTH - i - 1)) & 1 )
+                selectStoreRGB565(row + i, mask, foreground, background);
+                continue;
+            }
+
+            int16_t k;
+            for (k = 0 ; k < FONT_MASK_WIDTH ; k++, i++)
+            {
+                if ((i >= clip.iStart) && (i < clip.iEnd))
                 {
-                    setPixelRGB565(image, x + i, y + j, rgb);
+                    row[i] = (background & ~mask[k]) | (foreground & mask[k]);
                 }
             }
         }
     }
 
-    FONT_POSITION_T position = { x + FONT_WIDTH, y };
+    damageImage(image,
+                x + clip.iStart,
+                y + clip.jStart,
+                clip.iEnd - clip.iStart,
+                clip.jEnd - clip.jStart);
+
     return position;
 }
 
 //-------------------------------------------------------------------------
 
 FONT_POSITION_T
-drawStringRGB(
+drawCharFontIndexed(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint8_t index,
+    const FONT_T *font,
+    INDEXED_IMAGE_T *image)
+{
+    FONT_POSITION_T position = { x + font->width, y };
+    const uint8_t *glyph = glyphBitmap(font, c);
+    GLYPH_CLIP_T clip;
+
+    if ((glyph == NULL) ||
+        (clipGlyph(font, x, y, image->width, image->height, &clip) == false))
+    {
+        return position;
+    }
+
+    if (fontMasksInitialised == false)
+    {
+        initFontMasks();
+    }
+
+    int16_t bytesPerRow = font->bytesPerRow;
+    int16_t pitch = image->width;
+
+    uint8_t *row = image->buffer + x + ((y + clip.jStart) * pitch);
+
+    int16_t j;
+    for (j = clip.jStart ; j < clip.jEnd ; j++, row += pitch)
+    {
+        const uint8_t *bits = glyph + (j * bytesPerRow);
+
+        int16_t b;
+        for (b = 0 ; b < bytesPerRow ; b++)
+        {
+            if (bits[b] == 0)
+            {
+                continue;
+            }
+
+            const uint8_t *mask = fontMaskIndexed[bits[b]];
+            int16_t i = b * FONT_MASK_WIDTH;
+
+            if (wholeByte(&clip, i))
+            {
+                maskedStoreIndexed(row + i, mask, index);
+                continue;
+            }
+
+            int16_t k;
+            for (k = 0 ; k < FONT_MASK_WIDTH ; k++, i++)
+            {
+                if ((i >= clip.iStart) && (i < clip.iEnd))
+                {
+                    row[i] = (row[i] & ~mask[k]) | (index & mask[k]);
+                }
+            }
+        }
+    }
+
+    return position;
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringFontRGB(
     int16_t x,
     int16_t y,
     const char *string,
     const RGB8_T *rgb,
+    const FONT_T *font,
     IMAGE_T *image)
 {
     if (string != NULL)
@@ -4726,14 +5397,20 @@ drawStringRGB(
             if (*string == '\n')
             {
                 x = x_first;
-                y += FONT_HEIGHT;
+                y += font->height;
+                ++string;
             }
             else
             {
-                drawCharRGB(x, y, *string, rgb, image);
-                x += FONT_WIDTH;
+                int32_t glyph = nextGlyphFont(font, &string);
+
+                if (glyph != -1)
+                {
+                    drawCharFontRGB(x, y, glyph, rgb, font, image);
+                }
+
+                x += font->width;
             }
-            ++string;
         }
     }
 
@@ -4744,11 +5421,12 @@ drawStringRGB(
 //-------------------------------------------------------------------------
 
 FONT_POSITION_T
-drawStringRGB565(
+drawStringFontRGB565(
     int16_t x,
     int16_t y,
     const char *string,
     uint16_t rgb,
+    const FONT_T *font,
     IMAGE_T *image)
 {
     if (string != NULL)
@@ -4760,14 +5438,69 @@ drawStringRGB565(
             if (*string == '\n')
             {
                 x = x_first;
-                y += FONT_HEIGHT;
+                y += font->height;
+                ++string;
             }
             else
             {
-                drawCharRGB565(x, y, *string, rgb, image);
-                x += FONT_WIDTH;
+                int32_t glyph = nextGlyphFont(font, &string);
+
+                if (glyph != -1)
+                {
+                    drawCharFontRGB565(x, y, glyph, rgb, font, image);
+                }
+
+                x += font->width;
+            }
+        }
+    }
+
+    FONT_POSITION_T position = { x, y };
+    return position;
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringOpaqueFontRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    IMAGE_T *image)
+{
+    if (string != NULL)
+    {
+        int16_t x_first = x;
+
+        while (*string != '\0')
+        {
+            if (*string == '\n')
+            {
+                x = x_first;
+                y += font->height;
+                ++string;
+            }
+            else
+            {
+                int32_t glyph = nextGlyphFont(font, &string);
+
+                // With no glyph (-1 is past the font's last glyph) the
+                // cell is filled with the background, so nothing already
+                // under it is left showing.
+
+                drawCharOpaqueFontRGB565(x,
+                                         y,
+                                         glyph,
+                                         foreground,
+                                         background,
+                                         font,
+                                         image);
+
+                x += font->width;
             }
-            ++string;
         }
     }
 
@@ -4775,3 +5508,162 @@ drawStringRGB565(
     return position;
 }
 
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringFontIndexed(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint8_t index,
+    const FONT_T *font,
+    INDEXED_IMAGE_T *image)
+{
+    if (string != NULL)
+    {
+        int16_t x_first = x;
+
+        while (*string != '\0')
+        {
+            if (*string == '\n')
+            {
+                x = x_first;
+                y += font->height;
+                ++string;
+            }
+            else
+            {
+                int32_t glyph = nextGlyphFont(font, &string);
+
+                if (glyph != -1)
+                {
+                    drawCharFontIndexed(x, y, glyph, index, font, image);
+                }
+
+                x += font->width;
+            }
+        }
+    }
+
+    FONT_POSITION_T position = { x, y };
+    return position;
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawCharRGB(
+    int16_t x,
+    int16_t y,
+    uint8_t c,
+    const RGB8_T *rgb,
+    IMAGE_T *image)
+{
+    return drawCharFontRGB(x, y, c, rgb, &defaultFont, image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawCharRGB565(
+    int16_t x,
+    int16_t y,
+    uint8_t c,
+    uint16_t rgb,
+    IMAGE_T *image)
+{
+    return drawCharFontRGB565(x, y, c, rgb, &defaultFont, image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawCharOpaqueRGB565(
+    int16_t x,
+    int16_t y,
+    uint8_t c,
+    uint16_t foreground,
+    uint16_t background,
+    IMAGE_T *image)
+{
+    return drawCharOpaqueFontRGB565(x,
+                                    y,
+                                    c,
+                                    foreground,
+                                    background,
+                                    &defaultFont,
+                                    image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringRGB(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    const RGB8_T *rgb,
+    IMAGE_T *image)
+{
+    return drawStringFontRGB(x, y, string, rgb, &defaultFont, image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t rgb,
+    IMAGE_T *image)
+{
+    return drawStringFontRGB565(x, y, string, rgb, &defaultFont, image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringOpaqueRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background,
+    IMAGE_T *image)
+{
+    return drawStringOpaqueFontRGB565(x,
+                                      y,
+                                      string,
+                                      foreground,
+                                      background,
+                                      &defaultFont,
+                                      image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawCharIndexed(
+    int16_t x,
+    int16_t y,
+    uint8_t c,
+    uint8_t index,
+    INDEXED_IMAGE_T *image)
+{
+    return drawCharFontIndexed(x, y, c, index, &defaultFont, image);
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringIndexed(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint8_t index,
+    INDEXED_IMAGE_T *image)
+{
+    return drawStringFontIndexed(x, y, string, index, &defaultFont, image);
+}
+
@@ -31,9 +31,11 @@
 
 //-------------------------------------------------------------------------
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "image.h"
+#include "indexedImage.h"
 
 //-------------------------------------------------------------------------
 
@@ -48,6 +50,153 @@ typedef struct
     int16_t y;
 } FONT_POSITION_T;
 
+//-------------------------------------------------------------------------
+//
+// A fixed size bitmap font. Each glyph is height rows of bytesPerRow
+// bytes and glyph c starts at bitmaps + (c * bytesPerGlyph). With one bit
+// per pixel the most significant bit is leftmost. With four bits per pixel
+// each pixel is a coverage from 0 to FONT_COVERAGE_MAX, high nibble
+// leftmost; such anti-aliased fonts are only drawn through a glyph cache.
+// The bitmaps of a font loaded from a file are either mapped from the
+// file (map) or decoded into buffer.
+//
+// Strings are UTF-8. A font may map Unicode code points to its glyphs
+// (findGlyph), otherwise code point c is glyph c. A font may also load
+// its glyphs only as they are drawn (loadGlyph, using store), otherwise
+// they are all in bitmaps.
+//
+// Each font loaded from a file has its own id, so that glyphs cached for
+// it are not mistaken for those of a font later loaded at the same
+// address. The built in font is id 0.
+//
+
+#define FONT_COVERAGE_BITS 4
+#define FONT_COVERAGE_MAX ((1 << FONT_COVERAGE_BITS) - 1)
+
+typedef struct FONT_T_ FONT_T;
+
+struct FONT_T_
+{
+    uint32_t id;
+    int16_t width;
+    int16_t height;
+    int16_t bitsPerPixel;
+    int16_t bytesPerRow;
+    int32_t bytesPerGlyph;
+    int32_t glyphs;
+    const uint8_t *bitmaps;
+    void *map;
+    size_t mapLength;
+    uint8_t *buffer;
+    int32_t (*findGlyph)(const FONT_T*, uint32_t);
+    const uint8_t *(*loadGlyph)(const FONT_T*, uint32_t);
+    void *store;
+};
+
+// The built in 8x16 font used by the functions without a FONT_T.
+
+extern const FONT_T defaultFont;
+
+//-------------------------------------------------------------------------
+
+// Returns the glyph for a Unicode code point, or -1 if the font has none.
+
+int32_t
+findGlyphFont(
+    const FONT_T *font,
+    uint32_t codePoint);
+
+// Decode the next character of a UTF-8 string, advancing the string past
+// it, and return its glyph (or a replacement, or -1 if there is neither).
+// A byte that does not start a valid UTF-8 sequence is taken to be a code
+// page 437 character, so strings of single byte characters still work.
+
+int32_t
+nextGlyphFont(
+    const FONT_T *font,
+    const char **string);
+
+// Returns the bitmap of glyph c, or NULL if the font has no such glyph.
+
+const uint8_t *
+getGlyphFont(
+    const FONT_T *font,
+    uint32_t c);
+
+FONT_POSITION_T
+drawCharFontRGB(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    const RGB8_T *rgb,
+    const FONT_T *font,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawCharFontRGB565(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint16_t rgb,
+    const FONT_T *font,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawCharOpaqueFontRGB565(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawCharFontIndexed(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint8_t index,
+    const FONT_T *font,
+    INDEXED_IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringFontRGB(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    const RGB8_T *rgb,
+    const FONT_T *font,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringFontRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t rgb,
+    const FONT_T *font,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringOpaqueFontRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringFontIndexed(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint8_t index,
+    const FONT_T *font,
+    INDEXED_IMAGE_T *image);
+
 //-------------------------------------------------------------------------
 
 FONT_POSITION_T
@@ -82,6 +231,44 @@ drawStringRGB565(
     uint16_t rgb,
     IMAGE_T *image);
 
+// The opaque versions write every pixel of each character cell, in the
+// background colour where the glyph is not set, so new text overwrites
+// old text without the image being cleared first.
+
+FONT_POSITION_T
+drawCharOpaqueRGB565(
+    int16_t x,
+    int16_t y,
+    uint8_t c,
+    uint16_t foreground,
+    uint16_t background,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringOpaqueRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawCharIndexed(
+    int16_t x,
+    int16_t y,
+    uint8_t c,
+    uint8_t index,
+    INDEXED_IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringIndexed(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint8_t index,
+    INDEXED_IMAGE_T *image);
+
 //-------------------------------------------------------------------------
 
 #endif
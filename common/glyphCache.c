@@ -0,0 +1,468 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "font.h"
+#include "glyphCache.h"
+#include "image.h"
+
+//-------------------------------------------------------------------------
+
+static uint32_t
+hashGlyph(
+    uint32_t fontId,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background)
+{
+    uint32_t hash = fontId;
+
+    hash = (hash * 31) + c;
+    hash = (hash * 31) + foreground;
+    hash = (hash * 31) + background;
+
+    return hash ^ (hash >> 16);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+unlinkEntry(
+    GLYPH_CACHE_T *cache,
+    int32_t index)
+{
+    GLYPH_CACHE_ENTRY_T *entry = &(cache->entries[index]);
+
+    uint32_t hash = hashGlyph(entry->fontId,
+                              entry->c,
+                              entry->foreground,
+                              entry->background);
+
+    int32_t *link = &(cache->bucket[hash & (cache->buckets - 1)]);
+
+    while (*link != -1)
+    {
+        if (*link == index)
+        {
+            *link = entry->next;
+            return;
+        }
+
+        link = &(cache->entries[*link].next);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+removeFromUseList(
+    GLYPH_CACHE_T *cache,
+    int32_t index)
+{
+    GLYPH_CACHE_ENTRY_T *entry = &(cache->entries[index]);
+
+    if (entry->newer == -1)
+    {
+        cache->newest = entry->older;
+    }
+    else
+    {
+        cache->entries[entry->newer].older = entry->older;
+    }
+
+    if (entry->older == -1)
+    {
+        cache->oldest = entry->newer;
+    }
+    else
+    {
+        cache->entries[entry->older].newer = entry->newer;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+addNewestToUseList(
+    GLYPH_CACHE_T *cache,
+    int32_t index)
+{
+    GLYPH_CACHE_ENTRY_T *entry = &(cache->entries[index]);
+
+    entry->newer = -1;
+    entry->older = cache->newest;
+
+    if (cache->newest == -1)
+    {
+        cache->oldest = index;
+    }
+    else
+    {
+        cache->entries[cache->newest].newer = index;
+    }
+
+    cache->newest = index;
+}
+
+//-------------------------------------------------------------------------
+//
+// Blend the glyph into the entry's cell. A bitmap glyph has full coverage
+// where its bits are set.
+//
+
+static void
+renderGlyph(
+    GLYPH_CACHE_ENTRY_T *entry,
+    const FONT_T *font)
+{
+    uint32_t foreground = spreadRGB565(entry->foreground);
+    uint32_t background = spreadRGB565(entry->background);
+
+    const uint8_t *glyph = getGlyphFont(font, entry->c);
+
+    uint16_t *pixel = entry->pixels;
+
+    int16_t j;
+    for (j = 0 ; j < font->height ; j++)
+    {
+        const uint8_t *row = (glyph) ? glyph + (j * font->bytesPerRow) : NULL;
+
+        int16_t i;
+        for (i = 0 ; i < font->width ; i++)
+        {
+            uint8_t coverage = 0;
+
+            if (row == NULL)
+            {
+                coverage = 0;
+            }
+            else if (font->bitsPerPixel == 1)
+            {
+                coverage = ((row[i / 8] >> (7 - (i % 8))) & 1)
+                         ? FONT_COVERAGE_MAX
+                         : 0;
+            }
+            else
+            {
+                coverage = (i % 2) ? (row[i / 2] & 0x0F) : (row[i / 2] >> 4);
+            }
+
+            // Coverage from 0 to 15 scaled to an alpha from 0 to 32.
+
+            uint8_t alpha = ((coverage * RGB565_FADE_STEPS)
+                             + (FONT_COVERAGE_MAX / 2))
+                          / FONT_COVERAGE_MAX;
+
+            uint32_t blended = (background * (RGB565_FADE_STEPS - alpha))
+                             + (foreground * alpha)
+                             + RGB565_SPREAD_ROUND;
+
+            *pixel++ = packSpreadRGB565(blended >> RGB565_FADE_BITS);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initGlyphCache(
+    GLYPH_CACHE_T *cache,
+    int32_t size)
+{
+    if (size < 1)
+    {
+        return false;
+    }
+
+    cache->size = size;
+    cache->used = 0;
+    cache->newest = -1;
+    cache->oldest = -1;
+    cache->hits = 0;
+    cache->misses = 0;
+
+    // Twice as many buckets as entries, rounded up to a power of two.
+
+    cache->buckets = 1;
+
+    while (cache->buckets < (2 * size))
+    {
+        cache->buckets <<= 1;
+    }
+
+    cache->bucket = malloc(cache->buckets * sizeof(int32_t));
+    cache->entries = calloc(size, sizeof(GLYPH_CACHE_ENTRY_T));
+
+    if ((cache->bucket == NULL) || (cache->entries == NULL))
+    {
+        perror("glyphCache: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t index;
+    for (index = 0 ; index < cache->buckets ; index++)
+    {
+        cache->bucket[index] = -1;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// Returns the glyph's cell, font->width by font->height pixels in native
+// byte order, rendering it first if it is not already cached. The cell
+// is only valid until the next call.
+//
+
+const uint16_t *
+getCachedGlyph(
+    GLYPH_CACHE_T *cache,
+    const FONT_T *font,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background)
+{
+    uint32_t hash = hashGlyph(font->id, c, foreground, background);
+    int32_t *bucket = &(cache->bucket[hash & (cache->buckets - 1)]);
+
+    int32_t index;
+    for (index = *bucket ; index != -1 ; index = cache->entries[index].next)
+    {
+        GLYPH_CACHE_ENTRY_T *entry = &(cache->entries[index]);
+
+        if ((entry->fontId == font->id) &&
+            (entry->c == c) &&
+            (entry->foreground == foreground) &&
+            (entry->background == background))
+        {
+            ++(cache->hits);
+
+            if (index != cache->newest)
+            {
+                removeFromUseList(cache, index);
+                addNewestToUseList(cache, index);
+            }
+
+            return entry->pixels;
+        }
+    }
+
+    //---------------------------------------------------------------------
+
+    ++(cache->misses);
+
+    if (cache->used < cache->size)
+    {
+        index = cache->used++;
+    }
+    else
+    {
+        index = cache->oldest;
+        unlinkEntry(cache, index);
+        removeFromUseList(cache, index);
+    }
+
+    GLYPH_CACHE_ENTRY_T *entry = &(cache->entries[index]);
+    int32_t length = font->width * font->height;
+
+    if (entry->length != length)
+    {
+        free(entry->pixels);
+        entry->pixels = malloc(length * sizeof(uint16_t));
+        entry->length = length;
+
+        if (entry->pixels == NULL)
+        {
+            perror("glyphCache: memory exhausted\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    entry->fontId = font->id;
+    entry->c = c;
+    entry->foreground = foreground;
+    entry->background = background;
+    entry->next = *bucket;
+    *bucket = index;
+
+    addNewestToUseList(cache, index);
+
+    renderGlyph(entry, font);
+
+    return entry->pixels;
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawCharCachedRGB565(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    GLYPH_CACHE_T *cache,
+    IMAGE_T *image)
+{
+    FONT_POSITION_T position = { x + font->width, y };
+
+    int16_t iStart = (x < 0) ? -x : 0;
+    int16_t jStart = (y < 0) ? -y : 0;
+    int16_t iEnd = font->width;
+    int16_t jEnd = font->height;
+
+    if ((x + iEnd) > image->width)
+    {
+        iEnd = image->width - x;
+    }
+
+    if ((y + jEnd) > image->height)
+    {
+        jEnd = image->height - y;
+    }
+
+    if ((iStart >= iEnd) || (jStart >= jEnd))
+    {
+        return position;
+    }
+
+    const uint16_t *cell = getCachedGlyph(cache,
+                                          font,
+                                          c,
+                                          foreground,
+                                          background);
+
+    bool bigEndian = (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN);
+    int16_t length = iEnd - iStart;
+
+    int16_t j;
+    for (j = jStart ; j < jEnd ; j++)
+    {
+        uint16_t *to = image->buffer + x + iStart + ((y + j) * image->width);
+        const uint16_t *from = cell + iStart + (j * font->width);
+
+        if (bigEndian)
+        {
+            htonsRGB565(to, from, length);
+        }
+        else
+        {
+            memcpy(to, from, length * sizeof(uint16_t));
+        }
+    }
+
+    damageImage(image, x + iStart, y + jStart, length, jEnd - jStart);
+
+    return position;
+}
+
+//-------------------------------------------------------------------------
+
+FONT_POSITION_T
+drawStringCachedRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    GLYPH_CACHE_T *cache,
+    IMAGE_T *image)
+{
+    if (string != NULL)
+    {
+        int16_t x_first = x;
+
+        while (*string != '\0')
+        {
+            if (*string == '\n')
+            {
+                x = x_first;
+                y += font->height;
+                ++string;
+            }
+            else
+            {
+                int32_t glyph = nextGlyphFont(font, &string);
+
+                // With no glyph (-1 is past the font's last glyph) the
+                // cell is filled with the background.
+
+                drawCharCachedRGB565(x,
+                                     y,
+                                     glyph,
+                                     foreground,
+                                     background,
+                                     font,
+                                     cache,
+                                     image);
+
+                x += font->width;
+            }
+        }
+    }
+
+    FONT_POSITION_T position = { x, y };
+    return position;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyGlyphCache(
+    GLYPH_CACHE_T *cache)
+{
+    int32_t index;
+    for (index = 0 ; index < cache->size ; index++)
+    {
+        free(cache->entries[index].pixels);
+    }
+
+    free(cache->entries);
+    free(cache->bucket);
+
+    cache->size = 0;
+    cache->used = 0;
+    cache->buckets = 0;
+    cache->newest = -1;
+    cache->oldest = -1;
+    cache->entries = NULL;
+    cache->bucket = NULL;
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,120 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "font.h"
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// Glyphs drawn opaque, already blended from their coverage (or bits) with
+// the foreground and background colours, kept as RGB565 cells. Drawing a
+// cached glyph is a copy of its rows into the image. The cache holds at
+// most size glyphs, the least recently used being replaced when it is
+// full. Entries are keyed by the font's id, and are kept in a list from
+// newest to oldest use (newer and older), so the one to replace is always
+// at the end of the list.
+//
+
+typedef struct
+{
+    uint32_t fontId;
+    uint32_t c;
+    uint16_t foreground;
+    uint16_t background;
+    int32_t next;
+    int32_t newer;
+    int32_t older;
+    int32_t length;
+    uint16_t *pixels;
+} GLYPH_CACHE_ENTRY_T;
+
+typedef struct
+{
+    int32_t size;
+    int32_t used;
+    int32_t buckets;
+    int32_t newest;
+    int32_t oldest;
+    uint32_t hits;
+    uint32_t misses;
+    int32_t *bucket;
+    GLYPH_CACHE_ENTRY_T *entries;
+} GLYPH_CACHE_T;
+
+//-------------------------------------------------------------------------
+
+bool
+initGlyphCache(
+    GLYPH_CACHE_T *cache,
+    int32_t size);
+
+const uint16_t *
+getCachedGlyph(
+    GLYPH_CACHE_T *cache,
+    const FONT_T *font,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background);
+
+FONT_POSITION_T
+drawCharCachedRGB565(
+    int16_t x,
+    int16_t y,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    GLYPH_CACHE_T *cache,
+    IMAGE_T *image);
+
+FONT_POSITION_T
+drawStringCachedRGB565(
+    int16_t x,
+    int16_t y,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background,
+    const FONT_T *font,
+    GLYPH_CACHE_T *cache,
+    IMAGE_T *image);
+
+void
+destroyGlyphCache(
+    GLYPH_CACHE_T *cache);
+
+//-------------------------------------------------------------------------
+
+#endif
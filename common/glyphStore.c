@@ -0,0 +1,348 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glyphStore.h"
+
+//-------------------------------------------------------------------------
+
+static uint32_t
+hashGlyph(
+    int32_t glyph)
+{
+    uint32_t hash = (uint32_t)glyph * 2654435761U;
+
+    return hash ^ (hash >> 16);
+}
+
+//-------------------------------------------------------------------------
+
+static int
+compareIndex(
+    const void *a,
+    const void *b)
+{
+    uint32_t codePointA = ((const GLYPH_STORE_INDEX_T *)a)->codePoint;
+    uint32_t codePointB = ((const GLYPH_STORE_INDEX_T *)b)->codePoint;
+
+    return (codePointA > codePointB) - (codePointA < codePointB);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+unlinkSlot(
+    GLYPH_STORE_T *store,
+    int32_t index)
+{
+    GLYPH_STORE_SLOT_T *slot = &(store->slots[index]);
+
+    uint32_t hash = hashGlyph(slot->glyph);
+    int32_t *link = &(store->bucket[hash & (store->buckets - 1)]);
+
+    while (*link != -1)
+    {
+        if (*link == index)
+        {
+            *link = slot->next;
+            return;
+        }
+
+        link = &(store->slots[*link].next);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+removeFromUseList(
+    GLYPH_STORE_T *store,
+    int32_t index)
+{
+    GLYPH_STORE_SLOT_T *slot = &(store->slots[index]);
+
+    if (slot->newer == -1)
+    {
+        store->newest = slot->older;
+    }
+    else
+    {
+        store->slots[slot->newer].older = slot->older;
+    }
+
+    if (slot->older == -1)
+    {
+        store->oldest = slot->newer;
+    }
+    else
+    {
+        store->slots[slot->older].newer = slot->newer;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+addNewestToUseList(
+    GLYPH_STORE_T *store,
+    int32_t index)
+{
+    GLYPH_STORE_SLOT_T *slot = &(store->slots[index]);
+
+    slot->newer = -1;
+    slot->older = store->newest;
+
+    if (store->newest == -1)
+    {
+        store->oldest = index;
+    }
+    else
+    {
+        store->slots[store->newest].newer = index;
+    }
+
+    store->newest = index;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initGlyphStore(
+    GLYPH_STORE_T *store,
+    int32_t glyphs,
+    int32_t bytesPerGlyph,
+    int32_t size)
+{
+    if ((glyphs < 1) || (bytesPerGlyph < 1) || (size < 1))
+    {
+        return false;
+    }
+
+    store->glyphs = glyphs;
+    store->bytesPerGlyph = bytesPerGlyph;
+    store->size = size;
+    store->used = 0;
+    store->newest = -1;
+    store->oldest = -1;
+    store->hits = 0;
+    store->misses = 0;
+
+    // Twice as many buckets as slots, rounded up to a power of two.
+
+    store->buckets = 1;
+
+    while (store->buckets < (2 * size))
+    {
+        store->buckets <<= 1;
+    }
+
+    store->index = calloc(glyphs, sizeof(GLYPH_STORE_INDEX_T));
+    store->bucket = malloc(store->buckets * sizeof(int32_t));
+    store->slots = calloc(size, sizeof(GLYPH_STORE_SLOT_T));
+    store->bitmaps = malloc(size * bytesPerGlyph);
+
+    if ((store->index == NULL) ||
+        (store->bucket == NULL) ||
+        (store->slots == NULL) ||
+        (store->bitmaps == NULL))
+    {
+        perror("glyphStore: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t index;
+    for (index = 0 ; index < store->buckets ; index++)
+    {
+        store->bucket[index] = -1;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+sortGlyphStoreIndex(
+    GLYPH_STORE_T *store)
+{
+    qsort(store->index,
+          store->glyphs,
+          sizeof(GLYPH_STORE_INDEX_T),
+          compareIndex);
+
+    int32_t glyphs = 0;
+
+    int32_t index;
+    for (index = 0 ; index < store->glyphs ; index++)
+    {
+        if ((glyphs == 0) ||
+            (store->index[index].codePoint !=
+             store->index[glyphs - 1].codePoint))
+        {
+            store->index[glyphs++] = store->index[index];
+        }
+    }
+
+    store->glyphs = glyphs;
+}
+
+//-------------------------------------------------------------------------
+
+int32_t
+findGlyphStoreIndex(
+    const GLYPH_STORE_T *store,
+    uint32_t codePoint)
+{
+    int32_t low = 0;
+    int32_t high = store->glyphs - 1;
+
+    while (low <= high)
+    {
+        int32_t middle = low + ((high - low) / 2);
+        uint32_t value = store->index[middle].codePoint;
+
+        if (value == codePoint)
+        {
+            return middle;
+        }
+        else if (value < codePoint)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+
+uint8_t *
+findStoredGlyph(
+    GLYPH_STORE_T *store,
+    int32_t glyph)
+{
+    uint32_t hash = hashGlyph(glyph);
+
+    int32_t index;
+    for (index = store->bucket[hash & (store->buckets - 1)] ;
+         index != -1 ;
+         index = store->slots[index].next)
+    {
+        GLYPH_STORE_SLOT_T *slot = &(store->slots[index]);
+
+        if (slot->glyph == glyph)
+        {
+            ++(store->hits);
+
+            if (index != store->newest)
+            {
+                removeFromUseList(store, index);
+                addNewestToUseList(store, index);
+            }
+
+            return store->bitmaps + (index * store->bytesPerGlyph);
+        }
+    }
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+uint8_t *
+addStoredGlyph(
+    GLYPH_STORE_T *store,
+    int32_t glyph)
+{
+    ++(store->misses);
+
+    int32_t index = 0;
+
+    if (store->used < store->size)
+    {
+        index = store->used++;
+    }
+    else
+    {
+        index = store->oldest;
+        unlinkSlot(store, index);
+        removeFromUseList(store, index);
+    }
+
+    uint32_t hash = hashGlyph(glyph);
+    int32_t *bucket = &(store->bucket[hash & (store->buckets - 1)]);
+
+    GLYPH_STORE_SLOT_T *slot = &(store->slots[index]);
+
+    slot->glyph = glyph;
+    slot->next = *bucket;
+    *bucket = index;
+
+    addNewestToUseList(store, index);
+
+    uint8_t *bitmap = store->bitmaps + (index * store->bytesPerGlyph);
+    memset(bitmap, 0, store->bytesPerGlyph);
+
+    return bitmap;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyGlyphStore(
+    GLYPH_STORE_T *store)
+{
+    free(store->index);
+    free(store->bucket);
+    free(store->slots);
+    free(store->bitmaps);
+
+    store->glyphs = 0;
+    store->size = 0;
+    store->used = 0;
+    store->newest = -1;
+    store->oldest = -1;
+    store->index = NULL;
+    store->bucket = NULL;
+    store->slots = NULL;
+    store->bitmaps = NULL;
+}
+
+//-------------------------------------------------------------------------
+
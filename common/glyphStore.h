@@ -0,0 +1,123 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef GLYPH_STORE_H
+#define GLYPH_STORE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+//
+// The glyphs of a font too big to hold in memory. The index, sorted by
+// code point, gives where each glyph is in the font's (mapped) file; a
+// glyph's number is its position in the index. At most size glyph
+// bitmaps are held, the least recently used being replaced when the
+// store is full. The slots are kept in a list from newest to oldest use
+// (newer and older), so the one to replace is always at the end of the
+// list.
+//
+
+typedef struct
+{
+    uint32_t codePoint;
+    uint32_t offset;
+} GLYPH_STORE_INDEX_T;
+
+typedef struct
+{
+    int32_t glyph;
+    int32_t next;
+    int32_t newer;
+    int32_t older;
+} GLYPH_STORE_SLOT_T;
+
+typedef struct
+{
+    int32_t glyphs;
+    GLYPH_STORE_INDEX_T *index;
+    int32_t bytesPerGlyph;
+    int32_t size;
+    int32_t used;
+    int32_t buckets;
+    int32_t newest;
+    int32_t oldest;
+    uint32_t hits;
+    uint32_t misses;
+    int32_t *bucket;
+    GLYPH_STORE_SLOT_T *slots;
+    uint8_t *bitmaps;
+} GLYPH_STORE_T;
+
+//-------------------------------------------------------------------------
+
+bool
+initGlyphStore(
+    GLYPH_STORE_T *store,
+    int32_t glyphs,
+    int32_t bytesPerGlyph,
+    int32_t size);
+
+// Sort the index by code point once it has been filled in, dropping any
+// duplicate code points.
+
+void
+sortGlyphStoreIndex(
+    GLYPH_STORE_T *store);
+
+// Returns the number of the glyph for codePoint, or -1 if there is none.
+
+int32_t
+findGlyphStoreIndex(
+    const GLYPH_STORE_T *store,
+    uint32_t codePoint);
+
+// Returns the bitmap of the glyph if it is held, otherwise NULL.
+
+uint8_t *
+findStoredGlyph(
+    GLYPH_STORE_T *store,
+    int32_t glyph);
+
+// Returns space (cleared) for the bitmap of the glyph, replacing the
+// least recently used glyph if the store is full. The caller fills it in.
+
+uint8_t *
+addStoredGlyph(
+    GLYPH_STORE_T *store,
+    int32_t glyph);
+
+void
+destroyGlyphStore(
+    GLYPH_STORE_T *store);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -32,10 +32,42 @@
 
 #include <arpa/inet.h>
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "image.h"
 
 //-------------------------------------------------------------------------
 
+const uint8_t ditherRedBlueRGB565[64] =
+{
+    1, 6, 2, 7, 1, 6, 2, 7,
+    4, 2, 5, 4, 4, 3, 6, 4,
+    1, 7, 1, 6, 2, 7, 1, 7,
+    5, 3, 5, 3, 5, 4, 5, 3,
+    1, 6, 2, 7, 1, 6, 2, 7,
+    4, 3, 6, 4, 4, 2, 6, 4,
+    2, 7, 1, 7, 2, 7, 1, 6,
+    5, 3, 5, 3, 5, 3, 5, 3,
+};
+
+const uint8_t ditherGreenRGB565[64] =
+{
+    1, 3, 1, 3, 1, 3, 1, 3,
+    2, 1, 3, 2, 2, 1, 3, 2,
+    1, 3, 1, 3, 1, 3, 1, 3,
+    2, 2, 2, 1, 3, 2, 2, 2,
+    1, 3, 1, 3, 1, 3, 1, 3,
+    2, 1, 3, 2, 2, 1, 3, 2,
+    1, 3, 1, 3, 1, 3, 1, 3,
+    3, 2, 2, 2, 2, 2, 2, 2,
+};
+
+//-------------------------------------------------------------------------
+
 void
 clearImageDirect(
     IMAGE_T *image,
@@ -79,9 +111,7 @@ packRGB565(
     uint8_t g6 = green >> 2;
     uint8_t b5 = blue >> 3;
 
-    uint16_t pixel = (r5 << 11) | (g6 << 5) | b5;
-
-    return htons(pixel);
+    return (r5 << 11) | (g6 << 5) | b5;
 }
 
 //-----------------------------------------------------------------------
@@ -91,11 +121,9 @@ unpackRGB565(
     uint16_t packed,
     RGB8_T *rgb)
 {
-    uint16_t pixel = ntohs(packed);
-
-    uint8_t r5 = (pixel >> 11) & 0x1F;
-    uint8_t g6 = (pixel >> 5) & 0x3F;
-    uint8_t b5 = pixel & 0x1F;
+    uint8_t r5 = (packed >> 11) & 0x1F;
+    uint8_t g6 = (packed >> 5) & 0x3F;
+    uint8_t b5 = packed & 0x1F;
 
     rgb->red = (r5 << 3) | (r5 >> 2);
     rgb->green = (g6 << 2) | (g6 >> 4);
@@ -159,6 +187,230 @@ blendRGB(
                  / 255;
 }
 
+//-------------------------------------------------------------------------
+//
+// Copy length pixels from src to dst converting them from native to
+// big-endian byte order (or back again, the conversion is symmetric).
+// src and dst may be the same buffer. On a big-endian host this is just
+// a copy.
+//
+
+void
+htonsRGB565(
+    uint16_t *dst,
+    const uint16_t *src,
+    int32_t length)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+
+    if (dst != src)
+    {
+        memmove(dst, src, length * sizeof(uint16_t));
+    }
+
+#else
+
+    int32_t i = 0;
+
+#if defined(__ARM_NEON)
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        uint8x16_t pixels = vld1q_u8((const uint8_t *)(src + i));
+        vst1q_u8((uint8_t *)(dst + i), vrev16q_u8(pixels));
+    }
+
+#elif defined(__SSE2__)
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+
+        pixels = _mm_or_si128(_mm_slli_epi16(pixels, 8),
+                              _mm_srli_epi16(pixels, 8));
+
+        _mm_storeu_si128((__m128i *)(dst + i), pixels);
+    }
+
+#else
+
+    // Two pixels at a time in a 32 bit word.
+
+    for ( ; (i + 2) <= length ; i += 2)
+    {
+        uint32_t pixels;
+        memcpy(&pixels, src + i, sizeof(pixels));
+
+        pixels = ((pixels & 0x00FF00FF) << 8) | ((pixels >> 8) & 0x00FF00FF);
+
+        memcpy(dst + i, &pixels, sizeof(pixels));
+    }
+
+#endif
+
+    for ( ; i < length ; i++)
+    {
+        dst[i] = (src[i] << 8) | (src[i] >> 8);
+    }
+
+#endif
+}
+
+//-------------------------------------------------------------------------
+//
+// Set length pixels starting at dst to rgb using the widest stores
+// available.
+//
+
+void
+fillRGB565(
+    uint16_t *dst,
+    uint16_t rgb,
+    int32_t length)
+{
+    int32_t i = 0;
+
+#if defined(__ARM_NEON)
+
+    uint16x8_t pixels = vdupq_n_u16(rgb);
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        vst1q_u16(dst + i, pixels);
+    }
+
+#elif defined(__SSE2__)
+
+    __m128i pixels = _mm_set1_epi16(rgb);
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        _mm_storeu_si128((__m128i *)(dst + i), pixels);
+    }
+
+#else
+
+    uint32_t pixels = rgb | ((uint32_t)rgb << 16);
+
+    for ( ; (i + 2) <= length ; i += 2)
+    {
+        memcpy(dst + i, &pixels, sizeof(pixels));
+    }
+
+#endif
+
+    for ( ; i < length ; i++)
+    {
+        dst[i] = rgb;
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Blend two rows of native RGB565 pixels, alpha (0 to RGB565_FADE_STEPS)
+// is the weight given to b. The SIMD versions split the fields into
+// separate 16 bit lanes, the scalar version spreads each pixel across a
+// 32 bit word so that all three fields are multiplied at once.
+//
+
+void
+crossFadeRGB565(
+    uint16_t *dst,
+    const uint16_t *a,
+    const uint16_t *b,
+    uint8_t alpha,
+    int32_t length)
+{
+    int32_t i = 0;
+
+#if defined(__ARM_NEON)
+
+    uint16x8_t wa = vdupq_n_u16(RGB565_FADE_STEPS - alpha);
+    uint16x8_t wb = vdupq_n_u16(alpha);
+    uint16x8_t mask5 = vdupq_n_u16(0x1F);
+    uint16x8_t mask6 = vdupq_n_u16(0x3F);
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        uint16x8_t pa = vld1q_u16(a + i);
+        uint16x8_t pb = vld1q_u16(b + i);
+
+        uint16x8_t red = vmlaq_u16(vmulq_u16(vshrq_n_u16(pa, 11), wa),
+                                   vshrq_n_u16(pb, 11),
+                                   wb);
+
+        uint16x8_t green =
+            vmlaq_u16(vmulq_u16(vandq_u16(vshrq_n_u16(pa, 5), mask6), wa),
+                      vandq_u16(vshrq_n_u16(pb, 5), mask6),
+                      wb);
+
+        uint16x8_t blue = vmlaq_u16(vmulq_u16(vandq_u16(pa, mask5), wa),
+                                    vandq_u16(pb, mask5),
+                                    wb);
+
+        red = vrshrq_n_u16(red, RGB565_FADE_BITS);
+        green = vrshrq_n_u16(green, RGB565_FADE_BITS);
+        blue = vrshrq_n_u16(blue, RGB565_FADE_BITS);
+
+        vst1q_u16(dst + i,
+                  vorrq_u16(vshlq_n_u16(red, 11),
+                            vorrq_u16(vshlq_n_u16(green, 5), blue)));
+    }
+
+#elif defined(__SSE2__)
+
+    __m128i wa = _mm_set1_epi16(RGB565_FADE_STEPS - alpha);
+    __m128i wb = _mm_set1_epi16(alpha);
+    __m128i mask5 = _mm_set1_epi16(0x1F);
+    __m128i mask6 = _mm_set1_epi16(0x3F);
+    __m128i round = _mm_set1_epi16(RGB565_FADE_STEPS / 2);
+
+    for ( ; (i + 8) <= length ; i += 8)
+    {
+        __m128i pa = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i pb = _mm_loadu_si128((const __m128i *)(b + i));
+
+        __m128i red =
+            _mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(pa, 11), wa),
+                          _mm_mullo_epi16(_mm_srli_epi16(pb, 11), wb));
+
+        __m128i green =
+            _mm_add_epi16(
+                _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(pa, 5), mask6),
+                                wa),
+                _mm_mullo_epi16(_mm_and_si128(_mm_srli_epi16(pb, 5), mask6),
+                                wb));
+
+        __m128i blue =
+            _mm_add_epi16(_mm_mullo_epi16(_mm_and_si128(pa, mask5), wa),
+                          _mm_mullo_epi16(_mm_and_si128(pb, mask5), wb));
+
+        red = _mm_srli_epi16(_mm_add_epi16(red, round),
+                             RGB565_FADE_BITS);
+        green = _mm_srli_epi16(_mm_add_epi16(green, round),
+                               RGB565_FADE_BITS);
+        blue = _mm_srli_epi16(_mm_add_epi16(blue, round),
+                              RGB565_FADE_BITS);
+
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_or_si128(_mm_slli_epi16(red, 11),
+                                      _mm_or_si128(_mm_slli_epi16(green, 5),
+                                                   blue)));
+    }
+
+#endif
+
+    for ( ; i < length ; i++)
+    {
+        uint32_t blended = (spreadRGB565(a[i])
+                            * (RGB565_FADE_STEPS - alpha))
+                         + (spreadRGB565(b[i]) * alpha)
+                         + RGB565_SPREAD_ROUND;
+
+        dst[i] = packSpreadRGB565(blended >> RGB565_FADE_BITS);
+    }
+}
+
 //-------------------------------------------------------------------------
 
 bool initImage(
@@ -181,6 +433,7 @@ bool initImage(
     image->width = width;
     image->height = height;
     image->size = width * height * sizeof(uint16_t);
+    image->byteOrder = IMAGE_BYTE_ORDER_NATIVE;
 
     image->buffer = calloc(1, image->size);
 
@@ -190,7 +443,176 @@ bool initImage(
         exit(EXIT_FAILURE);
     }
 
+    // A new image has never been sent anywhere, so all of it is damaged.
+
+    resetImageDamage(image);
+    damageImage(image, 0, 0, width, height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+setImageByteOrder(
+    IMAGE_T *image,
+    IMAGE_BYTE_ORDER_T byteOrder)
+{
+    if (image->byteOrder != byteOrder)
+    {
+        htonsRGB565(image->buffer,
+                    image->buffer,
+                    image->width * image->height);
+
+        image->byteOrder = byteOrder;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+isImageBigEndian(
+    const IMAGE_T *image)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
     return true;
+#else
+    return image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN;
+#endif
+}
+
+//-------------------------------------------------------------------------
+
+void
+damageImage(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height)
+{
+    int16_t xMax = x + width - 1;
+    int16_t yMax = y + height - 1;
+
+    if (x < 0)
+    {
+        x = 0;
+    }
+
+    if (y < 0)
+    {
+        y = 0;
+    }
+
+    if (xMax >= image->width)
+    {
+        xMax = image->width - 1;
+    }
+
+    if (yMax >= image->height)
+    {
+        yMax = image->height - 1;
+    }
+
+    if ((x > xMax) || (y > yMax))
+    {
+        return;
+    }
+
+    IMAGE_DAMAGE_T *damage = &(image->damage);
+
+    if (damage->xMin > damage->xMax)
+    {
+        damage->xMin = x;
+        damage->yMin = y;
+        damage->xMax = xMax;
+        damage->yMax = yMax;
+    }
+    else
+    {
+        if (x < damage->xMin)
+        {
+            damage->xMin = x;
+        }
+
+        if (y < damage->yMin)
+        {
+            damage->yMin = y;
+        }
+
+        if (xMax > damage->xMax)
+        {
+            damage->xMax = xMax;
+        }
+
+        if (yMax > damage->yMax)
+        {
+            damage->yMax = yMax;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Called for every pixel set, so (x, y) is known to be inside the image.
+//
+
+static inline void
+damagePixel(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y)
+{
+    IMAGE_DAMAGE_T *damage = &(image->damage);
+
+    if (damage->xMin > damage->xMax)
+    {
+        damage->xMin = x;
+        damage->yMin = y;
+        damage->xMax = x;
+        damage->yMax = y;
+
+        return;
+    }
+
+    if (x < damage->xMin)
+    {
+        damage->xMin = x;
+    }
+    else if (x > damage->xMax)
+    {
+        damage->xMax = x;
+    }
+
+    if (y < damage->yMin)
+    {
+        damage->yMin = y;
+    }
+    else if (y > damage->yMax)
+    {
+        damage->yMax = y;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+resetImageDamage(
+    IMAGE_T *image)
+{
+    image->damage.xMin = 0;
+    image->damage.yMin = 0;
+    image->damage.xMax = -1;
+    image->damage.yMax = -1;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+isImageDamaged(
+    const IMAGE_T *image)
+{
+    return image->damage.xMin <= image->damage.xMax;
 }
 
 //-------------------------------------------------------------------------
@@ -200,14 +622,13 @@ clearImageRGB565(
     IMAGE_T *image,
     uint16_t rgb)
 {
-    int length = image->width * image->height;
-    uint16_t *buffer = image->buffer;
-
-    int i = 0;
-    for (i = 0 ; i < length ; i++)
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
     {
-        *buffer++ = rgb;
+        rgb = htons(rgb);
     }
+
+    fillRGB565(image->buffer, rgb, image->width * image->height);
+    damageImage(image, 0, 0, image->width, image->height);
 }
 
 //-------------------------------------------------------------------------
@@ -220,6 +641,7 @@ clearImageRGB(
     if (image->clearImage != NULL)
     {
         image->clearImage(image, rgb);
+        damageImage(image, 0, 0, image->width, image->height);
     }
 }
 
@@ -232,14 +654,12 @@ clearImageDirect(
 {
     uint16_t pixel = packRGB565(rgb->red, rgb->green, rgb->blue);
 
-    int length = image->width * image->height;
-    uint16_t *buffer = image->buffer;
-
-    int i = 0;
-    for (i = 0 ; i < length ; i++)
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
     {
-        *buffer++ = pixel;
+        pixel = htons(pixel);
     }
+
+    fillRGB565(image->buffer, pixel, image->width * image->height);
 }
 
 //-------------------------------------------------------------------------
@@ -276,7 +696,14 @@ setPixelRGB565(
         (y >= 0) && (y < image->height))
     {
         result = true;
+
+        if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+        {
+            rgb = htons(rgb);
+        }
+
         image->buffer[x + (y * image->width)] = rgb;
+        damagePixel(image, x, y);
     }
 
     return result;
@@ -299,11 +726,49 @@ setPixelRGB(
     {
         result = true;
         image->setPixel(image, x, y, rgb);
+        damagePixel(image, x, y);
     }
 
     return result;
 }
 
+//-------------------------------------------------------------------------
+//
+// No damage is recorded, so that bands of rows can be converted by
+// different threads at the same time.
+//
+
+void
+convertRowsRGB(
+    IMAGE_T *image,
+    const uint8_t *pixels,
+    int32_t pitch,
+    int16_t bytesPerPixel,
+    const RGB8_T *background,
+    int16_t start,
+    int16_t end)
+{
+    int16_t j;
+    for (j = start ; j < end ; j++)
+    {
+        const uint8_t *pixel = pixels + (j * pitch);
+
+        int16_t i;
+        for (i = 0 ; i < image->width ; i++)
+        {
+            RGB8_T rgb = { pixel[0], pixel[1], pixel[2] };
+
+            if (bytesPerPixel == 4)
+            {
+                blendRGB(pixel[3], &rgb, background, &rgb);
+            }
+
+            image->setPixel(image, i, j, &rgb);
+            pixel += bytesPerPixel;
+        }
+    }
+}
+
 //-------------------------------------------------------------------------
 
 bool
@@ -320,6 +785,11 @@ getPixelRGB565(
     {
         result = true;
         *rgb = image->buffer[x + (y * image->width)];
+
+        if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+        {
+            *rgb = ntohs(*rgb);
+        }
     }
 
     return result;
@@ -346,6 +816,183 @@ getPixelRGB(
     return result;
 }
 
+//-------------------------------------------------------------------------
+//
+// Clip the source rectangle (sx, sy, width, height) against both the
+// source and destination images, moving the destination position (dx, dy)
+// to match. Returns false if there is nothing left to copy.
+//
+
+static bool
+clipBlit(
+    const IMAGE_T *dst,
+    int16_t *dx,
+    int16_t *dy,
+    const IMAGE_T *src,
+    int16_t *sx,
+    int16_t *sy,
+    int16_t *width,
+    int16_t *height)
+{
+    if (*sx < 0)
+    {
+        *width += *sx;
+        *dx -= *sx;
+        *sx = 0;
+    }
+
+    if (*sy < 0)
+    {
+        *height += *sy;
+        *dy -= *sy;
+        *sy = 0;
+    }
+
+    if (*dx < 0)
+    {
+        *width += *dx;
+        *sx -= *dx;
+        *dx = 0;
+    }
+
+    if (*dy < 0)
+    {
+        *height += *dy;
+        *sy -= *dy;
+        *dy = 0;
+    }
+
+    if ((*sx + *width) > src->width)
+    {
+        *width = src->width - *sx;
+    }
+
+    if ((*sy + *height) > src->height)
+    {
+        *height = src->height - *sy;
+    }
+
+    if ((*dx + *width) > dst->width)
+    {
+        *width = dst->width - *dx;
+    }
+
+    if ((*dy + *height) > dst->height)
+    {
+        *height = dst->height - *dy;
+    }
+
+    return (*width > 0) && (*height > 0);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+blitImage(
+    IMAGE_T *dst,
+    int16_t dx,
+    int16_t dy,
+    const IMAGE_T *src,
+    int16_t sx,
+    int16_t sy,
+    int16_t width,
+    int16_t height)
+{
+    if (clipBlit(dst, &dx, &dy, src, &sx, &sy, &width, &height) == false)
+    {
+        return false;
+    }
+
+    bool swap = (dst->byteOrder != src->byteOrder);
+
+    // An image blitted onto itself, lower down, is copied from the bottom
+    // row up so that no source row is overwritten before it is read.
+
+    bool bottomUp = (src == dst) && (dy > sy);
+
+    int16_t n;
+    for (n = 0 ; n < height ; n++)
+    {
+        int16_t j = (bottomUp) ? (height - 1 - n) : n;
+
+        uint16_t *to = dst->buffer + dx + ((dy + j) * dst->width);
+        const uint16_t *from = src->buffer + sx + ((sy + j) * src->width);
+
+        if (swap)
+        {
+            htonsRGB565(to, from, width);
+        }
+        else
+        {
+            memmove(to, from, width * sizeof(uint16_t));
+        }
+    }
+
+    damageImage(dst, dx, dy, width, height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+blitImageColourKey(
+    IMAGE_T *dst,
+    int16_t dx,
+    int16_t dy,
+    const IMAGE_T *src,
+    int16_t sx,
+    int16_t sy,
+    int16_t width,
+    int16_t height,
+    uint16_t key)
+{
+    if (clipBlit(dst, &dx, &dy, src, &sx, &sy, &width, &height) == false)
+    {
+        return false;
+    }
+
+    bool swap = (dst->byteOrder != src->byteOrder);
+
+    if (src->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+    {
+        key = htons(key);
+    }
+
+    // As for blitImage, but the pixels of a row are copied one at a time,
+    // so an overlapping blit to the right on the same rows goes from
+    // right to left.
+
+    bool bottomUp = (src == dst) && (dy > sy);
+    bool rightToLeft = (src == dst) && (dy == sy) && (dx > sx);
+
+    int16_t n;
+    for (n = 0 ; n < height ; n++)
+    {
+        int16_t j = (bottomUp) ? (height - 1 - n) : n;
+
+        uint16_t *to = dst->buffer + dx + ((dy + j) * dst->width);
+        const uint16_t *from = src->buffer + sx + ((sy + j) * src->width);
+
+        int16_t m;
+        for (m = 0 ; m < width ; m++)
+        {
+            int16_t i = (rightToLeft) ? (width - 1 - m) : m;
+
+            uint16_t pixel = from[i];
+
+            if (pixel != key)
+            {
+                to[i] = (swap) ? (pixel << 8) | (pixel >> 8) : pixel;
+            }
+        }
+    }
+
+    damageImage(dst, dx, dy, width, height);
+
+    return true;
+}
+
 //-------------------------------------------------------------------------
 
 void
@@ -360,8 +1007,11 @@ destroyImage(
     image->width = 0;
     image->height = 0;
     image->size = 0;
+    image->byteOrder = IMAGE_BYTE_ORDER_NATIVE;
     image->buffer = NULL;
     image->setPixel = NULL;
+
+    resetImageDamage(image);
 }
 
 //-----------------------------------------------------------------------
@@ -373,9 +1023,14 @@ setPixelDirect(
     int16_t y,
     const RGB8_T *rgb)
 {
-    image->buffer[x + (y * image->width)] = packRGB565(rgb->red,
-                                                       rgb->green,
-                                                       rgb->blue);
+    uint16_t pixel = packRGB565(rgb->red, rgb->green, rgb->blue);
+
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+    {
+        pixel = htons(pixel);
+    }
+
+    image->buffer[x + (y * image->width)] = pixel;
 }
 
 //-----------------------------------------------------------------------
@@ -387,47 +1042,23 @@ setPixelDithered(
     int16_t y,
     const RGB8_T *rgb)
 {
-    static int16_t dither8[64] =
-    {
-        1, 6, 2, 7, 1, 6, 2, 7,
-        4, 2, 5, 4, 4, 3, 6, 4,
-        1, 7, 1, 6, 2, 7, 1, 7,
-        5, 3, 5, 3, 5, 4, 5, 3,
-        1, 6, 2, 7, 1, 6, 2, 7,
-        4, 3, 6, 4, 4, 2, 6, 4,
-        2, 7, 1, 7, 2, 7, 1, 6,
-        5, 3, 5, 3, 5, 3, 5, 3,
-    };
-
-    static int16_t dither4[64] =
-    {
-        1, 3, 1, 3, 1, 3, 1, 3,
-        2, 1, 3, 2, 2, 1, 3, 2,
-        1, 3, 1, 3, 1, 3, 1, 3,
-        2, 2, 2, 1, 3, 2, 2, 2,
-        1, 3, 1, 3, 1, 3, 1, 3,
-        2, 1, 3, 2, 2, 1, 3, 2,
-        1, 3, 1, 3, 1, 3, 1, 3,
-        3, 2, 2, 2, 2, 2, 2, 2,
-    };
-
     int16_t index = (x & 7) | ((y & 7) << 3);
 
-    int16_t r = rgb->red + dither8[index];
+    int16_t r = rgb->red + ditherRedBlueRGB565[index];
 
     if (r > 255)
     {
         r = 255;
     }
 
-    int16_t g = rgb->green + dither4[index];
+    int16_t g = rgb->green + ditherGreenRGB565[index];
 
     if (g > 255)
     {
         g = 255;
     }
 
-    int16_t b = rgb->blue + dither8[index];
+    int16_t b = rgb->blue + ditherRedBlueRGB565[index];
 
     if (b > 255)
     {
@@ -449,7 +1080,11 @@ getPixelDirect(
     RGB8_T *rgb)
 {
     uint16_t pixel = image->buffer[x + (y * image->width)];
-    pixel = ntohs(pixel);
+
+    if (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+    {
+        pixel = ntohs(pixel);
+    }
 
     uint8_t r5 = (pixel >> 11) & 0x1F;
     uint8_t g6 = (pixel >> 5) & 0x3F;
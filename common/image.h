@@ -45,6 +45,75 @@ typedef struct
 
 //-------------------------------------------------------------------------
 
+// Pixels are held in native byte order unless an image has been
+// explicitly converted to big-endian (the order the LCD expects), in
+// which case the pixel accessors convert on the way in and out.
+
+typedef enum
+{
+    IMAGE_BYTE_ORDER_NATIVE,
+    IMAGE_BYTE_ORDER_BIG_ENDIAN
+} IMAGE_BYTE_ORDER_T;
+
+//-------------------------------------------------------------------------
+
+// crossFadeRGB565 uses a 5 bit alpha, 0 gives the first row and
+// RGB565_FADE_STEPS gives the second.
+
+#define RGB565_FADE_BITS 5
+#define RGB565_FADE_STEPS (1 << RGB565_FADE_BITS)
+
+//-------------------------------------------------------------------------
+
+// An RGB565 pixel spread out into a 32 bit word (green in the top half)
+// leaves enough room between the fields to multiply all three by a 5 bit
+// alpha at once. RGB565_SPREAD_ROUND adds a half to each field before
+// shifting down by RGB565_FADE_BITS.
+
+#define RGB565_SPREAD_MASK 0x07E0F81F
+#define RGB565_SPREAD_ROUND 0x02008010
+
+static inline uint32_t
+spreadRGB565(
+    uint16_t pixel)
+{
+    return (pixel | ((uint32_t)pixel << 16)) & RGB565_SPREAD_MASK;
+}
+
+static inline uint16_t
+packSpreadRGB565(
+    uint32_t spread)
+{
+    spread &= RGB565_SPREAD_MASK;
+
+    return spread | (spread >> 16);
+}
+
+//-------------------------------------------------------------------------
+
+// The ordered dither added to each 8 bit field before it is truncated to
+// RGB565 (red and blue lose 3 bits, green loses 2). Both tables are
+// indexed by (x & 7) | ((y & 7) << 3).
+
+extern const uint8_t ditherRedBlueRGB565[64];
+extern const uint8_t ditherGreenRGB565[64];
+
+//-------------------------------------------------------------------------
+
+// The bounding box (inclusive) of every pixel written since the damage
+// was last reset, so that only that part of an image need be sent to the
+// LCD. An undamaged image has xMin greater than xMax.
+
+typedef struct
+{
+    int16_t xMin;
+    int16_t yMin;
+    int16_t xMax;
+    int16_t yMax;
+} IMAGE_DAMAGE_T;
+
+//-------------------------------------------------------------------------
+
 typedef struct IMAGE_T_ IMAGE_T;
 
 struct IMAGE_T_
@@ -52,6 +121,8 @@ struct IMAGE_T_
     int16_t width;
     int16_t height;
     int32_t size;
+    IMAGE_BYTE_ORDER_T byteOrder;
+    IMAGE_DAMAGE_T damage;
     uint16_t *buffer;
     void (*clearImage)(IMAGE_T*, const RGB8_T*);
     void (*setPixel)(IMAGE_T*, int16_t, int16_t, const RGB8_T*);
@@ -90,6 +161,26 @@ blendRGB(
     const RGB8_T *b,
     RGB8_T *result);
 
+void
+htonsRGB565(
+    uint16_t *dst,
+    const uint16_t *src,
+    int32_t length);
+
+void
+fillRGB565(
+    uint16_t *dst,
+    uint16_t rgb,
+    int32_t length);
+
+void
+crossFadeRGB565(
+    uint16_t *dst,
+    const uint16_t *a,
+    const uint16_t *b,
+    uint8_t alpha,
+    int32_t length);
+
 //-------------------------------------------------------------------------
 
 bool
@@ -99,6 +190,34 @@ initImage(
     int16_t height,
     bool dither);
 
+void
+setImageByteOrder(
+    IMAGE_T *image,
+    IMAGE_BYTE_ORDER_T byteOrder);
+
+bool
+isImageBigEndian(
+    const IMAGE_T *image);
+
+// Code that writes to image->buffer directly must call damageImage with
+// the area it has written. The rectangle is clipped to the image.
+
+void
+damageImage(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height);
+
+void
+resetImageDamage(
+    IMAGE_T *image);
+
+bool
+isImageDamaged(
+    const IMAGE_T *image);
+
 void
 clearImageRGB565(
     IMAGE_T *image,
@@ -123,6 +242,19 @@ setPixelRGB(
     int16_t y,
     const RGB8_T *rgb);
 
+// Convert rows start to end - 1 of 8 bit RGB (or RGBA blended over the
+// background) pixels to the image. The caller must damage the image.
+
+void
+convertRowsRGB(
+    IMAGE_T *image,
+    const uint8_t *pixels,
+    int32_t pitch,
+    int16_t bytesPerPixel,
+    const RGB8_T *background,
+    int16_t start,
+    int16_t end);
+
 bool
 getPixelRGB565(
     IMAGE_T *image,
@@ -137,6 +269,29 @@ getPixelRGB(
     int16_t y,
     RGB8_T *rgb);
 
+bool
+blitImage(
+    IMAGE_T *dst,
+    int16_t dx,
+    int16_t dy,
+    const IMAGE_T *src,
+    int16_t sx,
+    int16_t sy,
+    int16_t width,
+    int16_t height);
+
+bool
+blitImageColourKey(
+    IMAGE_T *dst,
+    int16_t dx,
+    int16_t dy,
+    const IMAGE_T *src,
+    int16_t sx,
+    int16_t sy,
+    int16_t width,
+    int16_t height,
+    uint16_t key);
+
 void
 destroyImage(
     IMAGE_T *image);
@@ -0,0 +1,273 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.h"
+#include "indexedImage.h"
+
+//-------------------------------------------------------------------------
+//
+// A palette lookup is a gather, which neither NEON nor SSE2 can do from a
+// 256 entry table of 16 bit values, so this is unrolled scalar code. The
+// palette (512 bytes) stays in L1 cache.
+//
+
+void
+expandIndexedRGB565(
+    uint16_t *dst,
+    const uint8_t *src,
+    const uint16_t *palette,
+    int32_t length)
+{
+    int32_t i = 0;
+
+    for ( ; (i + 4) <= length ; i += 4)
+    {
+        dst[i] = palette[src[i]];
+        dst[i + 1] = palette[src[i + 1]];
+        dst[i + 2] = palette[src[i + 2]];
+        dst[i + 3] = palette[src[i + 3]];
+    }
+
+    for ( ; i < length ; i++)
+    {
+        dst[i] = palette[src[i]];
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initIndexedImage(
+    INDEXED_IMAGE_T *image,
+    int16_t width,
+    int16_t height)
+{
+    image->width = width;
+    image->height = height;
+    image->size = width * height;
+
+    memset(image->palette, 0, sizeof(image->palette));
+
+    image->buffer = calloc(1, image->size);
+
+    if (image->buffer == NULL)
+    {
+        perror("indexedImage: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+setPaletteRGB565(
+    INDEXED_IMAGE_T *image,
+    uint8_t index,
+    uint16_t rgb)
+{
+    image->palette[index] = rgb;
+}
+
+//-------------------------------------------------------------------------
+
+void
+setPaletteRGB(
+    INDEXED_IMAGE_T *image,
+    uint8_t index,
+    const RGB8_T *rgb)
+{
+    image->palette[index] = packRGB565(rgb->red, rgb->green, rgb->blue);
+}
+
+//-------------------------------------------------------------------------
+
+uint16_t
+getPaletteRGB565(
+    const INDEXED_IMAGE_T *image,
+    uint8_t index)
+{
+    return image->palette[index];
+}
+
+//-------------------------------------------------------------------------
+
+void
+clearIndexedImage(
+    INDEXED_IMAGE_T *image,
+    uint8_t index)
+{
+    memset(image->buffer, index, image->size);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+setPixelIndexed(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    uint8_t index)
+{
+    bool result = false;
+
+    if ((x >= 0) && (x < image->width) && (y >= 0) && (y < image->height))
+    {
+        result = true;
+
+        image->buffer[x + (y * image->width)] = index;
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+getPixelIndexed(
+    const INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    uint8_t *index)
+{
+    bool result = false;
+
+    if ((x >= 0) && (x < image->width) && (y >= 0) && (y < image->height))
+    {
+        result = true;
+
+        *index = image->buffer[x + (y * image->width)];
+    }
+
+    return result;
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawHorizontalLineIndexed(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint8_t index)
+{
+    if ((y < 0) || (y >= image->height) || (length <= 0))
+    {
+        return;
+    }
+
+    int16_t x0 = (x < 0) ? 0 : x;
+    int16_t x1 = ((x + length) > image->width) ? image->width : x + length;
+
+    if (x1 > x0)
+    {
+        memset(image->buffer + x0 + (y * image->width), index, x1 - x0);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+drawVerticalLineIndexed(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint8_t index)
+{
+    if ((x < 0) || (x >= image->width) || (length <= 0))
+    {
+        return;
+    }
+
+    int16_t y0 = (y < 0) ? 0 : y;
+    int16_t y1 = ((y + length) > image->height) ? image->height : y + length;
+
+    uint8_t *pixel = image->buffer + x + (y0 * image->width);
+
+    int16_t j;
+    for (j = y0 ; j < y1 ; j++)
+    {
+        *pixel = index;
+        pixel += image->width;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+convertIndexedImage(
+    const INDEXED_IMAGE_T *src,
+    IMAGE_T *dst)
+{
+    if ((src->width != dst->width) || (src->height != dst->height))
+    {
+        return false;
+    }
+
+    expandIndexedRGB565(dst->buffer, src->buffer, src->palette, src->size);
+
+    if (isImageBigEndian(dst))
+    {
+        htonsRGB565(dst->buffer, dst->buffer, src->size);
+    }
+
+    damageImage(dst, 0, 0, dst->width, dst->height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyIndexedImage(
+    INDEXED_IMAGE_T *image)
+{
+    if (image->buffer)
+    {
+        free(image->buffer);
+    }
+
+    image->width = 0;
+    image->height = 0;
+    image->size = 0;
+    image->buffer = NULL;
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,141 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef INDEXED_IMAGE_H
+#define INDEXED_IMAGE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// An image of one byte palette indices. The palette holds RGB565 colours
+// in native byte order and is only applied when the image is expanded
+// (normally on the way to the LCD), so changing a palette entry recolours
+// every pixel using it without redrawing anything.
+//
+
+#define INDEXED_IMAGE_PALETTE_SIZE 256
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    int16_t width;
+    int16_t height;
+    int32_t size;
+    uint16_t palette[INDEXED_IMAGE_PALETTE_SIZE];
+    uint8_t *buffer;
+} INDEXED_IMAGE_T;
+
+//-------------------------------------------------------------------------
+
+void
+expandIndexedRGB565(
+    uint16_t *dst,
+    const uint8_t *src,
+    const uint16_t *palette,
+    int32_t length);
+
+//-------------------------------------------------------------------------
+
+bool
+initIndexedImage(
+    INDEXED_IMAGE_T *image,
+    int16_t width,
+    int16_t height);
+
+void
+setPaletteRGB565(
+    INDEXED_IMAGE_T *image,
+    uint8_t index,
+    uint16_t rgb);
+
+void
+setPaletteRGB(
+    INDEXED_IMAGE_T *image,
+    uint8_t index,
+    const RGB8_T *rgb);
+
+uint16_t
+getPaletteRGB565(
+    const INDEXED_IMAGE_T *image,
+    uint8_t index);
+
+void
+clearIndexedImage(
+    INDEXED_IMAGE_T *image,
+    uint8_t index);
+
+bool
+setPixelIndexed(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    uint8_t index);
+
+bool
+getPixelIndexed(
+    const INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    uint8_t *index);
+
+void
+drawHorizontalLineIndexed(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint8_t index);
+
+void
+drawVerticalLineIndexed(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    uint8_t index);
+
+bool
+convertIndexedImage(
+    const INDEXED_IMAGE_T *src,
+    IMAGE_T *dst);
+
+void
+destroyIndexedImage(
+    INDEXED_IMAGE_T *image);
+
+//-------------------------------------------------------------------------
+
+#endif
+
@@ -36,6 +36,7 @@
 #include <arpa/inet.h>
 
 #include "image.h"
+#include "indexedImage.h"
 #include "lcd.h"
 
 //-------------------------------------------------------------------------
@@ -44,6 +45,11 @@
 #define SPIRS RPI_GPIO_P1_22
 #define SPIRST RPI_GPIO_P1_16
 
+// Number of pixels converted to big-endian and sent to the LCD per SPI
+// transfer.
+
+#define LCD_TRANSFER_PIXELS 2048
+
 //-------------------------------------------------------------------------
 
 inline static void
@@ -90,6 +96,68 @@ writeData(
     bcm2835_spi_writenb((char*)&network_data, 2);
 }
 
+//-------------------------------------------------------------------------
+//
+// Pixels are held in native byte order, but the LCD expects them
+// big-endian. Convert them a block at a time into a transfer buffer,
+// leaving the caller's pixels untouched.
+//
+
+static void
+writePixels(
+    const uint16_t *pixels,
+    uint32_t length)
+{
+    uint16_t buffer[LCD_TRANSFER_PIXELS];
+
+    while (length > 0)
+    {
+        uint32_t count = length;
+
+        if (count > LCD_TRANSFER_PIXELS)
+        {
+            count = LCD_TRANSFER_PIXELS;
+        }
+
+        htonsRGB565(buffer, pixels, count);
+        bcm2835_spi_writenb((char*)buffer, count * sizeof(uint16_t));
+
+        pixels += count;
+        length -= count;
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Expand palette indices and send them to the LCD. The palette passed in
+// must already be big-endian.
+//
+
+static void
+writeIndexedPixels(
+    const uint8_t *pixels,
+    const uint16_t *palette,
+    uint32_t length)
+{
+    uint16_t buffer[LCD_TRANSFER_PIXELS];
+
+    while (length > 0)
+    {
+        uint32_t count = length;
+
+        if (count > LCD_TRANSFER_PIXELS)
+        {
+            count = LCD_TRANSFER_PIXELS;
+        }
+
+        expandIndexedRGB565(buffer, pixels, palette, count);
+        bcm2835_spi_writenb((char*)buffer, count * sizeof(uint16_t));
+
+        pixels += count;
+        length -= count;
+    }
+}
+
 //-------------------------------------------------------------------------
 
 uint16_t
@@ -561,57 +629,53 @@ setPixelLcd(
 }
 
 //-------------------------------------------------------------------------
+//
+// Send the part of an image from (xStart, yStart) to (xEnd, yEnd)
+// inclusive, with the image's top left corner at (x, y) on the LCD. The
+// region is clipped to the LCD.
+//
 
 static bool
-putImageLcdPartial(
+putImageRegionLcd(
     LCD_T *lcd,
     int16_t x,
     int16_t y,
-    IMAGE_T *image)
+    IMAGE_T *image,
+    int16_t xStart,
+    int16_t yStart,
+    int16_t xEnd,
+    int16_t yEnd)
 {
-    int16_t xStart = 0;
-    int16_t xEnd = image->width - 1;
-
-    int16_t yStart = 0;
-    int16_t yEnd = image->height - 1;
-
-    if (x < 0)
+    if ((x + xStart) < 0)
     {
         xStart = -x;
-        x = 0;
     }
 
-    if ((x - xStart + image->width) > lcd->width)
+    if ((x + xEnd) >= lcd->width)
     {
-        xEnd = lcd->width - 1 - (x - xStart);
+        xEnd = lcd->width - 1 - x;
     }
 
-    if (y < 0)
+    if ((y + yStart) < 0)
     {
         yStart = -y;
-        y = 0;
     }
 
-    if ((y - yStart + image->height) > lcd->height)
+    if ((y + yEnd) >= lcd->height)
     {
-        yEnd = lcd->height - 1 - (y - yStart);
+        yEnd = lcd->height - 1 - y;
     }
 
-    if ((xEnd - xStart) <= 0)
+    if ((xEnd < xStart) || (yEnd < yStart))
     {
         return false;
     }
 
-    if ((yEnd - yStart) <= 0)
-    {
-        return false;
-    }
+    writeCommand(lcd->xStart, x + xStart);
+    writeCommand(lcd->yStart, y + yStart);
 
-    writeCommand(lcd->xStart, x);
-    writeCommand(lcd->yStart, y);
-
-    writeCommand(lcd->xEnd, x + xEnd - xStart);
-    writeCommand(lcd->yEnd, y + yEnd - yStart);
+    writeCommand(lcd->xEnd, x + xEnd);
+    writeCommand(lcd->yEnd, y + yEnd);
     
     writeCommand(lcd->xPosition, 0x0000);
     writeCommand(lcd->yPosition, 0x0000);
@@ -621,13 +685,31 @@ putImageLcdPartial(
     bcm2835_gpio_clr(SPICS);
     bcm2835_gpio_set(SPIRS);
 
-    uint32_t rowSize = (xEnd - xStart + 1) * sizeof(uint16_t); 
+    uint32_t rowLength = xEnd - xStart + 1;
+    int16_t rows = yEnd - yStart + 1;
+    bool bigEndian = isImageBigEndian(image);
+
+    // Whole rows are contiguous, so send them in one go.
+
+    if (rowLength == image->width)
+    {
+        rowLength *= rows;
+        rows = 1;
+    }
 
     int16_t j;
-    for (j = yStart ; j <= yEnd ; j++)
+    for (j = yStart ; j < yStart + rows ; j++)
     {
         uint16_t *row = &(image->buffer[xStart + (j * image->width)]);
-        bcm2835_spi_writenb((char*)row, rowSize);
+
+        if (bigEndian)
+        {
+            bcm2835_spi_writenb((char*)row, rowLength * sizeof(uint16_t));
+        }
+        else
+        {
+            writePixels(row, rowLength);
+        }
     }
 
     bcm2835_gpio_set(SPICS);
@@ -644,14 +726,19 @@ putImageLcd(
     int16_t y,
     IMAGE_T *image)
 {
-    if ((x < 0) || ((x + image->width) > lcd->width))
-    {
-        return putImageLcdPartial(lcd, x, y, image);
-    }
+    resetImageDamage(image);
 
-    if ((y < 0) || ((y + image->height) > lcd->height))
+    if ((x < 0) || ((x + image->width) > lcd->width) ||
+        (y < 0) || ((y + image->height) > lcd->height))
     {
-        return putImageLcdPartial(lcd, x, y, image);
+        return putImageRegionLcd(lcd,
+                                 x,
+                                 y,
+                                 image,
+                                 0,
+                                 0,
+                                 image->width - 1,
+                                 image->height - 1);
     }
 
     writeCommand(lcd->xStart, x);
@@ -668,7 +755,14 @@ putImageLcd(
     bcm2835_gpio_clr(SPICS);
     bcm2835_gpio_set(SPIRS);
 
-    bcm2835_spi_writenb((char*)image->buffer, image->size);
+    if (isImageBigEndian(image))
+    {
+        bcm2835_spi_writenb((char*)image->buffer, image->size);
+    }
+    else
+    {
+        writePixels(image->buffer, image->width * image->height);
+    }
 
     bcm2835_gpio_set(SPICS);
 
@@ -676,16 +770,180 @@ putImageLcd(
 }
 
 //-------------------------------------------------------------------------
+//
+// Send only the part of the image drawn on since it was last sent, then
+// reset its damage. Returns false if there was nothing to send.
+//
 
 bool
-putRGB565Lcd(
+putImageLcdDamaged(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    IMAGE_T *image)
+{
+    if (isImageDamaged(image) == false)
+    {
+        return false;
+    }
+
+    IMAGE_DAMAGE_T damage = image->damage;
+
+    if ((damage.xMin == 0) &&
+        (damage.yMin == 0) &&
+        (damage.xMax == image->width - 1) &&
+        (damage.yMax == image->height - 1))
+    {
+        return putImageLcd(lcd, x, y, image);
+    }
+
+    resetImageDamage(image);
+
+    return putImageRegionLcd(lcd,
+                             x,
+                             y,
+                             image,
+                             damage.xMin,
+                             damage.yMin,
+                             damage.xMax,
+                             damage.yMax);
+}
+
+//-------------------------------------------------------------------------
+//
+// Send part of an image, as it would appear if the whole image were put
+// at (x, y). The image's damage is left alone.
+//
+
+bool
+putImagePartLcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    IMAGE_T *image,
+    const IMAGE_DAMAGE_T *part)
+{
+    int16_t xStart = (part->xMin < 0) ? 0 : part->xMin;
+    int16_t yStart = (part->yMin < 0) ? 0 : part->yMin;
+    int16_t xEnd = part->xMax;
+    int16_t yEnd = part->yMax;
+
+    if (xEnd >= image->width)
+    {
+        xEnd = image->width - 1;
+    }
+
+    if (yEnd >= image->height)
+    {
+        yEnd = image->height - 1;
+    }
+
+    return putImageRegionLcd(lcd, x, y, image, xStart, yStart, xEnd, yEnd);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+putIndexedImageLcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    const INDEXED_IMAGE_T *image)
+{
+    int16_t xStart = 0;
+    int16_t xEnd = image->width - 1;
+
+    int16_t yStart = 0;
+    int16_t yEnd = image->height - 1;
+
+    if (x < 0)
+    {
+        xStart = -x;
+        x = 0;
+    }
+
+    if ((x - xStart + image->width) > lcd->width)
+    {
+        xEnd = lcd->width - 1 - (x - xStart);
+    }
+
+    if (y < 0)
+    {
+        yStart = -y;
+        y = 0;
+    }
+
+    if ((y - yStart + image->height) > lcd->height)
+    {
+        yEnd = lcd->height - 1 - (y - yStart);
+    }
+
+    if ((xEnd < xStart) || (yEnd < yStart))
+    {
+        return false;
+    }
+
+    // The palette is converted to the LCD byte order once, so expanding
+    // the pixels is a plain table lookup.
+
+    uint16_t palette[INDEXED_IMAGE_PALETTE_SIZE];
+    htonsRGB565(palette, image->palette, INDEXED_IMAGE_PALETTE_SIZE);
+
+    writeCommand(lcd->xStart, x);
+    writeCommand(lcd->yStart, y);
+
+    writeCommand(lcd->xEnd, x + xEnd - xStart);
+    writeCommand(lcd->yEnd, y + yEnd - yStart);
+
+    writeCommand(lcd->xPosition, 0x0000);
+    writeCommand(lcd->yPosition, 0x0000);
+
+    writeRegister(0x0202);
+
+    bcm2835_gpio_clr(SPICS);
+    bcm2835_gpio_set(SPIRS);
+
+    uint32_t rowLength = xEnd - xStart + 1;
+
+    if (rowLength == image->width)
+    {
+        writeIndexedPixels(image->buffer + (yStart * image->width),
+                           palette,
+                           rowLength * (yEnd - yStart + 1));
+    }
+    else
+    {
+        int16_t j;
+        for (j = yStart ; j <= yEnd ; j++)
+        {
+            writeIndexedPixels(image->buffer + xStart + (j * image->width),
+                               palette,
+                               rowLength);
+        }
+    }
+
+    bcm2835_gpio_set(SPICS);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// Send width by height pixels, rows pitch bytes apart, clipped to the LCD.
+// Big-endian pixels are already in the order the LCD expects, so they are
+// sent as they are.
+//
+
+static bool
+putPixelsLcd(
     LCD_T *lcd,
     int16_t x,
     int16_t y,
     int16_t width,
     int16_t height,
     int16_t pitch,
-    void *data)
+    void *data,
+    bool bigEndian)
 {
     int16_t xStart = 0;
     int16_t xEnd = width - 1;
@@ -715,12 +973,7 @@ putRGB565Lcd(
         yEnd = lcd->height - 1 - (y - yStart);
     }
 
-    if ((xEnd - xStart) <= 0)
-    {
-        return false;
-    }
-
-    if ((yEnd - yStart) <= 0)
+    if ((xEnd < xStart) || (yEnd < yStart))
     {
         return false;
     }
@@ -746,13 +999,14 @@ putRGB565Lcd(
     {
         uint16_t *row = data + (xStart * 2) + (j * pitch);
 
-        int16_t i = 0;
-        for (i = 0 ; i < rowLength ; i++)
+        if (bigEndian)
         {
-            row[i] = htons(row[i]);
+            bcm2835_spi_writenb((char*)row, rowLength * sizeof(uint16_t));
+        }
+        else
+        {
+            writePixels(row, rowLength);
         }
-
-        bcm2835_spi_writenb((char*)row, rowLength * 2);
     }
 
     bcm2835_gpio_set(SPICS);
@@ -762,6 +1016,69 @@ putRGB565Lcd(
 
 //-------------------------------------------------------------------------
 
+bool
+putRGB565Lcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    int16_t pitch,
+    void *data)
+{
+    return putPixelsLcd(lcd, x, y, width, height, pitch, data, false);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+putBigEndianRGB565Lcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    int16_t pitch,
+    void *data)
+{
+    return putPixelsLcd(lcd, x, y, width, height, pitch, data, true);
+}
+
+//-------------------------------------------------------------------------
+//
+// Scroll the whole display up by offset lines using the controller's
+// base image scroll (registers 0x0401 and 0x0404), the lines scrolled off
+// the top reappearing at the bottom. What is drawn at y afterwards lands
+// on line (y - offset) of the display. The scroll runs along the gate
+// lines, which only run down the display in the default portrait
+// orientation, so other orientations return false.
+//
+
+bool
+scrollLcd(
+    LCD_T *lcd,
+    int16_t offset)
+{
+    if (lcd->rotate != 0)
+    {
+        return false;
+    }
+
+    offset %= lcd->height;
+
+    if (offset < 0)
+    {
+        offset += lcd->height;
+    }
+
+    writeCommand(0x0404, offset);
+    writeCommand(0x0401, (offset == 0) ? 0x0000 : 0x0002);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
 void
 backlightLcd(
     uint32_t value)
@@ -35,6 +35,7 @@
 #include <stdio.h>
 
 #include "image.h"
+#include "indexedImage.h"
 
 //-------------------------------------------------------------------------
 
@@ -96,6 +97,28 @@ putImageLcd(
     int16_t y,
     IMAGE_T *image);
 
+bool
+putImageLcdDamaged(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    IMAGE_T *image);
+
+bool
+putImagePartLcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    IMAGE_T *image,
+    const IMAGE_DAMAGE_T *part);
+
+bool
+putIndexedImageLcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    const INDEXED_IMAGE_T *image);
+
 bool
 putRGB565Lcd(
     LCD_T *lcd,
@@ -106,6 +129,24 @@ putRGB565Lcd(
     int16_t pitch,
     void *data);
 
+// As putRGB565Lcd, but the pixels are already big-endian (see
+// pixelPipeline.h), so they are sent without being byte swapped.
+
+bool
+putBigEndianRGB565Lcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    int16_t pitch,
+    void *data);
+
+bool
+scrollLcd(
+    LCD_T *lcd,
+    int16_t offset);
+
 void
 backlightLcd(
     uint32_t value);
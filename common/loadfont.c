@@ -0,0 +1,1061 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "font.h"
+#include "glyphStore.h"
+#include "loadfont.h"
+
+//-------------------------------------------------------------------------
+
+#define PSF1_MAGIC0 0x36
+#define PSF1_MAGIC1 0x04
+#define PSF1_MODE512 0x01
+#define PSF1_MODEHASTAB 0x02
+#define PSF1_MODEHASSEQ 0x04
+#define PSF1_HEADER_SIZE 4
+#define PSF1_SEPARATOR 0xFFFF
+#define PSF1_START_SEQUENCE 0xFFFE
+
+#define PSF2_MAGIC 0x864AB572
+#define PSF2_HAS_UNICODE_TABLE 0x01
+#define PSF2_HEADER_SIZE 32
+#define PSF2_SEPARATOR 0xFF
+#define PSF2_START_SEQUENCE 0xFE
+
+//-------------------------------------------------------------------------
+//
+// A font opened by openFont. The glyph store comes first, so that
+// font->store can be taken as a GLYPH_STORE_T.
+//
+
+typedef struct
+{
+    GLYPH_STORE_T glyphs;
+    bool bdf;
+    int boxX;
+    int ascent;
+} FONT_STORE_T;
+
+//-------------------------------------------------------------------------
+
+static uint32_t
+readLittleEndian32(
+    const uint8_t *bytes)
+{
+    return bytes[0] |
+           (bytes[1] << 8) |
+           (bytes[2] << 16) |
+           ((uint32_t)bytes[3] << 24);
+}
+
+//-------------------------------------------------------------------------
+//
+// Every font cleared for loading is given a new id. Id 0 is the built in
+// font's.
+//
+
+static uint32_t lastFontId = 0;
+
+static void
+clearFont(
+    FONT_T *font)
+{
+    if (++lastFontId == 0)
+    {
+        lastFontId = 1;
+    }
+
+    font->id = lastFontId;
+    font->width = 0;
+    font->height = 0;
+    font->bitsPerPixel = 1;
+    font->bytesPerRow = 0;
+    font->bytesPerGlyph = 0;
+    font->glyphs = 0;
+    font->bitmaps = NULL;
+    font->map = NULL;
+    font->mapLength = 0;
+    font->buffer = NULL;
+    font->findGlyph = NULL;
+    font->loadGlyph = NULL;
+    font->store = NULL;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+loadPsfFont(
+    const char *file,
+    FONT_T *font)
+{
+    clearFont(font);
+
+    int fd = open(file, O_RDONLY);
+
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if ((fstat(fd, &st) == -1) || (st.st_size < PSF1_HEADER_SIZE))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+
+    const uint8_t *bytes = map;
+    size_t size = st.st_size;
+    uint32_t headerSize = 0;
+
+    if ((bytes[0] == PSF1_MAGIC0) && (bytes[1] == PSF1_MAGIC1))
+    {
+        headerSize = PSF1_HEADER_SIZE;
+
+        font->width = 8;
+        font->height = bytes[3];
+        font->bytesPerGlyph = bytes[3];
+        font->glyphs = (bytes[2] & PSF1_MODE512) ? 512 : 256;
+    }
+    else if ((size >= PSF2_HEADER_SIZE) &&
+             (readLittleEndian32(bytes) == PSF2_MAGIC))
+    {
+        uint32_t glyphs = readLittleEndian32(bytes + 16);
+        uint32_t bytesPerGlyph = readLittleEndian32(bytes + 20);
+        uint32_t height = readLittleEndian32(bytes + 24);
+        uint32_t width = readLittleEndian32(bytes + 28);
+
+        // Sizes that do not fit the FONT_T fields are left as zero, which
+        // fails the checks below.
+
+        if ((glyphs <= INT32_MAX) &&
+            (bytesPerGlyph <= INT32_MAX) &&
+            (height <= INT16_MAX) &&
+            (width <= INT16_MAX))
+        {
+            headerSize = readLittleEndian32(bytes + 8);
+
+            font->glyphs = glyphs;
+            font->bytesPerGlyph = bytesPerGlyph;
+            font->height = height;
+            font->width = width;
+        }
+    }
+
+    font->bytesPerRow = (font->width + 7) / 8;
+
+    // The glyphs must all be in the file, and each must hold at least
+    // height rows. The glyph count is checked by dividing, as multiplying
+    // it by bytesPerGlyph can wrap a 32 bit size_t.
+
+    if ((headerSize == 0) ||
+        (headerSize > size) ||
+        (font->glyphs <= 0) ||
+        (font->width <= 0) ||
+        (font->height <= 0) ||
+        (font->bytesPerGlyph <= 0) ||
+        (font->bytesPerGlyph < (font->bytesPerRow * font->height)) ||
+        ((size_t)font->glyphs > (size - headerSize) / font->bytesPerGlyph))
+    {
+        munmap(map, size);
+        clearFont(font);
+        return false;
+    }
+
+    font->bitmaps = bytes + headerSize;
+    font->map = map;
+    font->mapLength = size;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static int
+hexDigit(
+    char c)
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return c - '0';
+    }
+
+    if ((c >= 'A') && (c <= 'F'))
+    {
+        return c - 'A' + 10;
+    }
+
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return c - 'a' + 10;
+    }
+
+    return -1;
+}
+
+//-------------------------------------------------------------------------
+//
+// Place one row of a BDF glyph bitmap into its cell. column is where the
+// first bit of the row falls in the cell.
+//
+
+static void
+setBdfRow(
+    const FONT_T *font,
+    uint8_t *cell,
+    int row,
+    int column,
+    int width,
+    const char *hex)
+{
+    if ((row < 0) || (row >= font->height))
+    {
+        return;
+    }
+
+    uint8_t *bits = cell + (row * font->bytesPerRow);
+
+    int i;
+    for (i = 0 ; i < width ; i++)
+    {
+        int digit = hexDigit(hex[i / 4]);
+
+        if (digit == -1)
+        {
+            return;
+        }
+
+        int x = column + i;
+
+        if (((digit >> (3 - (i % 4))) & 1) && (x >= 0) && (x < font->width))
+        {
+            bits[x / 8] |= 0x80 >> (x % 8);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+loadBdfFont(
+    const char *file,
+    FONT_T *font)
+{
+    clearFont(font);
+
+    FILE *fp = fopen(file, "r");
+
+    if (fp == NULL)
+    {
+        return false;
+    }
+
+    char line[256];
+
+    int boxWidth = 0;
+    int boxHeight = 0;
+    int boxX = 0;
+    int boxY = 0;
+
+    while ((font->buffer == NULL) && fgets(line, sizeof(line), fp))
+    {
+        if (sscanf(line,
+                   "FONTBOUNDINGBOX %d %d %d %d",
+                   &boxWidth,
+                   &boxHeight,
+                   &boxX,
+                   &boxY) == 4)
+        {
+            if ((boxWidth <= 0) || (boxHeight <= 0))
+            {
+                break;
+            }
+
+            font->width = boxWidth;
+            font->height = boxHeight;
+            font->bytesPerRow = (boxWidth + 7) / 8;
+            font->bytesPerGlyph = font->bytesPerRow * boxHeight;
+            font->glyphs = 256;
+
+            font->buffer = calloc(font->glyphs, font->bytesPerGlyph);
+
+            if (font->buffer == NULL)
+            {
+                perror("loadfont: memory exhausted\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    if (font->buffer == NULL)
+    {
+        fclose(fp);
+        clearFont(font);
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+
+    // Rows of the glyph's bounding box are placed relative to the font's
+    // baseline, which is boxY from the bottom of the cell.
+
+    int ascent = boxHeight + boxY;
+
+    int encoding = -1;
+    int width = 0;
+    int height = 0;
+    int xOffset = 0;
+    int yOffset = 0;
+    int row = -1;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (row >= 0)
+        {
+            if (strncmp(line, "ENDCHAR", 7) == 0)
+            {
+                row = -1;
+                encoding = -1;
+            }
+            else if ((encoding >= 0) && (encoding < font->glyphs))
+            {
+                setBdfRow(font,
+                          font->buffer + (encoding * font->bytesPerGlyph),
+                          ascent - (yOffset + height) + row,
+                          xOffset - boxX,
+                          width,
+                          line);
+                ++row;
+            }
+        }
+        else if (sscanf(line, "ENCODING %d", &encoding) == 1)
+        {
+            continue;
+        }
+        else if (sscanf(line,
+                        "BBX %d %d %d %d",
+                        &width,
+                        &height,
+                        &xOffset,
+                        &yOffset) == 4)
+        {
+            continue;
+        }
+        else if (strncmp(line, "BITMAP", 6) == 0)
+        {
+            row = 0;
+        }
+    }
+
+    fclose(fp);
+
+    font->bitmaps = font->buffer;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+loadFont(
+    const char *file,
+    FONT_T *font)
+{
+    if (loadPsfFont(file, font))
+    {
+        return true;
+    }
+
+    return loadBdfFont(file, font);
+}
+
+//-------------------------------------------------------------------------
+//
+// Copy the line starting at text into line (truncating it to fit) and
+// return the start of the next line.
+//
+
+static const char *
+nextLine(
+    const char *text,
+    const char *end,
+    char *line,
+    size_t size)
+{
+    size_t length = 0;
+
+    while ((text < end) && (*text != '\n'))
+    {
+        if (length < size - 1)
+        {
+            line[length++] = *text;
+        }
+
+        ++text;
+    }
+
+    line[length] = '\0';
+
+    return (text < end) ? text + 1 : end;
+}
+
+//-------------------------------------------------------------------------
+//
+// Read the Unicode table of a PSF font, returning the number of code
+// points it gives glyphs for. If index is not NULL, each is recorded
+// there with the offset of its glyph. Sequences of code points (for
+// combined characters) are skipped.
+//
+
+static int32_t
+readPsfUnicodeTable(
+    const uint8_t *table,
+    const uint8_t *end,
+    bool psf2,
+    int32_t glyphs,
+    uint32_t glyphOffset,
+    int32_t bytesPerGlyph,
+    GLYPH_STORE_INDEX_T *index)
+{
+    int32_t count = 0;
+    int32_t glyph = 0;
+    bool sequence = false;
+
+    while ((table < end) && (glyph < glyphs))
+    {
+        uint32_t codePoint = 0;
+        bool separator = false;
+        bool startSequence = false;
+
+        if (psf2)
+        {
+            separator = (*table == PSF2_SEPARATOR);
+            startSequence = (*table == PSF2_START_SEQUENCE);
+
+            // UTF-8, but without checking it is the shortest form.
+
+            int length = 1;
+
+            if ((*table & 0xE0) == 0xC0)
+            {
+                codePoint = *table & 0x1F;
+                length = 2;
+            }
+            else if ((*table & 0xF0) == 0xE0)
+            {
+                codePoint = *table & 0x0F;
+                length = 3;
+            }
+            else if ((*table & 0xF8) == 0xF0)
+            {
+                codePoint = *table & 0x07;
+                length = 4;
+            }
+            else
+            {
+                codePoint = *table;
+            }
+
+            if ((table + length) > end)
+            {
+                break;
+            }
+
+            int i;
+            for (i = 1 ; i < length ; i++)
+            {
+                codePoint = (codePoint << 6) | (table[i] & 0x3F);
+            }
+
+            table += length;
+        }
+        else
+        {
+            if ((table + 2) > end)
+            {
+                break;
+            }
+
+            codePoint = table[0] | (table[1] << 8);
+            separator = (codePoint == PSF1_SEPARATOR);
+            startSequence = (codePoint == PSF1_START_SEQUENCE);
+
+            table += 2;
+        }
+
+        if (separator)
+        {
+            ++glyph;
+            sequence = false;
+        }
+        else if (startSequence)
+        {
+            sequence = true;
+        }
+        else if (sequence == false)
+        {
+            if (index != NULL)
+            {
+                index[count].codePoint = codePoint;
+                index[count].offset = glyphOffset + (glyph * bytesPerGlyph);
+            }
+
+            ++count;
+        }
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+openPsfFont(
+    const char *file,
+    int32_t size,
+    FONT_T *font)
+{
+    if (loadPsfFont(file, font) == false)
+    {
+        return false;
+    }
+
+    const uint8_t *bytes = font->map;
+    const uint8_t *end = bytes + font->mapLength;
+    bool psf2 = (bytes[0] != PSF1_MAGIC0);
+
+    uint32_t glyphOffset = font->bitmaps - bytes;
+    const uint8_t *table = font->bitmaps
+                         + ((size_t)font->glyphs * font->bytesPerGlyph);
+
+    bool hasTable = (psf2)
+                  ? (readLittleEndian32(bytes + 12) & PSF2_HAS_UNICODE_TABLE)
+                  : (bytes[2] & (PSF1_MODEHASTAB | PSF1_MODEHASSEQ));
+
+    int32_t count = font->glyphs;
+
+    if (hasTable)
+    {
+        count = readPsfUnicodeTable(table,
+                                    end,
+                                    psf2,
+                                    font->glyphs,
+                                    glyphOffset,
+                                    font->bytesPerGlyph,
+                                    NULL);
+    }
+
+    FONT_STORE_T *fontStore = calloc(1, sizeof(FONT_STORE_T));
+
+    if (fontStore == NULL)
+    {
+        perror("loadfont: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (initGlyphStore(&(fontStore->glyphs),
+                       count,
+                       font->bytesPerGlyph,
+                       size) == false)
+    {
+        free(fontStore);
+        destroyFont(font);
+        return false;
+    }
+
+    GLYPH_STORE_INDEX_T *index = fontStore->glyphs.index;
+
+    if (hasTable)
+    {
+        readPsfUnicodeTable(table,
+                            end,
+                            psf2,
+                            font->glyphs,
+                            glyphOffset,
+                            font->bytesPerGlyph,
+                            index);
+    }
+    else
+    {
+        int32_t glyph;
+        for (glyph = 0 ; glyph < count ; glyph++)
+        {
+            index[glyph].codePoint = glyph;
+            index[glyph].offset = glyphOffset + (glyph * font->bytesPerGlyph);
+        }
+    }
+
+    sortGlyphStoreIndex(&(fontStore->glyphs));
+
+    fontStore->bdf = false;
+
+    font->glyphs = fontStore->glyphs.glyphs;
+    font->bitmaps = NULL;
+    font->store = fontStore;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// Find the glyphs of a BDF font, returning how many have an encoding. If
+// index is not NULL each is recorded there, with the offset of its
+// STARTCHAR line.
+//
+
+static int32_t
+readBdfGlyphs(
+    const char *text,
+    const char *end,
+    GLYPH_STORE_INDEX_T *index)
+{
+    const char *start = text;
+    const char *glyph = NULL;
+    char line[256];
+    int32_t count = 0;
+
+    while (text < end)
+    {
+        const char *current = text;
+        int encoding = -1;
+
+        text = nextLine(text, end, line, sizeof(line));
+
+        if (strncmp(line, "STARTCHAR", 9) == 0)
+        {
+            glyph = current;
+        }
+        else if ((glyph != NULL) &&
+                 (sscanf(line, "ENCODING %d", &encoding) == 1))
+        {
+            if (encoding >= 0)
+            {
+                if (index != NULL)
+                {
+                    index[count].codePoint = encoding;
+                    index[count].offset = glyph - start;
+                }
+
+                ++count;
+            }
+
+            glyph = NULL;
+        }
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+readBdfGlyph(
+    const FONT_T *font,
+    const FONT_STORE_T *fontStore,
+    uint32_t offset,
+    uint8_t *cell)
+{
+    const char *text = (const char *)font->map + offset;
+    const char *end = (const char *)font->map + font->mapLength;
+    char line[256];
+
+    int width = 0;
+    int height = 0;
+    int xOffset = 0;
+    int yOffset = 0;
+    int row = -1;
+
+    while (text < end)
+    {
+        text = nextLine(text, end, line, sizeof(line));
+
+        if (strncmp(line, "ENDCHAR", 7) == 0)
+        {
+            break;
+        }
+        else if (row >= 0)
+        {
+            setBdfRow(font,
+                      cell,
+                      fontStore->ascent - (yOffset + height) + row,
+                      xOffset - fontStore->boxX,
+                      width,
+                      line);
+            ++row;
+        }
+        else if (strncmp(line, "BITMAP", 6) == 0)
+        {
+            row = 0;
+        }
+        else
+        {
+            sscanf(line, "BBX %d %d %d %d", &width, &height, &xOffset, &yOffset);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+openBdfFont(
+    const char *file,
+    int32_t size,
+    FONT_T *font)
+{
+    clearFont(font);
+
+    int fd = open(file, O_RDONLY);
+
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if ((fstat(fd, &st) == -1) || (st.st_size == 0))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED)
+    {
+        return false;
+    }
+
+    font->map = map;
+    font->mapLength = st.st_size;
+
+    //---------------------------------------------------------------------
+
+    const char *text = map;
+    const char *end = text + st.st_size;
+    char line[256];
+
+    int boxWidth = 0;
+    int boxHeight = 0;
+    int boxX = 0;
+    int boxY = 0;
+
+    while ((text < end) && (font->width == 0))
+    {
+        text = nextLine(text, end, line, sizeof(line));
+
+        if ((sscanf(line,
+                    "FONTBOUNDINGBOX %d %d %d %d",
+                    &boxWidth,
+                    &boxHeight,
+                    &boxX,
+                    &boxY) == 4) &&
+            (boxWidth > 0) &&
+            (boxHeight > 0))
+        {
+            font->width = boxWidth;
+            font->height = boxHeight;
+            font->bytesPerRow = (boxWidth + 7) / 8;
+            font->bytesPerGlyph = font->bytesPerRow * boxHeight;
+        }
+    }
+
+    int32_t count = readBdfGlyphs(map, end, NULL);
+
+    if ((font->width == 0) || (count == 0))
+    {
+        destroyFont(font);
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+
+    FONT_STORE_T *fontStore = calloc(1, sizeof(FONT_STORE_T));
+
+    if (fontStore == NULL)
+    {
+        perror("loadfont: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (initGlyphStore(&(fontStore->glyphs),
+                       count,
+                       font->bytesPerGlyph,
+                       size) == false)
+    {
+        free(fontStore);
+        destroyFont(font);
+        return false;
+    }
+
+    readBdfGlyphs(map, end, fontStore->glyphs.index);
+    sortGlyphStoreIndex(&(fontStore->glyphs));
+
+    fontStore->bdf = true;
+    fontStore->boxX = boxX;
+    fontStore->ascent = boxHeight + boxY;
+
+    font->glyphs = fontStore->glyphs.glyphs;
+    font->store = fontStore;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static int32_t
+findStoreGlyph(
+    const FONT_T *font,
+    uint32_t codePoint)
+{
+    const FONT_STORE_T *fontStore = font->store;
+
+    return findGlyphStoreIndex(&(fontStore->glyphs), codePoint);
+}
+
+//-------------------------------------------------------------------------
+
+static const uint8_t *
+loadStoreGlyph(
+    const FONT_T *font,
+    uint32_t c)
+{
+    FONT_STORE_T *fontStore = font->store;
+    GLYPH_STORE_T *glyphs = &(fontStore->glyphs);
+
+    uint8_t *bitmap = findStoredGlyph(glyphs, c);
+
+    if (bitmap == NULL)
+    {
+        uint32_t offset = glyphs->index[c].offset;
+
+        bitmap = addStoredGlyph(glyphs, c);
+
+        if (fontStore->bdf)
+        {
+            readBdfGlyph(font, fontStore, offset, bitmap);
+        }
+        else
+        {
+            memcpy(bitmap,
+                   (const uint8_t *)font->map + offset,
+                   font->bytesPerGlyph);
+        }
+    }
+
+    return bitmap;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+openFont(
+    const char *file,
+    int32_t size,
+    FONT_T *font)
+{
+    if ((openPsfFont(file, size, font) == false) &&
+        (openBdfFont(file, size, font) == false))
+    {
+        return false;
+    }
+
+    font->findGlyph = findStoreGlyph;
+    font->loadGlyph = loadStoreGlyph;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// An anti-aliased font has the glyph numbers of its source, so code points
+// are looked up in the source (held in font->store).
+//
+
+static int32_t
+findSourceGlyph(
+    const FONT_T *font,
+    uint32_t codePoint)
+{
+    return findGlyphFont(font->store, codePoint);
+}
+
+//-------------------------------------------------------------------------
+
+static int
+countSourcePixels(
+    const FONT_T *source,
+    const uint8_t *glyph,
+    int x,
+    int y,
+    int scale)
+{
+    int count = 0;
+
+    int j;
+    for (j = y ; (j < y + scale) && (j < source->height) ; j++)
+    {
+        const uint8_t *bits = glyph + (j * source->bytesPerRow);
+
+        int i;
+        for (i = x ; (i < x + scale) && (i < source->width) ; i++)
+        {
+            count += (bits[i / 8] >> (7 - (i % 8))) & 1;
+        }
+    }
+
+    return count;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initAntiAliasedFont(
+    FONT_T *font,
+    const FONT_T *source,
+    int16_t scale)
+{
+    clearFont(font);
+
+    if ((source->bitsPerPixel != 1) || (scale < 1))
+    {
+        return false;
+    }
+
+    font->width = (source->width + scale - 1) / scale;
+    font->height = (source->height + scale - 1) / scale;
+    font->bitsPerPixel = FONT_COVERAGE_BITS;
+    font->bytesPerRow = ((font->width * FONT_COVERAGE_BITS) + 7) / 8;
+    font->bytesPerGlyph = font->bytesPerRow * font->height;
+    font->glyphs = source->glyphs;
+
+    if (source->findGlyph != NULL)
+    {
+        font->findGlyph = findSourceGlyph;
+        font->store = (void *)source;
+    }
+
+    font->buffer = calloc(font->glyphs, font->bytesPerGlyph);
+
+    if (font->buffer == NULL)
+    {
+        perror("loadfont: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    //---------------------------------------------------------------------
+
+    int area = scale * scale;
+
+    int32_t c;
+    for (c = 0 ; c < font->glyphs ; c++)
+    {
+        const uint8_t *glyph = getGlyphFont(source, c);
+        uint8_t *cell = font->buffer + (c * font->bytesPerGlyph);
+
+        if (glyph == NULL)
+        {
+            continue;
+        }
+
+        int y;
+        for (y = 0 ; y < font->height ; y++)
+        {
+            uint8_t *row = cell + (y * font->bytesPerRow);
+
+            int x;
+            for (x = 0 ; x < font->width ; x++)
+            {
+                int count = countSourcePixels(source,
+                                              glyph,
+                                              x * scale,
+                                              y * scale,
+                                              scale);
+
+                uint8_t coverage = ((count * FONT_COVERAGE_MAX) + (area / 2))
+                                 / area;
+
+                row[x / 2] |= (x % 2) ? coverage : (coverage << 4);
+            }
+        }
+    }
+
+    font->bitmaps = font->buffer;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyFont(
+    FONT_T *font)
+{
+    if (font->map != NULL)
+    {
+        munmap(font->map, font->mapLength);
+    }
+
+    free(font->buffer);
+
+    if (font->findGlyph == findStoreGlyph)
+    {
+        destroyGlyphStore(font->store);
+        free(font->store);
+    }
+
+    clearFont(font);
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,89 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef LOADFONT_H
+#define LOADFONT_H
+
+#include <stdbool.h>
+
+#include "font.h"
+
+//-------------------------------------------------------------------------
+
+// PSF (version 1 or 2) fonts are mapped from the file, so the file is
+// read only as glyphs are drawn. BDF fonts are decoded once, the glyphs
+// for encodings 0 to 255 being placed in cells the size of the font's
+// bounding box.
+
+bool
+loadPsfFont(
+    const char *file,
+    FONT_T *font);
+
+bool
+loadBdfFont(
+    const char *file,
+    FONT_T *font);
+
+// Load a PSF or BDF font, whichever the file holds.
+
+bool
+loadFont(
+    const char *file,
+    FONT_T *font);
+
+// Open a PSF or BDF font whose glyphs are read from the (mapped) file as
+// they are first drawn, at most size of them being held at once. Glyphs
+// are found by Unicode code point, using the Unicode table of a PSF font
+// or the encodings of a BDF font. font->store is the font's GLYPH_STORE_T
+// (which counts hits and misses). Close it with destroyFont.
+
+bool
+openFont(
+    const char *file,
+    int32_t size,
+    FONT_T *font);
+
+// Make an anti-aliased font by shrinking a bitmap font, scale by scale
+// pixels becoming one pixel of four bit coverage. A 16x32 font at a scale
+// of two gives a smooth 8x16 font. Code points are mapped to glyphs by the
+// source font, which must not be destroyed before this one.
+
+bool
+initAntiAliasedFont(
+    FONT_T *font,
+    const FONT_T *source,
+    int16_t scale);
+
+void
+destroyFont(
+    FONT_T *font);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -31,19 +31,25 @@
 #include "loadpng.h"
 
 //-------------------------------------------------------------------------
+//
+// Read a PNG as 8 bit RGB, or RGBA if it has any transparency. Returns
+// the pixels (which the caller must free) or NULL.
+//
 
-bool
-loadPng(
+static void *
+readPng(
     const char *file,
-    const RGB8_T *background,
-    IMAGE_T *image)
+    png_uint_32 *width,
+    png_uint_32 *height,
+    png_uint_32 *bytesPerPixel,
+    png_uint_32 *rowBytes)
 {
     FILE *fpin = fopen(file, "rb");
 
     if (fpin == NULL)
     {
         perror("Error: cannot open file");
-        return false;
+        return NULL;
     }
 
     //---------------------------------------------------------------------
@@ -78,22 +84,29 @@ loadPng(
 
     png_read_info(png_ptr, info_ptr);
 
-    png_uint_32 width = png_get_image_width(png_ptr, info_ptr);
-    png_uint_32 height = png_get_image_height(png_ptr, info_ptr);
+    *width = png_get_image_width(png_ptr, info_ptr);
+    *height = png_get_image_height(png_ptr, info_ptr);
 
     png_byte colour_type = png_get_color_type(png_ptr, info_ptr);
     png_byte bit_depth = png_get_bit_depth(png_ptr, info_ptr);
 
     //---------------------------------------------------------------------
 
-    png_uint_32 bytesPerPixel = 3;
+    *bytesPerPixel = 3;
 
-    if (colour_type & PNG_COLOR_MASK_ALPHA)
+    if ((colour_type & PNG_COLOR_MASK_ALPHA) ||
+        png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
     {
-        bytesPerPixel = 4;
+        *bytesPerPixel = 4;
     }
 
-    void *buffer = malloc(width * height * bytesPerPixel);
+    void *buffer = malloc(*width * *height * *bytesPerPixel);
+
+    if (buffer == NULL)
+    {
+        perror("Error: cannot allocate image buffer");
+        exit(EXIT_FAILURE);
+    }
 
     //---------------------------------------------------------------------
 
@@ -142,14 +155,14 @@ loadPng(
 
     //---------------------------------------------------------------------
 
-    png_uint_32 row_bytes = png_get_rowbytes(png_ptr, info_ptr);
+    *rowBytes = png_get_rowbytes(png_ptr, info_ptr);
 
-    png_bytepp row_pointers = malloc(sizeof(png_bytep) * height);
+    png_bytepp row_pointers = malloc(sizeof(png_bytep) * *height);
 
     png_uint_32 j = 0;
-    for (j = 0 ; j < height ; j++)
+    for (j = 0 ; j < *height ; j++)
     {
-        row_pointers[j] = buffer + (j * row_bytes);
+        row_pointers[j] = buffer + (j * *rowBytes);
     }
 
     //---------------------------------------------------------------------
@@ -164,32 +177,162 @@ loadPng(
 
     png_destroy_read_struct(&png_ptr, &info_ptr, 0);
 
-    //---------------------------------------------------------------------
+    return buffer;
+}
 
-    bool result = initImage(image, width, height, true);
+//-------------------------------------------------------------------------
+//
+// Error diffusion carries error from each row to the next, so it can only
+// be done one row at a time.
+//
 
-    if (result == false)
+static void
+diffuseRows(
+    const uint8_t *buffer,
+    png_uint_32 rowBytes,
+    png_uint_32 bytesPerPixel,
+    const RGB8_T *background,
+    DITHER_T dither,
+    IMAGE_T *image)
+{
+    ERROR_DIFFUSION_T ed;
+    initErrorDiffusion(&ed, image->width, dither == DITHER_SERPENTINE);
+
+    uint8_t *flattened = malloc(image->width * 3);
+
+    if (flattened == NULL)
     {
-        free(buffer);
-        return false;
+        perror("Error: cannot allocate row buffer");
+        exit(EXIT_FAILURE);
     }
 
-    for (j = 0 ; j < height ; j++)
+    int16_t j = 0;
+    for (j = 0 ; j < image->height ; j++)
     {
-        png_uint_32 i = 0;
-        for (i = 0 ; i < width ; i++)
+        int16_t i = 0;
+        for (i = 0 ; i < image->width ; i++)
         {
-            uint8_t *pixel = buffer + (i * bytesPerPixel) + (j * row_bytes);
+            const uint8_t *pixel = buffer
+                                 + (i * bytesPerPixel)
+                                 + (j * rowBytes);
 
             RGB8_T rgb = { pixel[0], pixel[1], pixel[2] };
 
-            if (colour_type & PNG_COLOR_MASK_ALPHA)
+            if (bytesPerPixel == 4)
             {
                 blendRGB(pixel[3], &rgb, background, &rgb);
             }
 
-            setPixelRGB(image, i, j, &rgb);        
+            flattened[(i * 3)] = rgb.red;
+            flattened[(i * 3) + 1] = rgb.green;
+            flattened[(i * 3) + 2] = rgb.blue;
+        }
+
+        errorDiffuseRow(&ed,
+                        flattened,
+                        3,
+                        image->buffer + (j * image->width));
+
+        damageImage(image, 0, j, image->width, 1);
+    }
+
+    destroyErrorDiffusion(&ed);
+    free(flattened);
+}
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    IMAGE_T *image;
+    const uint8_t *buffer;
+    png_uint_32 rowBytes;
+    png_uint_32 bytesPerPixel;
+    const RGB8_T *background;
+} CONVERT_JOB_T;
+
+static void
+convertJob(
+    void *context,
+    int32_t start,
+    int32_t end)
+{
+    const CONVERT_JOB_T *job = context;
+
+    convertRowsRGB(job->image,
+                   job->buffer,
+                   job->rowBytes,
+                   job->bytesPerPixel,
+                   job->background,
+                   start,
+                   end);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+loadPng(
+    const char *file,
+    const RGB8_T *background,
+    DITHER_T dither,
+    WORKER_POOL_T *pool,
+    IMAGE_T *image)
+{
+    png_uint_32 width;
+    png_uint_32 height;
+    png_uint_32 bytesPerPixel;
+    png_uint_32 row_bytes;
+
+    void *buffer = readPng(file, &width, &height, &bytesPerPixel, &row_bytes);
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+
+    bool result = initImage(image, width, height, dither == DITHER_ORDERED);
+
+    if (result == false)
+    {
+        free(buffer);
+        return false;
+    }
+
+    bool diffuse = (dither == DITHER_ERROR_DIFFUSION) ||
+                   (dither == DITHER_SERPENTINE);
+
+    if (diffuse)
+    {
+        diffuseRows(buffer,
+                    row_bytes,
+                    bytesPerPixel,
+                    background,
+                    dither,
+                    image);
+    }
+    else
+    {
+        CONVERT_JOB_T job =
+        {
+            image,
+            buffer,
+            row_bytes,
+            bytesPerPixel,
+            background
+        };
+
+        if (pool != NULL)
+        {
+            runWorkerPool(pool, convertJob, &job, height);
+        }
+        else
+        {
+            convertJob(&job, 0, height);
         }
+
+        damageImage(image, 0, 0, width, height);
     }
 
     free(buffer);
@@ -199,3 +342,34 @@ loadPng(
     return true;
 }
 
+//-------------------------------------------------------------------------
+
+bool
+loadPngSprite(
+    const char *file,
+    SPRITE_T *sprite)
+{
+    png_uint_32 width;
+    png_uint_32 height;
+    png_uint_32 bytesPerPixel;
+    png_uint_32 row_bytes;
+
+    void *buffer = readPng(file, &width, &height, &bytesPerPixel, &row_bytes);
+
+    if (buffer == NULL)
+    {
+        return false;
+    }
+
+    bool result = initSpriteRGBA(sprite,
+                                 buffer,
+                                 width,
+                                 height,
+                                 row_bytes,
+                                 bytesPerPixel);
+
+    free(buffer);
+
+    return result;
+}
+
@@ -30,11 +30,31 @@
 
 #include <stdbool.h>
 
+#include "dither.h"
 #include "image.h"
+#include "sprite.h"
+#include "workerPool.h"
 
 //-------------------------------------------------------------------------
 
-bool loadPng(const char *file, const RGB8_T *background, IMAGE_T *image);
+// Load a PNG, blending any transparency over the background. Unless the
+// image is error diffused the conversion is split between the threads of
+// pool, which may be NULL to use the calling thread only.
+
+bool
+loadPng(
+    const char *file,
+    const RGB8_T *background,
+    DITHER_T dither,
+    WORKER_POOL_T *pool,
+    IMAGE_T *image);
+
+// Load a PNG, keeping its transparency, as a sprite.
+
+bool
+loadPngSprite(
+    const char *file,
+    SPRITE_T *sprite);
 
 //-------------------------------------------------------------------------
 
@@ -29,8 +29,149 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "boxFilter.h"
 #include "nearestNeighbour.h"
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+//
+// Return the integer factor (2 to 4) if the index table maps each source
+// column to exactly that many destination columns (upscale) or takes
+// every factor'th source column (downscale, where 1 is a straight copy).
+// Otherwise return 0.
+//
+
+static int16_t
+integerScale(
+    const int16_t *xIndex,
+    int16_t width,
+    bool upscale)
+{
+    int16_t factor;
+    for (factor = (upscale) ? 2 : 1 ; factor <= 4 ; factor++)
+    {
+        int16_t i = 0;
+
+        while ((i < width) &&
+               (xIndex[i] == ((upscale) ? (i / factor) : (i * factor))))
+        {
+            ++i;
+        }
+
+        if (i == width)
+        {
+            return factor;
+        }
+    }
+
+    return 0;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+scaleRow(
+    const NEAREST_NEIGHBOUR_T *nn,
+    uint16_t *dst,
+    const uint16_t *src)
+{
+    int32_t width = nn->destinationWidth;
+    int32_t i = 0;
+
+    if (nn->xDownscale == 1)
+    {
+        memcpy(dst, src, width * sizeof(uint16_t));
+        return;
+    }
+
+#if defined(__ARM_NEON)
+
+    switch (nn->xDownscale)
+    {
+    case 2:
+
+        for ( ; ((i + 8) <= width) && (((i + 8) * 2) <= nn->sourceWidth) ;
+             i += 8)
+        {
+            vst1q_u16(dst + i, vld2q_u16(src + (i * 2)).val[0]);
+        }
+
+        break;
+
+    case 3:
+
+        for ( ; ((i + 8) <= width) && (((i + 8) * 3) <= nn->sourceWidth) ;
+             i += 8)
+        {
+            vst1q_u16(dst + i, vld3q_u16(src + (i * 3)).val[0]);
+        }
+
+        break;
+
+    case 4:
+
+        for ( ; ((i + 8) <= width) && (((i + 8) * 4) <= nn->sourceWidth) ;
+             i += 8)
+        {
+            vst1q_u16(dst + i, vld4q_u16(src + (i * 4)).val[0]);
+        }
+
+        break;
+    }
+
+    switch (nn->xUpscale)
+    {
+    case 2:
+
+        for ( ; (i + 16) <= width ; i += 16)
+        {
+            uint16x8_t pixels = vld1q_u16(src + (i / 2));
+            uint16x8x2_t repeated = { { pixels, pixels } };
+            vst2q_u16(dst + i, repeated);
+        }
+
+        break;
+
+    case 3:
+
+        for ( ; (i + 24) <= width ; i += 24)
+        {
+            uint16x8_t pixels = vld1q_u16(src + (i / 3));
+            uint16x8x3_t repeated = { { pixels, pixels, pixels } };
+            vst3q_u16(dst + i, repeated);
+        }
+
+        break;
+
+    case 4:
+
+        for ( ; (i + 32) <= width ; i += 32)
+        {
+            uint16x8_t pixels = vld1q_u16(src + (i / 4));
+            uint16x8x4_t repeated = { { pixels, pixels, pixels, pixels } };
+            vst4q_u16(dst + i, repeated);
+        }
+
+        break;
+    }
+
+#endif
+
+    const int16_t *xIndex = nn->xIndex;
+
+    for ( ; i < width ; i++)
+    {
+        dst[i] = src[xIndex[i]];
+    }
+}
 
 //-------------------------------------------------------------------------
 
@@ -69,6 +210,30 @@ initNearestNeighbour(
 
     nn->sourceWidth = sWidth;
     nn->sourceHeight = sHeight;
+
+    //---------------------------------------------------------------------
+
+    nn->xIndex = malloc(nn->destinationWidth * sizeof(int16_t));
+
+    if (nn->xIndex == NULL)
+    {
+        perror("nearestNeighbour: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t i;
+    for (i = 0 ; i < nn->destinationWidth ; i++)
+    {
+        nn->xIndex[i] = (i * nn->xRatio) >> 16;
+    }
+
+    nn->xUpscale = integerScale(nn->xIndex, nn->destinationWidth, true);
+    nn->xDownscale = integerScale(nn->xIndex, nn->destinationWidth, false);
+
+    nn->boxFactor = boxFilterFactor(nn->destinationWidth,
+                                    nn->destinationHeight,
+                                    sWidth,
+                                    sHeight);
 }
 
 //-------------------------------------------------------------------------
@@ -81,21 +246,127 @@ resizeNearestNeighbour(
     void *src,
     int16_t sPitch)
 {
+    resizeNearestNeighbourRows(nn,
+                               dst,
+                               dPitch,
+                               src,
+                               sPitch,
+                               0,
+                               nn->destinationHeight);
+}
+
+//-------------------------------------------------------------------------
+
+void
+resizeNearestNeighbourRow(
+    const NEAREST_NEIGHBOUR_T *nn,
+    uint16_t *dst,
+    const uint16_t *src)
+{
+    scaleRow(nn, dst, src);
+}
+
+//-------------------------------------------------------------------------
+
+void
+resizeNearestNeighbourRows(
+    const NEAREST_NEIGHBOUR_T *nn,
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t start,
+    int16_t end)
+{
+    if (nn->boxFactor != 0)
+    {
+        boxFilterRows(nn->boxFactor,
+                      nn->destinationWidth,
+                      dst,
+                      dPitch,
+                      src,
+                      sPitch,
+                      start,
+                      end);
+        return;
+    }
+
+    int32_t previous = -1;
+
     int32_t j;
-    for (j = 0 ; j < nn->destinationHeight ; j++)
+    for (j = start ; j < end ; j++)
     {
         int32_t y = (j * nn->yRatio) >> 16;
 
-        int32_t i;
-        for (i = 0 ; i < nn->destinationWidth ; i++)
-        {
-            int32_t x = (i * nn->xRatio) >> 16;
+        uint16_t *row = dst + (j * dPitch);
 
-            *((uint16_t*)(dst + (i * sizeof(uint16_t)) + (j * dPitch))) =
-            *((uint16_t*)(src + (x * sizeof(uint16_t)) + (y * sPitch)));
+        if (y == previous)
+        {
+            memcpy(row,
+                   dst + ((j - 1) * dPitch),
+                   nn->destinationWidth * sizeof(uint16_t));
+        }
+        else
+        {
+            scaleRow(nn, row, src + (y * sPitch));
+            previous = y;
         }
     }
 }
 
 //-------------------------------------------------------------------------
 
+typedef struct
+{
+    const NEAREST_NEIGHBOUR_T *nn;
+    void *dst;
+    int16_t dPitch;
+    const void *src;
+    int16_t sPitch;
+} RESIZE_JOB_T;
+
+static void
+resizeJob(
+    void *context,
+    int32_t start,
+    int32_t end)
+{
+    const RESIZE_JOB_T *job = context;
+
+    resizeNearestNeighbourRows(job->nn,
+                               job->dst,
+                               job->dPitch,
+                               job->src,
+                               job->sPitch,
+                               start,
+                               end);
+}
+
+//-------------------------------------------------------------------------
+
+void
+resizeNearestNeighbourThreaded(
+    NEAREST_NEIGHBOUR_T *nn,
+    WORKER_POOL_T *pool,
+    void *dst,
+    int16_t dPitch,
+    void *src,
+    int16_t sPitch)
+{
+    RESIZE_JOB_T job = { nn, dst, dPitch, src, sPitch };
+
+    runWorkerPool(pool, resizeJob, &job, nn->destinationHeight);
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyNearestNeighbour(
+    NEAREST_NEIGHBOUR_T *nn)
+{
+    free(nn->xIndex);
+    nn->xIndex = NULL;
+}
+
+//-------------------------------------------------------------------------
+
@@ -33,7 +33,23 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "workerPool.h"
+
 //-------------------------------------------------------------------------
+//
+// Nearest neighbour RGB565 scaler. The source column for each destination
+// column is calculated once by initNearestNeighbour. A destination row
+// that comes from the same source row as the one above it is copied rather
+// than scaled again. When each source pixel maps to exactly 2, 3 or 4
+// destination pixels (or 2, 3 or 4 source pixels map to each destination
+// pixel) the rows are scaled with NEON structure loads and stores rather
+// than the index table.
+//
+// When the source is exactly 2, 3 or 4 times the size of the destination
+// in both directions, the box filter is used instead (see boxFilter.h).
+// It reads every source pixel rather than one in each block, but there is
+// no aliasing.
+//
 
 typedef struct
 {
@@ -43,6 +59,10 @@ typedef struct
     int16_t sourceHeight;
     int32_t xRatio;
     int32_t yRatio;
+    int16_t *xIndex;
+    int16_t xUpscale;
+    int16_t xDownscale;
+    int16_t boxFactor;
 } NEAREST_NEIGHBOUR_T;
 
 //-------------------------------------------------------------------------
@@ -64,6 +84,43 @@ resizeNearestNeighbour(
     void *src,
     int16_t sPitch);
 
+// Scale one source row to destinationWidth pixels. This is the nearest
+// neighbour in x only, the caller picks the source row.
+
+void
+resizeNearestNeighbourRow(
+    const NEAREST_NEIGHBOUR_T *nn,
+    uint16_t *dst,
+    const uint16_t *src);
+
+// Resize destination rows start to end - 1 only. Bands of rows may be
+// resized at the same time by different threads.
+
+void
+resizeNearestNeighbourRows(
+    const NEAREST_NEIGHBOUR_T *nn,
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t start,
+    int16_t end);
+
+// Resize with the destination rows split between the pool's threads.
+
+void
+resizeNearestNeighbourThreaded(
+    NEAREST_NEIGHBOUR_T *nn,
+    WORKER_POOL_T *pool,
+    void *dst,
+    int16_t dPitch,
+    void *src,
+    int16_t sPitch);
+
+void
+destroyNearestNeighbour(
+    NEAREST_NEIGHBOUR_T *nn);
+
 //-------------------------------------------------------------------------
 
 #endif
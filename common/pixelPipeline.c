@@ -0,0 +1,528 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "boxFilter.h"
+#include "image.h"
+#include "nearestNeighbour.h"
+#include "pixelPipeline.h"
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+
+static inline uint8_t
+addDither(
+    uint8_t value,
+    uint8_t dither)
+{
+    uint16_t sum = value + dither;
+
+    return (sum > 255) ? 255 : sum;
+}
+
+//-------------------------------------------------------------------------
+//
+// Dither (if asked for) and pack pixel i of destination row j.
+//
+
+static inline uint16_t
+packPixel(
+    const PIXEL_PIPELINE_T *pipeline,
+    uint8_t red,
+    uint8_t green,
+    uint8_t blue,
+    int32_t i,
+    int16_t j)
+{
+    if (pipeline->dither)
+    {
+        uint8_t redBlue = ditherRedBlueRGB565[((j & 7) << 3) + (i & 7)];
+        uint8_t greenOffset = ditherGreenRGB565[((j & 7) << 3) + (i & 7)];
+
+        red = addDither(red, redBlue);
+        green = addDither(green, greenOffset);
+        blue = addDither(blue, redBlue);
+    }
+
+    uint16_t rgb = ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+
+    return (pipeline->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+         ? htons(rgb)
+         : rgb;
+}
+
+//-------------------------------------------------------------------------
+
+static inline void
+readPixel(
+    const PIXEL_PIPELINE_T *pipeline,
+    const uint8_t *pixel,
+    bool rgb888,
+    uint8_t *red,
+    uint8_t *green,
+    uint8_t *blue)
+{
+    if (rgb888)
+    {
+        *red = pixel[0];
+        *green = pixel[1];
+        *blue = pixel[2];
+    }
+    else
+    {
+        uint32_t word;
+        memcpy(&word, pixel, sizeof(word));
+
+        *red = word >> pipeline->redShift;
+        *green = word >> pipeline->greenShift;
+        *blue = word >> pipeline->blueShift;
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Scale, dither and pack one row of RGB888 or 32 bit pixels.
+//
+
+static void
+convertRow(
+    const PIXEL_PIPELINE_T *pipeline,
+    uint16_t *dst,
+    const uint8_t *src,
+    int16_t j)
+{
+    const NEAREST_NEIGHBOUR_T *nn = &(pipeline->nn);
+
+    int32_t width = nn->destinationWidth;
+    bool rgb888 = (pipeline->format == PIXEL_FORMAT_RGB888);
+
+    int32_t i = 0;
+
+#if defined(__ARM_NEON) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+    bool bigEndian = (pipeline->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN);
+
+    // When each destination pixel comes from the source pixel in the same
+    // column, eight pixels are read, dithered and packed at a time. The
+    // dither pattern repeats every eight columns, so one vector covers
+    // the row. Adding zero is cheaper than a second loop without dither.
+
+    if (nn->xDownscale == 1)
+    {
+        uint8x8_t redBlueOffset = vdup_n_u8(0);
+        uint8x8_t greenOffset = vdup_n_u8(0);
+
+        if (pipeline->dither)
+        {
+            redBlueOffset = vld1_u8(ditherRedBlueRGB565 + ((j & 7) << 3));
+            greenOffset = vld1_u8(ditherGreenRGB565 + ((j & 7) << 3));
+        }
+
+        for ( ; (i + 8) <= width ; i += 8)
+        {
+            uint8x8_t red;
+            uint8x8_t green;
+            uint8x8_t blue;
+
+            if (rgb888)
+            {
+                uint8x8x3_t pixels = vld3_u8(src + (i * 3));
+
+                red = pixels.val[0];
+                green = pixels.val[1];
+                blue = pixels.val[2];
+            }
+            else
+            {
+                uint8x8x4_t pixels = vld4_u8(src + (i * 4));
+
+                red = pixels.val[pipeline->redShift / 8];
+                green = pixels.val[pipeline->greenShift / 8];
+                blue = pixels.val[pipeline->blueShift / 8];
+            }
+
+            red = vqadd_u8(red, redBlueOffset);
+            green = vqadd_u8(green, greenOffset);
+            blue = vqadd_u8(blue, redBlueOffset);
+
+            uint16x8_t rgb = vshll_n_u8(red, 8);
+            rgb = vsriq_n_u16(rgb, vshll_n_u8(green, 8), 5);
+            rgb = vsriq_n_u16(rgb, vshll_n_u8(blue, 8), 11);
+
+            if (bigEndian)
+            {
+                uint8x16_t bytes = vreinterpretq_u8_u16(rgb);
+                rgb = vreinterpretq_u16_u8(vrev16q_u8(bytes));
+            }
+
+            vst1q_u16(dst + i, rgb);
+        }
+    }
+
+#endif
+
+    const int16_t *xIndex = nn->xIndex;
+    int16_t bytes = (rgb888) ? 3 : 4;
+
+    for ( ; i < width ; i++)
+    {
+        uint8_t red;
+        uint8_t green;
+        uint8_t blue;
+
+        readPixel(pipeline,
+                  src + (xIndex[i] * bytes),
+                  rgb888,
+                  &red,
+                  &green,
+                  &blue);
+
+        dst[i] = packPixel(pipeline, red, green, blue, i, j);
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// The rounded average of a factor by factor block of 8 bit values.
+// (sum + 4) * 7282 / 65536 is exactly (sum + 4) / 9 for every sum of nine
+// 8 bit values.
+//
+
+static inline uint8_t
+boxAverage(
+    uint16_t sum,
+    int16_t factor)
+{
+    switch (factor)
+    {
+    case 2:
+
+        return (sum + 2) >> 2;
+
+    case 3:
+
+        return ((sum + 4) * 7282) >> 16;
+
+    default:
+
+        return (sum + 8) >> 4;
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Box filter, dither and pack one row of RGB888 or 32 bit pixels from
+// the factor source rows, sPitch bytes apart, that start at src. The
+// channels are averaged at 8 bits, before they are dithered.
+//
+
+static void
+convertBoxRow(
+    const PIXEL_PIPELINE_T *pipeline,
+    uint16_t *dst,
+    const uint8_t *src,
+    int32_t sPitch,
+    int16_t j)
+{
+    const NEAREST_NEIGHBOUR_T *nn = &(pipeline->nn);
+
+    int16_t factor = nn->boxFactor;
+    bool rgb888 = (pipeline->format == PIXEL_FORMAT_RGB888);
+    int16_t bytes = (rgb888) ? 3 : 4;
+
+    int32_t i;
+    for (i = 0 ; i < nn->destinationWidth ; i++)
+    {
+        uint16_t redSum = 0;
+        uint16_t greenSum = 0;
+        uint16_t blueSum = 0;
+
+        const uint8_t *block = src + (i * factor * bytes);
+
+        int16_t k;
+        for (k = 0 ; k < factor ; k++, block += sPitch)
+        {
+            int16_t l;
+            for (l = 0 ; l < factor ; l++)
+            {
+                uint8_t red;
+                uint8_t green;
+                uint8_t blue;
+
+                readPixel(pipeline,
+                          block + (l * bytes),
+                          rgb888,
+                          &red,
+                          &green,
+                          &blue);
+
+                redSum += red;
+                greenSum += green;
+                blueSum += blue;
+            }
+        }
+
+        dst[i] = packPixel(pipeline,
+                           boxAverage(redSum, factor),
+                           boxAverage(greenSum, factor),
+                           boxAverage(blueSum, factor),
+                           i,
+                           j);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+initPixelPipeline(
+    PIXEL_PIPELINE_T *pipeline,
+    PIXEL_FORMAT_T format,
+    IMAGE_BYTE_ORDER_T byteOrder,
+    bool dither,
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight,
+    bool keepAspectRatio)
+{
+    initNearestNeighbour(&(pipeline->nn),
+                         dWidth,
+                         dHeight,
+                         sWidth,
+                         sHeight,
+                         keepAspectRatio);
+
+    pipeline->format = format;
+    pipeline->byteOrder = byteOrder;
+    pipeline->dither = dither && (format != PIXEL_FORMAT_RGB565);
+
+    switch (format)
+    {
+    case PIXEL_FORMAT_XBGR8888:
+
+        pipeline->redShift = 0;
+        pipeline->greenShift = 8;
+        pipeline->blueShift = 16;
+        break;
+
+    case PIXEL_FORMAT_RGBX8888:
+
+        pipeline->redShift = 24;
+        pipeline->greenShift = 16;
+        pipeline->blueShift = 8;
+        break;
+
+    case PIXEL_FORMAT_BGRX8888:
+
+        pipeline->redShift = 8;
+        pipeline->greenShift = 16;
+        pipeline->blueShift = 24;
+        break;
+
+    default:
+
+        pipeline->redShift = 16;
+        pipeline->greenShift = 8;
+        pipeline->blueShift = 0;
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+int16_t
+pixelPipelineSourceRow(
+    const PIXEL_PIPELINE_T *pipeline,
+    int16_t j)
+{
+    return (j * pipeline->nn.yRatio) >> 16;
+}
+
+//-------------------------------------------------------------------------
+
+int16_t
+pixelPipelineSourceRows(
+    const PIXEL_PIPELINE_T *pipeline)
+{
+    return (pipeline->nn.boxFactor != 0) ? pipeline->nn.boxFactor : 1;
+}
+
+//-------------------------------------------------------------------------
+
+void
+pixelPipelineRow(
+    const PIXEL_PIPELINE_T *pipeline,
+    uint16_t *dst,
+    const void *src,
+    int32_t sPitch,
+    int16_t j)
+{
+    const NEAREST_NEIGHBOUR_T *nn = &(pipeline->nn);
+
+    if (pipeline->format == PIXEL_FORMAT_RGB565)
+    {
+        if (nn->boxFactor != 0)
+        {
+            boxFilterRows(nn->boxFactor,
+                          nn->destinationWidth,
+                          dst,
+                          0,
+                          src,
+                          sPitch,
+                          0,
+                          1);
+        }
+        else
+        {
+            resizeNearestNeighbourRow(nn, dst, src);
+        }
+
+        if (pipeline->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN)
+        {
+            htonsRGB565(dst, dst, nn->destinationWidth);
+        }
+    }
+    else if (nn->boxFactor != 0)
+    {
+        convertBoxRow(pipeline, dst, src, sPitch, j);
+    }
+    else
+    {
+        convertRow(pipeline, dst, src, j);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+pixelPipelineRows(
+    const PIXEL_PIPELINE_T *pipeline,
+    void *dst,
+    int32_t dPitch,
+    const void *src,
+    int32_t sPitch,
+    int16_t start,
+    int16_t end)
+{
+    const NEAREST_NEIGHBOUR_T *nn = &(pipeline->nn);
+
+    int32_t previous = -1;
+
+    int32_t j;
+    for (j = start ; j < end ; j++)
+    {
+        uint16_t *row = dst + (j * dPitch);
+
+        // The dither pattern changes from row to row, so only undithered
+        // rows can be copied from the one above. With the box filter each
+        // row has a source row of its own.
+
+        int32_t y = pixelPipelineSourceRow(pipeline, j);
+
+        if ((y == previous) && (pipeline->dither == false))
+        {
+            memcpy(row,
+                   dst + ((j - 1) * dPitch),
+                   nn->destinationWidth * sizeof(uint16_t));
+        }
+        else
+        {
+            pixelPipelineRow(pipeline, row, src + (y * sPitch), sPitch, j);
+            previous = y;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    const PIXEL_PIPELINE_T *pipeline;
+    void *dst;
+    int32_t dPitch;
+    const void *src;
+    int32_t sPitch;
+} PIPELINE_JOB_T;
+
+static void
+pipelineJob(
+    void *context,
+    int32_t start,
+    int32_t end)
+{
+    const PIPELINE_JOB_T *job = context;
+
+    pixelPipelineRows(job->pipeline,
+                      job->dst,
+                      job->dPitch,
+                      job->src,
+                      job->sPitch,
+                      start,
+                      end);
+}
+
+//-------------------------------------------------------------------------
+
+void
+pixelPipelineThreaded(
+    const PIXEL_PIPELINE_T *pipeline,
+    WORKER_POOL_T *pool,
+    void *dst,
+    int32_t dPitch,
+    const void *src,
+    int32_t sPitch)
+{
+    PIPELINE_JOB_T job = { pipeline, dst, dPitch, src, sPitch };
+
+    runWorkerPool(pool, pipelineJob, &job, pipeline->nn.destinationHeight);
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyPixelPipeline(
+    PIXEL_PIPELINE_T *pipeline)
+{
+    destroyNearestNeighbour(&(pipeline->nn));
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,156 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef PIXEL_PIPELINE_H
+#define PIXEL_PIPELINE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+#include "nearestNeighbour.h"
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+//
+// Read pixels in the source format, scale them (nearest neighbour, or a
+// box filter where the source is 2, 3 or 4 times the size of the
+// destination), optionally dither them and write RGB565 in the byte
+// order asked for, all in one pass over each destination row. With
+// IMAGE_BYTE_ORDER_BIG_ENDIAN the result can be sent straight to the
+// LCD, rather than being converted into one buffer, resized into another
+// and byte swapped again on the way out.
+//
+// RGB888 is three bytes per pixel in the order red, green, blue (as
+// libjpeg and libpng give them). The 32 bit formats are a word per pixel,
+// named from its high byte to its low byte, so XRGB8888 has blue in the
+// low byte (as most 32 bit framebuffers hold them). Dithering only
+// applies to these formats, as RGB565 has nothing to dither.
+//
+
+typedef enum
+{
+    PIXEL_FORMAT_RGB565,
+    PIXEL_FORMAT_RGB888,
+    PIXEL_FORMAT_XRGB8888,
+    PIXEL_FORMAT_XBGR8888,
+    PIXEL_FORMAT_RGBX8888,
+    PIXEL_FORMAT_BGRX8888
+} PIXEL_FORMAT_T;
+
+// The shifts are where each channel is in a 32 bit pixel.
+
+typedef struct
+{
+    NEAREST_NEIGHBOUR_T nn;
+    PIXEL_FORMAT_T format;
+    IMAGE_BYTE_ORDER_T byteOrder;
+    bool dither;
+    uint8_t redShift;
+    uint8_t greenShift;
+    uint8_t blueShift;
+} PIXEL_PIPELINE_T;
+
+//-------------------------------------------------------------------------
+
+// The size of the scaled image is in pipeline->nn, as for
+// initNearestNeighbour.
+
+void
+initPixelPipeline(
+    PIXEL_PIPELINE_T *pipeline,
+    PIXEL_FORMAT_T format,
+    IMAGE_BYTE_ORDER_T byteOrder,
+    bool dither,
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight,
+    bool keepAspectRatio);
+
+// The first source row that destination row j is scaled from.
+
+int16_t
+pixelPipelineSourceRow(
+    const PIXEL_PIPELINE_T *pipeline,
+    int16_t j);
+
+// The number of source rows each destination row is scaled from: the box
+// filter factor, or 1.
+
+int16_t
+pixelPipelineSourceRows(
+    const PIXEL_PIPELINE_T *pipeline);
+
+// Write destination row j from its source rows alone (src being the first
+// of them, see pixelPipelineSourceRow, and the rest sPitch bytes apart),
+// so that a source decoded a few rows at a time need not be held in
+// memory.
+
+void
+pixelPipelineRow(
+    const PIXEL_PIPELINE_T *pipeline,
+    uint16_t *dst,
+    const void *src,
+    int32_t sPitch,
+    int16_t j);
+
+// Write destination rows start to end - 1 from a whole source image.
+// Bands of rows may be written at the same time by different threads.
+
+void
+pixelPipelineRows(
+    const PIXEL_PIPELINE_T *pipeline,
+    void *dst,
+    int32_t dPitch,
+    const void *src,
+    int32_t sPitch,
+    int16_t start,
+    int16_t end);
+
+// Write every destination row with the rows split between the pool's
+// threads.
+
+void
+pixelPipelineThreaded(
+    const PIXEL_PIPELINE_T *pipeline,
+    WORKER_POOL_T *pool,
+    void *dst,
+    int32_t dPitch,
+    const void *src,
+    int32_t sPitch);
+
+void
+destroyPixelPipeline(
+    PIXEL_PIPELINE_T *pipeline);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -32,8 +32,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "bcm_host.h"
+#include <sys/time.h>
 
+#include "boxFilter.h"
 #include "resizeDispmanX.h"
 
 //-------------------------------------------------------------------------
@@ -43,9 +44,13 @@
 #endif
 
 //-------------------------------------------------------------------------
+//
+// Both versions produce the same size of image, with a width that is a
+// multiple of 16 (a requirement of the GPU).
+//
 
-void
-initResizeDispmanX(
+static void
+setSize(
     RESIZE_DISPMANX_T *rd,
     int16_t dWidth,
     int16_t dHeight,
@@ -67,18 +72,364 @@ initResizeDispmanX(
         if (rd->xRatio < rd->yRatio)
         {
             rd->xRatio = rd->yRatio;
-            rd->destinationWidth = ALIGN_TO_16((sWidth * rd->destinationHeight) / sHeight);
+            rd->destinationWidth =
+                ALIGN_TO_16((sWidth * rd->destinationHeight) / sHeight);
         }
         else
         {
             rd->yRatio = rd->xRatio;
             rd->destinationHeight = (rd->destinationWidth * sHeight) / sWidth;
         }
-
     }
 
     rd->sourceWidth = sWidth;
     rd->sourceHeight = sHeight;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+recordFrameTime(
+    RESIZE_DISPMANX_T *rd,
+    const struct timeval *start_time)
+{
+    struct timeval end_time;
+    struct timeval elapsed_time;
+
+    gettimeofday(&end_time, NULL);
+    timersub(&end_time, start_time, &elapsed_time);
+
+    uint32_t frameTime = (elapsed_time.tv_sec * 1000000)
+                       + elapsed_time.tv_usec;
+
+    ++(rd->frames);
+    rd->totalFrameTime += frameTime;
+
+    if (frameTime > rd->maxFrameTime)
+    {
+        rd->maxFrameTime = frameTime;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+#if defined(RESIZE_DISPMANX_SOFTWARE)
+
+//-------------------------------------------------------------------------
+//
+// Split length source pixels into count boxes, one for each destination
+// pixel. When upscaling a box is a single pixel.
+//
+
+static void
+setBoxes(
+    int16_t *start,
+    int16_t *size,
+    int16_t count,
+    int16_t length)
+{
+    int32_t i;
+    for (i = 0 ; i < count ; i++)
+    {
+        int32_t first = (i * length) / count;
+        int32_t last = ((i + 1) * length) / count;
+
+        if (first >= length)
+        {
+            first = length - 1;
+        }
+
+        start[i] = first;
+        size[i] = (last > first) ? (last - first) : 1;
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Dividing by the area of a box is a multiply by its reciprocal, scaled
+// by 2^32. This is exact for boxes of fewer than 8192 pixels. Boxes are
+// always at least two pixels, as single pixels are copied.
+//
+
+static uint32_t
+divideByArea(
+    uint32_t value,
+    uint32_t reciprocal)
+{
+    return ((uint64_t)value * reciprocal) >> 32;
+}
+
+//-------------------------------------------------------------------------
+
+static int16_t
+largestBox(
+    const int16_t *size,
+    int16_t count)
+{
+    int16_t largest = 1;
+
+    int16_t i;
+    for (i = 0 ; i < count ; i++)
+    {
+        if (size[i] > largest)
+        {
+            largest = size[i];
+        }
+    }
+
+    return largest;
+}
+
+//-------------------------------------------------------------------------
+
+static uint16_t
+averageBox(
+    const void *src,
+    int16_t sPitch,
+    int16_t columns,
+    int16_t rows,
+    uint32_t reciprocal)
+{
+    uint32_t red = 0;
+    uint32_t green = 0;
+    uint32_t blue = 0;
+
+    int16_t j;
+    for (j = 0 ; j < rows ; j++)
+    {
+        const uint16_t *pixel = src + (j * sPitch);
+
+        int16_t i;
+        for (i = 0 ; i < columns ; i++)
+        {
+            red += pixel[i] >> 11;
+            green += (pixel[i] >> 5) & 0x3F;
+            blue += pixel[i] & 0x1F;
+        }
+    }
+
+    uint32_t half = (rows * columns) / 2;
+
+    red = divideByArea(red + half, reciprocal);
+    green = divideByArea(green + half, reciprocal);
+    blue = divideByArea(blue + half, reciprocal);
+
+    return (red << 11) | (green << 5) | blue;
+}
+
+//-------------------------------------------------------------------------
+//
+// Each destination pixel is the average of the box of source pixels that
+// it covers.
+//
+
+static void
+resizeRows(
+    const RESIZE_DISPMANX_T *rd,
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t start,
+    int16_t end)
+{
+    if (rd->boxFactor != 0)
+    {
+        boxFilterRows(rd->boxFactor,
+                      rd->destinationWidth,
+                      dst,
+                      dPitch,
+                      src,
+                      sPitch,
+                      start,
+                      end);
+        return;
+    }
+
+    int16_t j;
+    for (j = start ; j < end ; j++)
+    {
+        uint16_t *row = dst + (j * dPitch);
+        const void *first = src + (rd->yStart[j] * sPitch);
+        int16_t rows = rd->ySize[j];
+
+        int16_t i;
+        for (i = 0 ; i < rd->destinationWidth ; i++)
+        {
+            int16_t x = rd->xStart[i];
+            int16_t columns = rd->xSize[i];
+
+            if ((rows == 1) && (columns == 1))
+            {
+                row[i] = ((const uint16_t *)first)[x];
+            }
+            else
+            {
+                row[i] = averageBox(first + (x * sizeof(uint16_t)),
+                                    sPitch,
+                                    columns,
+                                    rows,
+                                    rd->reciprocal[rows * columns]);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    const RESIZE_DISPMANX_T *rd;
+    void *dst;
+    int16_t dPitch;
+    const void *src;
+    int16_t sPitch;
+} RESIZE_JOB_T;
+
+static void
+resizeJob(
+    void *context,
+    int32_t start,
+    int32_t end)
+{
+    const RESIZE_JOB_T *job = context;
+
+    resizeRows(job->rd,
+               job->dst,
+               job->dPitch,
+               job->src,
+               job->sPitch,
+               start,
+               end);
+}
+
+//-------------------------------------------------------------------------
+
+void
+initResizeDispmanX(
+    RESIZE_DISPMANX_T *rd,
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight,
+    bool keepAspectRatio)
+{
+    setSize(rd, dWidth, dHeight, sWidth, sHeight, keepAspectRatio);
+
+    rd->xStart = malloc(rd->destinationWidth * sizeof(int16_t));
+    rd->xSize = malloc(rd->destinationWidth * sizeof(int16_t));
+    rd->yStart = malloc(rd->destinationHeight * sizeof(int16_t));
+    rd->ySize = malloc(rd->destinationHeight * sizeof(int16_t));
+
+    if ((rd->xStart == NULL) ||
+        (rd->xSize == NULL) ||
+        (rd->yStart == NULL) ||
+        (rd->ySize == NULL))
+    {
+        perror("resizeDispmanX: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    setBoxes(rd->xStart, rd->xSize, rd->destinationWidth, sWidth);
+    setBoxes(rd->yStart, rd->ySize, rd->destinationHeight, sHeight);
+
+    // The reciprocal of every box area, so that averaging a box needs no
+    // division.
+
+    int32_t maxArea = largestBox(rd->xSize, rd->destinationWidth)
+                    * largestBox(rd->ySize, rd->destinationHeight);
+
+    rd->reciprocal = malloc((maxArea + 1) * sizeof(uint32_t));
+
+    if (rd->reciprocal == NULL)
+    {
+        perror("resizeDispmanX: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    rd->reciprocal[0] = 0;
+    rd->reciprocal[1] = 0;
+
+    int32_t area;
+    for (area = 2 ; area <= maxArea ; area++)
+    {
+        rd->reciprocal[area] = ((1ULL << 32) + area - 1) / area;
+    }
+
+    rd->boxFactor = boxFilterFactor(rd->destinationWidth,
+                                    rd->destinationHeight,
+                                    sWidth,
+                                    sHeight);
+
+    // Without worker threads the calling thread does all of the rows.
+
+    if (initWorkerPool(&(rd->pool), 0) == false)
+    {
+        initWorkerPool(&(rd->pool), 1);
+    }
+
+    rd->frames = 0;
+    rd->totalFrameTime = 0;
+    rd->maxFrameTime = 0;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyResizeDispmanX(
+    RESIZE_DISPMANX_T *rd)
+{
+    destroyWorkerPool(&(rd->pool));
+
+    free(rd->xStart);
+    free(rd->xSize);
+    free(rd->yStart);
+    free(rd->ySize);
+    free(rd->reciprocal);
+
+    rd->xStart = NULL;
+    rd->xSize = NULL;
+    rd->yStart = NULL;
+    rd->ySize = NULL;
+    rd->reciprocal = NULL;
+}
+
+//-------------------------------------------------------------------------
+
+void
+resizeDispmanX(
+    RESIZE_DISPMANX_T *rd,
+    void *dst,
+    int16_t dPitch,
+    void *src,
+    int16_t sPitch)
+{
+    struct timeval start_time;
+    gettimeofday(&start_time, NULL);
+
+    RESIZE_JOB_T job = { rd, dst, dPitch, src, sPitch };
+
+    runWorkerPool(&(rd->pool), resizeJob, &job, rd->destinationHeight);
+
+    recordFrameTime(rd, &start_time);
+}
+
+//-------------------------------------------------------------------------
+
+#else
+
+//-------------------------------------------------------------------------
+
+void
+initResizeDispmanX(
+    RESIZE_DISPMANX_T *rd,
+    int16_t dWidth,
+    int16_t dHeight,
+    int16_t sWidth,
+    int16_t sHeight,
+    bool keepAspectRatio)
+{
+    setSize(rd, dWidth, dHeight, sWidth, sHeight, keepAspectRatio);
 
     bcm_host_init();
 
@@ -109,6 +460,37 @@ initResizeDispmanX(
                          0,
                          rd->destinationWidth,
                          rd->destinationHeight);
+
+    //---------------------------------------------------------------------
+
+    // The element stays on the offscreen display for as long as the
+    // resizer exists. Each frame only the source resource is rewritten.
+
+    VC_DISPMANX_ALPHA_T alpha;
+
+    alpha.mask = DISPMANX_NO_HANDLE;
+    alpha.flags = DISPMANX_FLAGS_ALPHA_FROM_SOURCE
+                | DISPMANX_FLAGS_ALPHA_MIX;
+    alpha.opacity = 255;
+
+    DISPMANX_UPDATE_HANDLE_T update = vc_dispmanx_update_start(0);
+
+    rd->element = vc_dispmanx_element_add(update,
+                                          rd->display,
+                                          0,
+                                          &(rd->dstRect),
+                                          rd->srcRes,
+                                          &(rd->srcRect),
+                                          DISPMANX_PROTECTION_NONE,
+                                          &alpha,
+                                          NULL,
+                                          VC_IMAGE_ROT0);
+
+    vc_dispmanx_update_submit_sync(update);
+
+    rd->frames = 0;
+    rd->totalFrameTime = 0;
+    rd->maxFrameTime = 0;
 }
 
 //-------------------------------------------------------------------------
@@ -117,6 +499,10 @@ void
 destroyResizeDispmanX(
     RESIZE_DISPMANX_T *rd)
 {
+    DISPMANX_UPDATE_HANDLE_T update = vc_dispmanx_update_start(0);
+    vc_dispmanx_element_remove(update, rd->element);
+    vc_dispmanx_update_submit_sync(update);
+
     vc_dispmanx_display_close(rd->display);
     vc_dispmanx_resource_delete(rd->srcRes);
     vc_dispmanx_resource_delete(rd->dstRes);
@@ -132,36 +518,17 @@ resizeDispmanX(
     void *src,
     int16_t sPitch)
 {
-    void *tmp = malloc(rd->sourceHeight * sPitch);
-    memcpy(tmp, src, rd->sourceHeight * sPitch);
+    struct timeval start_time;
+    gettimeofday(&start_time, NULL);
 
     vc_dispmanx_resource_write_data(rd->srcRes,
                                     rd->type,
                                     sPitch,
-                                    tmp,
+                                    src,
                                     &(rd->bmpRect));
 
-    VC_DISPMANX_ALPHA_T alpha;
-
-    alpha.mask = DISPMANX_NO_HANDLE;
-    alpha.flags = DISPMANX_FLAGS_ALPHA_FROM_SOURCE
-                | DISPMANX_FLAGS_ALPHA_MIX;
-    alpha.opacity = 255;
-
     DISPMANX_UPDATE_HANDLE_T update = vc_dispmanx_update_start(0);
-
-    DISPMANX_ELEMENT_HANDLE_T element;
-    element = vc_dispmanx_element_add(update,
-                                      rd->display,
-                                      0,
-                                      &(rd->dstRect),
-                                      rd->srcRes,
-                                      &(rd->srcRect),
-                                      DISPMANX_PROTECTION_NONE,
-                                      &alpha,
-                                      NULL,
-                                      VC_IMAGE_ROT0);
-
+    vc_dispmanx_element_modified(update, rd->element, &(rd->dstRect));
     vc_dispmanx_update_submit_sync(update);
 
     vc_dispmanx_resource_read_data(rd->dstRes,
@@ -169,10 +536,12 @@ resizeDispmanX(
                                    dst,
                                    dPitch);
 
-    vc_dispmanx_element_remove(update, element);
-
-    free(tmp);
+    recordFrameTime(rd, &start_time);
 }
 
 //-------------------------------------------------------------------------
 
+#endif
+
+//-------------------------------------------------------------------------
+
@@ -33,9 +33,29 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#if defined(RESIZE_DISPMANX_SOFTWARE)
+#include "workerPool.h"
+#else
 #include "bcm_host.h"
+#endif
 
 //-------------------------------------------------------------------------
+//
+// Resize RGB565 with the GPU by composing an element, showing the source
+// resource, onto an offscreen display. The element is added once by
+// initResizeDispmanX.
+//
+// Where there is no GPU interface (/opt/vc), build with
+// RESIZE_DISPMANX_SOFTWARE defined. Each destination pixel is then the
+// average of the source pixels it covers (with the box filter when the
+// source is 2, 3 or 4 times the size), and the rows are split between
+// the threads of a worker pool. The structure must not be moved once it
+// has been initialised.
+//
+// Each call to resizeDispmanX is counted in frames, and the time it took
+// (in microseconds) is added to totalFrameTime and kept in maxFrameTime
+// if it is the longest so far.
+//
 
 typedef struct
 {
@@ -45,13 +65,27 @@ typedef struct
     int16_t sourceHeight;
     int32_t xRatio;
     int32_t yRatio;
-	VC_IMAGE_TYPE_T type;
+#if defined(RESIZE_DISPMANX_SOFTWARE)
+    int16_t *xStart;
+    int16_t *xSize;
+    int16_t *yStart;
+    int16_t *ySize;
+    uint32_t *reciprocal;
+    int16_t boxFactor;
+    WORKER_POOL_T pool;
+#else
+    VC_IMAGE_TYPE_T type;
     DISPMANX_RESOURCE_HANDLE_T dstRes;
     DISPMANX_RESOURCE_HANDLE_T srcRes;
     DISPMANX_DISPLAY_HANDLE_T display;
     VC_RECT_T bmpRect;
     VC_RECT_T srcRect;
     VC_RECT_T dstRect;
+    DISPMANX_ELEMENT_HANDLE_T element;
+#endif
+    uint32_t frames;
+    uint64_t totalFrameTime;
+    uint32_t maxFrameTime;
 } RESIZE_DISPMANX_T;
 
 //-------------------------------------------------------------------------
@@ -0,0 +1,499 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "image.h"
+#include "rotate.h"
+
+//-------------------------------------------------------------------------
+//
+// 8x8 tiles are transposed within 32x32 blocks, so a block of the source
+// and destination (2KB each) stays in the L1 cache and every cache line
+// of the destination is filled before moving on.
+//
+
+#define ROTATE_TILE 8
+#define ROTATE_BLOCK 32
+
+//-------------------------------------------------------------------------
+
+static void
+transposeTile(
+    uint8_t *dst,
+    int32_t dPitch,
+    const uint8_t *src,
+    int32_t sPitch)
+{
+#if defined(__ARM_NEON)
+
+    uint16x8_t r0 = vld1q_u16((const uint16_t *)(src));
+    uint16x8_t r1 = vld1q_u16((const uint16_t *)(src + sPitch));
+    uint16x8_t r2 = vld1q_u16((const uint16_t *)(src + 2 * sPitch));
+    uint16x8_t r3 = vld1q_u16((const uint16_t *)(src + 3 * sPitch));
+    uint16x8_t r4 = vld1q_u16((const uint16_t *)(src + 4 * sPitch));
+    uint16x8_t r5 = vld1q_u16((const uint16_t *)(src + 5 * sPitch));
+    uint16x8_t r6 = vld1q_u16((const uint16_t *)(src + 6 * sPitch));
+    uint16x8_t r7 = vld1q_u16((const uint16_t *)(src + 7 * sPitch));
+
+    // swap 16 bit elements of each pair of rows ...
+
+    uint16x8x2_t t01 = vtrnq_u16(r0, r1);
+    uint16x8x2_t t23 = vtrnq_u16(r2, r3);
+    uint16x8x2_t t45 = vtrnq_u16(r4, r5);
+    uint16x8x2_t t67 = vtrnq_u16(r6, r7);
+
+    // ... then 32 bit elements of each pair of pairs ...
+
+    uint32x4x2_t u02 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[0]),
+                                 vreinterpretq_u32_u16(t23.val[0]));
+    uint32x4x2_t u13 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[1]),
+                                 vreinterpretq_u32_u16(t23.val[1]));
+    uint32x4x2_t u46 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[0]),
+                                 vreinterpretq_u32_u16(t67.val[0]));
+    uint32x4x2_t u57 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[1]),
+                                 vreinterpretq_u32_u16(t67.val[1]));
+
+    // ... and finally the 64 bit halves of the top and bottom four rows.
+
+    vst1q_u16((uint16_t *)(dst),
+              vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u02.val[0]),
+                                                 vget_low_u32(u46.val[0]))));
+    vst1q_u16((uint16_t *)(dst + dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u13.val[0]),
+                                                 vget_low_u32(u57.val[0]))));
+    vst1q_u16((uint16_t *)(dst + 2 * dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u02.val[1]),
+                                                 vget_low_u32(u46.val[1]))));
+    vst1q_u16((uint16_t *)(dst + 3 * dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u13.val[1]),
+                                                 vget_low_u32(u57.val[1]))));
+    vst1q_u16((uint16_t *)(dst + 4 * dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u02.val[0]),
+                                                 vget_high_u32(u46.val[0]))));
+    vst1q_u16((uint16_t *)(dst + 5 * dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u13.val[0]),
+                                                 vget_high_u32(u57.val[0]))));
+    vst1q_u16((uint16_t *)(dst + 6 * dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u02.val[1]),
+                                                 vget_high_u32(u46.val[1]))));
+    vst1q_u16((uint16_t *)(dst + 7 * dPitch),
+              vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u13.val[1]),
+                                                 vget_high_u32(u57.val[1]))));
+
+#elif defined(__SSE2__)
+
+    __m128i r0 = _mm_loadu_si128((const __m128i *)(src));
+    __m128i r1 = _mm_loadu_si128((const __m128i *)(src + sPitch));
+    __m128i r2 = _mm_loadu_si128((const __m128i *)(src + 2 * sPitch));
+    __m128i r3 = _mm_loadu_si128((const __m128i *)(src + 3 * sPitch));
+    __m128i r4 = _mm_loadu_si128((const __m128i *)(src + 4 * sPitch));
+    __m128i r5 = _mm_loadu_si128((const __m128i *)(src + 5 * sPitch));
+    __m128i r6 = _mm_loadu_si128((const __m128i *)(src + 6 * sPitch));
+    __m128i r7 = _mm_loadu_si128((const __m128i *)(src + 7 * sPitch));
+
+    // interleave 16 bit elements of each pair of rows ...
+
+    __m128i a = _mm_unpacklo_epi16(r0, r1);
+    __m128i b = _mm_unpackhi_epi16(r0, r1);
+    __m128i c = _mm_unpacklo_epi16(r2, r3);
+    __m128i d = _mm_unpackhi_epi16(r2, r3);
+    __m128i e = _mm_unpacklo_epi16(r4, r5);
+    __m128i f = _mm_unpackhi_epi16(r4, r5);
+    __m128i g = _mm_unpacklo_epi16(r6, r7);
+    __m128i h = _mm_unpackhi_epi16(r6, r7);
+
+    // ... then 32 bit elements of each pair of pairs ...
+
+    __m128i ac0 = _mm_unpacklo_epi32(a, c);
+    __m128i ac1 = _mm_unpackhi_epi32(a, c);
+    __m128i bd0 = _mm_unpacklo_epi32(b, d);
+    __m128i bd1 = _mm_unpackhi_epi32(b, d);
+    __m128i eg0 = _mm_unpacklo_epi32(e, g);
+    __m128i eg1 = _mm_unpackhi_epi32(e, g);
+    __m128i fh0 = _mm_unpacklo_epi32(f, h);
+    __m128i fh1 = _mm_unpackhi_epi32(f, h);
+
+    // ... and finally the 64 bit halves of the top and bottom four rows.
+
+    _mm_storeu_si128((__m128i *)(dst), _mm_unpacklo_epi64(ac0, eg0));
+    _mm_storeu_si128((__m128i *)(dst + dPitch),
+                     _mm_unpackhi_epi64(ac0, eg0));
+    _mm_storeu_si128((__m128i *)(dst + 2 * dPitch),
+                     _mm_unpacklo_epi64(ac1, eg1));
+    _mm_storeu_si128((__m128i *)(dst + 3 * dPitch),
+                     _mm_unpackhi_epi64(ac1, eg1));
+    _mm_storeu_si128((__m128i *)(dst + 4 * dPitch),
+                     _mm_unpacklo_epi64(bd0, fh0));
+    _mm_storeu_si128((__m128i *)(dst + 5 * dPitch),
+                     _mm_unpackhi_epi64(bd0, fh0));
+    _mm_storeu_si128((__m128i *)(dst + 6 * dPitch),
+                     _mm_unpacklo_epi64(bd1, fh1));
+    _mm_storeu_si128((__m128i *)(dst + 7 * dPitch),
+                     _mm_unpackhi_epi64(bd1, fh1));
+
+#else
+
+    int16_t j;
+    for (j = 0 ; j < ROTATE_TILE ; j++)
+    {
+        const uint16_t *row = (const uint16_t *)(src + (j * sPitch));
+
+        int16_t i;
+        for (i = 0 ; i < ROTATE_TILE ; i++)
+        {
+            ((uint16_t *)(dst + (i * dPitch)))[j] = row[i];
+        }
+    }
+
+#endif
+}
+
+//-------------------------------------------------------------------------
+//
+// dst(x, y) = src(y, x). Either pitch may be negative, which is how the
+// 90 and 270 degree rotations are made from the one transpose.
+//
+
+static void
+transposeRGB565(
+    uint8_t *dst,
+    int32_t dPitch,
+    const uint8_t *src,
+    int32_t sPitch,
+    int16_t width,
+    int16_t height)
+{
+    int16_t tiledWidth = width & ~(ROTATE_TILE - 1);
+    int16_t tiledHeight = height & ~(ROTATE_TILE - 1);
+
+    int16_t by;
+    for (by = 0 ; by < tiledHeight ; by += ROTATE_BLOCK)
+    {
+        int16_t byEnd = by + ROTATE_BLOCK;
+
+        if (byEnd > tiledHeight)
+        {
+            byEnd = tiledHeight;
+        }
+
+        int16_t bx;
+        for (bx = 0 ; bx < tiledWidth ; bx += ROTATE_BLOCK)
+        {
+            int16_t bxEnd = bx + ROTATE_BLOCK;
+
+            if (bxEnd > tiledWidth)
+            {
+                bxEnd = tiledWidth;
+            }
+
+            int16_t ty;
+            for (ty = by ; ty < byEnd ; ty += ROTATE_TILE)
+            {
+                int16_t tx;
+                for (tx = bx ; tx < bxEnd ; tx += ROTATE_TILE)
+                {
+                    transposeTile(dst + (ty * sizeof(uint16_t))
+                                      + (tx * dPitch),
+                                  dPitch,
+                                  src + (tx * sizeof(uint16_t))
+                                      + (ty * sPitch),
+                                  sPitch);
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //
+    // Whatever is left over on the right and bottom edges.
+    //
+
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        const uint16_t *row = (const uint16_t *)(src + (j * sPitch));
+        int16_t i = (j < tiledHeight) ? tiledWidth : 0;
+
+        for ( ; i < width ; i++)
+        {
+            ((uint16_t *)(dst + (i * dPitch)))[j] = row[i];
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+reverseRow(
+    uint16_t *dst,
+    const uint16_t *src,
+    int16_t width)
+{
+    int16_t i = 0;
+
+#if defined(__ARM_NEON)
+
+    for ( ; (i + 8) <= width ; i += 8)
+    {
+        uint16x8_t pixels = vrev64q_u16(vld1q_u16(src + i));
+
+        vst1q_u16(dst + width - i - 8,
+                  vcombine_u16(vget_high_u16(pixels),
+                               vget_low_u16(pixels)));
+    }
+
+#elif defined(__SSE2__)
+
+    for ( ; (i + 8) <= width ; i += 8)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+
+        pixels = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+        pixels = _mm_shufflehi_epi16(pixels, _MM_SHUFFLE(0, 1, 2, 3));
+        pixels = _mm_shuffle_epi32(pixels, _MM_SHUFFLE(1, 0, 3, 2));
+
+        _mm_storeu_si128((__m128i *)(dst + width - i - 8), pixels);
+    }
+
+#endif
+
+    for ( ; i < width ; i++)
+    {
+        dst[width - i - 1] = src[i];
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+rotate90RGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height)
+{
+    // transpose the source read from the bottom row up
+
+    transposeRGB565(dst,
+                    dPitch,
+                    src + ((height - 1) * sPitch),
+                    -sPitch,
+                    width,
+                    height);
+}
+
+//-------------------------------------------------------------------------
+
+void
+rotate180RGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height)
+{
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        reverseRow(dst + ((height - 1 - j) * dPitch),
+                   src + (j * sPitch),
+                   width);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+rotate270RGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height)
+{
+    // transpose into the destination written from the bottom row up
+
+    transposeRGB565(dst + ((width - 1) * dPitch),
+                    -dPitch,
+                    src,
+                    sPitch,
+                    width,
+                    height);
+}
+
+//-------------------------------------------------------------------------
+
+void
+flipHorizontalRGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height)
+{
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        reverseRow(dst + (j * dPitch), src + (j * sPitch), width);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+flipVerticalRGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height)
+{
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        memcpy(dst + ((height - 1 - j) * dPitch),
+               src + (j * sPitch),
+               width * sizeof(uint16_t));
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+rotateImage(
+    IMAGE_T *dst,
+    const IMAGE_T *src,
+    ROTATE_T rotate)
+{
+    bool swap = (rotate == ROTATE_90) || (rotate == ROTATE_270);
+
+    int16_t width = (swap) ? src->height : src->width;
+    int16_t height = (swap) ? src->width : src->height;
+
+    if ((dst->width != width) || (dst->height != height))
+    {
+        return false;
+    }
+
+    if (dst->buffer == src->buffer)
+    {
+        return false;
+    }
+
+    int16_t dPitch = dst->width * sizeof(uint16_t);
+    int16_t sPitch = src->width * sizeof(uint16_t);
+
+    switch (rotate)
+    {
+    case ROTATE_90:
+
+        rotate90RGB565(dst->buffer,
+                       dPitch,
+                       src->buffer,
+                       sPitch,
+                       src->width,
+                       src->height);
+
+        break;
+
+    case ROTATE_180:
+
+        rotate180RGB565(dst->buffer,
+                        dPitch,
+                        src->buffer,
+                        sPitch,
+                        src->width,
+                        src->height);
+
+        break;
+
+    case ROTATE_270:
+
+        rotate270RGB565(dst->buffer,
+                        dPitch,
+                        src->buffer,
+                        sPitch,
+                        src->width,
+                        src->height);
+
+        break;
+
+    case ROTATE_FLIP_HORIZONTAL:
+
+        flipHorizontalRGB565(dst->buffer,
+                             dPitch,
+                             src->buffer,
+                             sPitch,
+                             src->width,
+                             src->height);
+
+        break;
+
+    case ROTATE_FLIP_VERTICAL:
+
+        flipVerticalRGB565(dst->buffer,
+                           dPitch,
+                           src->buffer,
+                           sPitch,
+                           src->width,
+                           src->height);
+
+        break;
+
+    default:
+
+        memcpy(dst->buffer, src->buffer, src->size);
+
+        break;
+    }
+
+    dst->byteOrder = src->byteOrder;
+    damageImage(dst, 0, 0, dst->width, dst->height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
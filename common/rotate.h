@@ -0,0 +1,121 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef ROTATE_H
+#define ROTATE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// Rotations (clockwise) and flips of RGB565 pixels. The 90 and 270 degree
+// rotations are transposes done in cache sized blocks of 8x8 tiles, each
+// tile transposed in registers when NEON or SSE2 is available. Width and
+// height are those of the source, pitches are in bytes. The source and
+// destination must not overlap.
+//
+
+typedef enum
+{
+    ROTATE_0,
+    ROTATE_90,
+    ROTATE_180,
+    ROTATE_270,
+    ROTATE_FLIP_HORIZONTAL,
+    ROTATE_FLIP_VERTICAL
+} ROTATE_T;
+
+//-------------------------------------------------------------------------
+
+void
+rotate90RGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height);
+
+void
+rotate180RGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height);
+
+void
+rotate270RGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height);
+
+void
+flipHorizontalRGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height);
+
+void
+flipVerticalRGB565(
+    void *dst,
+    int16_t dPitch,
+    const void *src,
+    int16_t sPitch,
+    int16_t width,
+    int16_t height);
+
+//-------------------------------------------------------------------------
+//
+// The destination image must already be initialized to the rotated size
+// (width and height swapped for 90 and 270 degrees). It takes on the
+// byte order of the source.
+//
+
+bool
+rotateImage(
+    IMAGE_T *dst,
+    const IMAGE_T *src,
+    ROTATE_T rotate);
+
+//-------------------------------------------------------------------------
+
+#endif
+
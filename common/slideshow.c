@@ -0,0 +1,186 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "image.h"
+#include "key.h"
+#include "lcd.h"
+#include "pixelPipeline.h"
+#include "rotate.h"
+#include "slideshow.h"
+#include "transition.h"
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+
+bool
+needsRotation(
+    int32_t imageWidth,
+    int32_t imageHeight,
+    int32_t width,
+    int32_t height)
+{
+    if ((imageWidth == imageHeight) || (width == height))
+    {
+        return false;
+    }
+
+    return (imageWidth > imageHeight) != (width > height);
+}
+
+//-------------------------------------------------------------------------
+
+bool
+waitForEscape(
+    int delay)
+{
+    int c = 0;
+    int32_t ticks = delay * 10;
+
+    while ((delay < 0) || (ticks-- > 0))
+    {
+        usleep(100000);
+
+        if (keyPressed(&c) && (c == 27))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------
+
+void
+showTransition(
+    LCD_T *lcd,
+    TRANSITION_T transition,
+    const IMAGE_T *from,
+    IMAGE_T *to,
+    IMAGE_T *frame)
+{
+    if (transition != TRANSITION_NONE)
+    {
+        uint8_t step;
+        for (step = 1 ; step < TRANSITION_STEPS ; step++)
+        {
+            transitionFrame(transition, step, from, to, frame);
+            putImageLcd(lcd, 0, 0, frame);
+        }
+    }
+
+    putImageLcd(lcd, 0, 0, to);
+}
+
+//-------------------------------------------------------------------------
+
+void
+fitSlide(
+    IMAGE_T *slide,
+    const IMAGE_T *image,
+    bool autorotate,
+    bool enlarge,
+    WORKER_POOL_T *pool)
+{
+    IMAGE_T rotated;
+
+    if (autorotate &&
+        needsRotation(image->width,
+                      image->height,
+                      slide->width,
+                      slide->height))
+    {
+        initImage(&rotated, image->height, image->width, false);
+        rotateImage(&rotated, image, ROTATE_90);
+
+        image = &rotated;
+    }
+
+    clearImageRGB565(slide, packRGB565(0, 0, 0));
+
+    bool larger = (image->width > slide->width) ||
+                  (image->height > slide->height);
+
+    bool smaller = (image->width < slide->width) &&
+                   (image->height < slide->height);
+
+    if (larger || (enlarge && smaller))
+    {
+        PIXEL_PIPELINE_T pipeline;
+
+        initPixelPipeline(&pipeline,
+                          PIXEL_FORMAT_RGB565,
+                          slide->byteOrder,
+                          false,
+                          slide->width,
+                          slide->height,
+                          image->width,
+                          image->height,
+                          true);
+
+        int16_t x = (slide->width - pipeline.nn.destinationWidth) / 2;
+        int16_t y = (slide->height - pipeline.nn.destinationHeight) / 2;
+
+        pixelPipelineThreaded(&pipeline,
+                              pool,
+                              slide->buffer + x + (y * slide->width),
+                              slide->width * sizeof(uint16_t),
+                              image->buffer,
+                              image->width * sizeof(uint16_t));
+
+        damageImage(slide,
+                    x,
+                    y,
+                    pipeline.nn.destinationWidth,
+                    pipeline.nn.destinationHeight);
+
+        destroyPixelPipeline(&pipeline);
+    }
+    else
+    {
+        blitImage(slide,
+                  (slide->width - image->width) / 2,
+                  (slide->height - image->height) / 2,
+                  image,
+                  0,
+                  0,
+                  image->width,
+                  image->height);
+    }
+
+    if (image == &rotated)
+    {
+        destroyImage(&rotated);
+    }
+}
+
+//-------------------------------------------------------------------------
+
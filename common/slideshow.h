@@ -0,0 +1,89 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#ifndef SLIDESHOW_H
+#define SLIDESHOW_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+#include "lcd.h"
+#include "transition.h"
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+//
+// The parts of a slideshow shared by png2mztx and jpg2mztx.
+//
+
+// A portrait image on a landscape display (or the reverse) fills more of
+// the display when rotated.
+
+bool
+needsRotation(
+    int32_t imageWidth,
+    int32_t imageHeight,
+    int32_t width,
+    int32_t height);
+
+// Returns true if escape is pressed before the delay (in seconds) is up.
+// A negative delay waits for escape.
+
+bool
+waitForEscape(
+    int delay);
+
+// Send each frame of the transition to the LCD as fast as SPI allows.
+
+void
+showTransition(
+    LCD_T *lcd,
+    TRANSITION_T transition,
+    const IMAGE_T *from,
+    IMAGE_T *to,
+    IMAGE_T *frame);
+
+// Clear the slide to black and fit the image into it, centred. With
+// autorotate the image is first rotated if needsRotation says so. An
+// image larger than the slide is scaled down, keeping its aspect ratio,
+// with the rows split between the threads of pool. A smaller image is
+// only scaled up if enlarge is true.
+
+void
+fitSlide(
+    IMAGE_T *slide,
+    const IMAGE_T *image,
+    bool autorotate,
+    bool enlarge,
+    WORKER_POOL_T *pool);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,467 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+
+#include "image.h"
+#include "sprite.h"
+
+//-------------------------------------------------------------------------
+//
+// Premultiplying rounds down, so that adding a background scaled by the
+// remaining alpha (rounded to nearest) can never overflow a field.
+//
+
+static uint16_t
+premultiplyRGB565(
+    uint16_t pixel,
+    uint8_t alpha)
+{
+    return packSpreadRGB565((spreadRGB565(pixel) * alpha)
+                            >> RGB565_FADE_BITS);
+}
+
+//-------------------------------------------------------------------------
+
+static inline uint16_t
+blendPremultipliedRGB565(
+    uint16_t background,
+    uint16_t premultiplied,
+    uint8_t alpha)
+{
+    uint32_t scaled = (spreadRGB565(background)
+                       * (RGB565_FADE_STEPS - alpha))
+                    + RGB565_SPREAD_ROUND;
+
+    return packSpreadRGB565(scaled >> RGB565_FADE_BITS) + premultiplied;
+}
+
+//-------------------------------------------------------------------------
+
+static uint16_t *
+addRun(
+    uint16_t *runs,
+    uint16_t type,
+    int16_t length,
+    const uint16_t *pixels,
+    const uint8_t *alphas)
+{
+    while (length > 0)
+    {
+        int16_t count = length;
+
+        if (count > SPRITE_RUN_LENGTH_MASK)
+        {
+            count = SPRITE_RUN_LENGTH_MASK;
+        }
+
+        *runs++ = type | count;
+
+        if (type != SPRITE_RUN_TRANSPARENT)
+        {
+            memcpy(runs, pixels, count * sizeof(uint16_t));
+            runs += count;
+            pixels += count;
+        }
+
+        if (type == SPRITE_RUN_BLENDED)
+        {
+            int16_t words = (count + 1) / 2;
+
+            runs[words - 1] = 0;
+            memcpy(runs, alphas, count);
+            runs += words;
+            alphas += count;
+        }
+
+        length -= count;
+    }
+
+    return runs;
+}
+
+//-------------------------------------------------------------------------
+//
+// Encode one row given the type of each pixel. The pixels of blended runs
+// must already be premultiplied.
+//
+
+static uint16_t *
+encodeRow(
+    uint16_t *runs,
+    const uint16_t *types,
+    const uint16_t *pixels,
+    const uint8_t *alphas,
+    int16_t width)
+{
+    int16_t last = width;
+
+    while ((last > 0) && (types[last - 1] == SPRITE_RUN_TRANSPARENT))
+    {
+        --last;
+    }
+
+    int16_t i = 0;
+    while (i < last)
+    {
+        int16_t start = i;
+        uint16_t type = types[i];
+
+        while ((i < last) && (types[i] == type))
+        {
+            ++i;
+        }
+
+        runs = addRun(runs,
+                      type,
+                      i - start,
+                      pixels + start,
+                      alphas + start);
+    }
+
+    return runs;
+}
+
+//-------------------------------------------------------------------------
+
+static bool
+allocateSprite(
+    SPRITE_T *sprite,
+    int16_t width,
+    int16_t height)
+{
+    sprite->width = width;
+    sprite->height = height;
+
+    // Worst case is alternating single pixel blended and transparent
+    // runs: a header, a pixel and an alpha word for each pixel.
+
+    sprite->rows = malloc((height + 1) * sizeof(uint32_t));
+    sprite->runs = malloc(width * height * 3 * sizeof(uint16_t));
+
+    if ((sprite->rows == NULL) || (sprite->runs == NULL))
+    {
+        perror("sprite: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+finishSprite(
+    SPRITE_T *sprite,
+    uint16_t *runs)
+{
+    sprite->rows[sprite->height] = runs - sprite->runs;
+    sprite->size = runs - sprite->runs;
+
+    uint16_t *shrunk = realloc(sprite->runs,
+                               (sprite->size + 1) * sizeof(uint16_t));
+
+    if (shrunk != NULL)
+    {
+        sprite->runs = shrunk;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initSpriteColourKey(
+    SPRITE_T *sprite,
+    const IMAGE_T *image,
+    uint16_t key)
+{
+    allocateSprite(sprite, image->width, image->height);
+
+    uint16_t *types = malloc(image->width * sizeof(uint16_t));
+    uint16_t *pixels = malloc(image->width * sizeof(uint16_t));
+
+    if ((types == NULL) || (pixels == NULL))
+    {
+        perror("sprite: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    //---------------------------------------------------------------------
+
+    uint16_t *runs = sprite->runs;
+
+    int16_t j;
+    for (j = 0 ; j < image->height ; j++)
+    {
+        sprite->rows[j] = runs - sprite->runs;
+
+        int16_t i;
+        for (i = 0 ; i < image->width ; i++)
+        {
+            getPixelRGB565((IMAGE_T *)image, i, j, &(pixels[i]));
+
+            types[i] = (pixels[i] == key) ? SPRITE_RUN_TRANSPARENT
+                                          : SPRITE_RUN_OPAQUE;
+        }
+
+        runs = encodeRow(runs, types, pixels, NULL, image->width);
+    }
+
+    finishSprite(sprite, runs);
+
+    free(types);
+    free(pixels);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initSpriteRGBA(
+    SPRITE_T *sprite,
+    const uint8_t *pixels,
+    int16_t width,
+    int16_t height,
+    int32_t pitch,
+    int16_t bytesPerPixel)
+{
+    if ((bytesPerPixel != 3) && (bytesPerPixel != 4))
+    {
+        return false;
+    }
+
+    allocateSprite(sprite, width, height);
+
+    uint16_t *types = malloc(width * sizeof(uint16_t));
+    uint16_t *colours = malloc(width * sizeof(uint16_t));
+    uint8_t *alphas = malloc(width);
+
+    if ((types == NULL) || (colours == NULL) || (alphas == NULL))
+    {
+        perror("sprite: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    //---------------------------------------------------------------------
+
+    uint16_t *runs = sprite->runs;
+
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        sprite->rows[j] = runs - sprite->runs;
+
+        const uint8_t *row = pixels + (j * pitch);
+
+        int16_t i;
+        for (i = 0 ; i < width ; i++)
+        {
+            const uint8_t *pixel = row + (i * bytesPerPixel);
+            uint8_t alpha = RGB565_FADE_STEPS;
+
+            if (bytesPerPixel == 4)
+            {
+                alpha = ((pixel[3] * RGB565_FADE_STEPS) + 127) / 255;
+            }
+
+            colours[i] = packRGB565(pixel[0], pixel[1], pixel[2]);
+            alphas[i] = alpha;
+
+            if (alpha == 0)
+            {
+                types[i] = SPRITE_RUN_TRANSPARENT;
+            }
+            else if (alpha == RGB565_FADE_STEPS)
+            {
+                types[i] = SPRITE_RUN_OPAQUE;
+            }
+            else
+            {
+                types[i] = SPRITE_RUN_BLENDED;
+                colours[i] = premultiplyRGB565(colours[i], alpha);
+            }
+        }
+
+        runs = encodeRow(runs, types, colours, alphas, width);
+    }
+
+    finishSprite(sprite, runs);
+
+    free(types);
+    free(colours);
+    free(alphas);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+blitSprite(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    const SPRITE_T *sprite)
+{
+    int16_t jStart = 0;
+    int16_t jEnd = sprite->height;
+
+    if (y < 0)
+    {
+        jStart = -y;
+    }
+
+    if ((y + jEnd) > image->height)
+    {
+        jEnd = image->height - y;
+    }
+
+    if ((jStart >= jEnd) ||
+        ((x + sprite->width) <= 0) ||
+        (x >= image->width))
+    {
+        return false;
+    }
+
+    bool swap = (image->byteOrder == IMAGE_BYTE_ORDER_BIG_ENDIAN);
+
+    int16_t j;
+    for (j = jStart ; j < jEnd ; j++)
+    {
+        const uint16_t *run = sprite->runs + sprite->rows[j];
+        const uint16_t *end = sprite->runs + sprite->rows[j + 1];
+
+        uint16_t *row = image->buffer + ((y + j) * image->width);
+
+        int16_t i = x;
+
+        while ((run < end) && (i < image->width))
+        {
+            uint16_t type = *run & SPRITE_RUN_TYPE_MASK;
+            int16_t length = *run & SPRITE_RUN_LENGTH_MASK;
+
+            ++run;
+
+            if (type != SPRITE_RUN_TRANSPARENT)
+            {
+                const uint16_t *pixels = run;
+                const uint8_t *alphas = (const uint8_t *)(run + length);
+                int16_t start = i;
+                int16_t count = length;
+
+                if (start < 0)
+                {
+                    pixels -= start;
+                    alphas -= start;
+                    count += start;
+                    start = 0;
+                }
+
+                if ((start + count) > image->width)
+                {
+                    count = image->width - start;
+                }
+
+                if ((type == SPRITE_RUN_OPAQUE) && (count > 0))
+                {
+                    if (swap)
+                    {
+                        htonsRGB565(row + start, pixels, count);
+                    }
+                    else
+                    {
+                        memcpy(row + start,
+                               pixels,
+                               count * sizeof(uint16_t));
+                    }
+                }
+                else if (type == SPRITE_RUN_BLENDED)
+                {
+                    uint16_t *dst = row + start;
+
+                    int16_t k;
+                    for (k = 0 ; k < count ; k++)
+                    {
+                        uint16_t background = dst[k];
+
+                        if (swap)
+                        {
+                            background = ntohs(background);
+                        }
+
+                        uint16_t blended =
+                            blendPremultipliedRGB565(background,
+                                                     pixels[k],
+                                                     alphas[k]);
+
+                        dst[k] = (swap) ? htons(blended) : blended;
+                    }
+                }
+
+                run += length;
+
+                if (type == SPRITE_RUN_BLENDED)
+                {
+                    run += (length + 1) / 2;
+                }
+            }
+
+            i += length;
+        }
+    }
+
+    damageImage(image, x, y + jStart, sprite->width, jEnd - jStart);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroySprite(
+    SPRITE_T *sprite)
+{
+    free(sprite->rows);
+    free(sprite->runs);
+
+    sprite->width = 0;
+    sprite->height = 0;
+    sprite->size = 0;
+    sprite->rows = NULL;
+    sprite->runs = NULL;
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,105 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef SPRITE_H
+#define SPRITE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// A sprite is an image with transparent areas, pre-encoded so that it can
+// be drawn many times without testing each pixel. Each row is a sequence
+// of runs. A run starts with a 16 bit header, the top two bits of which
+// give the type of the run and the remaining bits its length in pixels.
+// Opaque runs are followed by their (native byte order) pixels,
+// transparent runs carry no data. Blended runs are followed by their
+// pixels premultiplied by alpha, then their alpha values (0 to
+// RGB565_FADE_STEPS) packed two to a word. Trailing transparent runs are
+// dropped.
+//
+
+#define SPRITE_RUN_TRANSPARENT 0x0000
+#define SPRITE_RUN_OPAQUE 0x4000
+#define SPRITE_RUN_BLENDED 0x8000
+
+#define SPRITE_RUN_TYPE_MASK 0xC000
+#define SPRITE_RUN_LENGTH_MASK 0x3FFF
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    int16_t width;
+    int16_t height;
+    int32_t size;
+    uint32_t *rows;
+    uint16_t *runs;
+} SPRITE_T;
+
+//-------------------------------------------------------------------------
+
+bool
+initSpriteColourKey(
+    SPRITE_T *sprite,
+    const IMAGE_T *image,
+    uint16_t key);
+
+// Encode a sprite from 8 bit RGB or RGBA pixels (bytesPerPixel of 3 or
+// 4), with the pitch in bytes. A sprite can be cut from part of a larger
+// image (an atlas) by offsetting the pixels and passing its pitch.
+
+bool
+initSpriteRGBA(
+    SPRITE_T *sprite,
+    const uint8_t *pixels,
+    int16_t width,
+    int16_t height,
+    int32_t pitch,
+    int16_t bytesPerPixel);
+
+bool
+blitSprite(
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    const SPRITE_T *sprite);
+
+void
+destroySprite(
+    SPRITE_T *sprite);
+
+//-------------------------------------------------------------------------
+
+#endif
+
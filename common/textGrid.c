@@ -0,0 +1,597 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "draw.h"
+#include "font.h"
+#include "glyphCache.h"
+#include "image.h"
+#include "textGrid.h"
+
+//-------------------------------------------------------------------------
+//
+// A glyph number no font has, for cells whose pixels are not known.
+//
+
+#define TEXT_GRID_UNDRAWN UINT32_MAX
+
+//-------------------------------------------------------------------------
+
+static bool
+sameCell(
+    const TEXT_CELL_T *a,
+    const TEXT_CELL_T *b)
+{
+    return (a->c == b->c) &&
+           (a->foreground == b->foreground) &&
+           (a->background == b->background);
+}
+
+//-------------------------------------------------------------------------
+
+static void
+drawGridChar(
+    const TEXT_GRID_T *grid,
+    int16_t x,
+    int16_t y,
+    const TEXT_CELL_T *cell,
+    IMAGE_T *image)
+{
+    if (grid->cache != NULL)
+    {
+        drawCharCachedRGB565(x,
+                             y,
+                             cell->c,
+                             cell->foreground,
+                             cell->background,
+                             grid->font,
+                             grid->cache,
+                             image);
+    }
+    else
+    {
+        drawCharOpaqueFontRGB565(x,
+                                 y,
+                                 cell->c,
+                                 cell->foreground,
+                                 cell->background,
+                                 grid->font,
+                                 image);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initTextGrid(
+    TEXT_GRID_T *grid,
+    int16_t columns,
+    int16_t rows,
+    int16_t lineSpacing,
+    const FONT_T *font)
+{
+    grid->columns = columns;
+    grid->rows = rows;
+    grid->lineSpacing = lineSpacing;
+    grid->font = font;
+    grid->cache = NULL;
+
+    int32_t blank = findGlyphFont(font, ' ');
+    grid->blank = (blank != -1) ? blank : ' ';
+
+    grid->redraw = true;
+    grid->cursorColumn = 0;
+    grid->cursorRow = 0;
+    grid->cursorVisible = false;
+    grid->drawnCursorColumn = -1;
+    grid->drawnCursorRow = -1;
+    grid->dirtyCount = 0;
+
+    // One area for each row, and one each for erasing and drawing the
+    // cursor.
+
+    grid->cells = calloc(columns * rows, sizeof(TEXT_CELL_T));
+    grid->drawn = calloc(columns * rows, sizeof(TEXT_CELL_T));
+    grid->dirty = calloc(rows + 2, sizeof(IMAGE_DAMAGE_T));
+
+    if ((grid->cells == NULL) ||
+        (grid->drawn == NULL) ||
+        (grid->dirty == NULL))
+    {
+        perror("textGrid: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    clearTextGrid(grid, 0);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+setTextGridChar(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background)
+{
+    if ((column < 0) || (column >= grid->columns) ||
+        (row < 0) || (row >= grid->rows))
+    {
+        return false;
+    }
+
+    TEXT_CELL_T *cell = &(grid->cells[column + (row * grid->columns)]);
+
+    cell->c = c;
+    cell->foreground = foreground;
+    cell->background = background;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// Set the cells of a row from a (UTF-8) string, stopping at the end of the
+// row. Returns the column after the last character.
+//
+
+int16_t
+setTextGridString(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background)
+{
+    if (string != NULL)
+    {
+        while ((*string != '\0') && (column < grid->columns))
+        {
+            int32_t glyph = nextGlyphFont(grid->font, &string);
+
+            setTextGridChar(grid,
+                            column++,
+                            row,
+                            (glyph != -1) ? glyph : grid->blank,
+                            foreground,
+                            background);
+        }
+    }
+
+    return column;
+}
+
+//-------------------------------------------------------------------------
+//
+// Blank a row from column to its end.
+//
+
+void
+clearTextGridRow(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    uint16_t background)
+{
+    for ( ; column < grid->columns ; column++)
+    {
+        setTextGridChar(grid,
+                        column,
+                        row,
+                        grid->blank,
+                        background,
+                        background);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+clearTextGrid(
+    TEXT_GRID_T *grid,
+    uint16_t background)
+{
+    int16_t row;
+    for (row = 0 ; row < grid->rows ; row++)
+    {
+        clearTextGridRow(grid, 0, row, background);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+setTextGridCursor(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    bool visible)
+{
+    grid->cursorColumn = column;
+    grid->cursorRow = row;
+
+    grid->cursorVisible = visible &&
+                          (column >= 0) && (column < grid->columns) &&
+                          (row >= 0) && (row < grid->rows);
+}
+
+//-------------------------------------------------------------------------
+//
+// Move rows top to bottom (inclusive) of the grid up by rows, blanking
+// the rows uncovered at the bottom.
+//
+
+void
+scrollTextGridUp(
+    TEXT_GRID_T *grid,
+    int16_t top,
+    int16_t bottom,
+    int16_t rows,
+    uint16_t background)
+{
+    if (top < 0)
+    {
+        top = 0;
+    }
+
+    if (bottom >= grid->rows)
+    {
+        bottom = grid->rows - 1;
+    }
+
+    if (rows > (bottom - top + 1))
+    {
+        rows = bottom - top + 1;
+    }
+
+    if (rows <= 0)
+    {
+        return;
+    }
+
+    TEXT_CELL_T *cells = grid->cells + (top * grid->columns);
+
+    memmove(cells,
+            cells + (rows * grid->columns),
+            (bottom - top + 1 - rows) * grid->columns * sizeof(TEXT_CELL_T));
+
+    int16_t row;
+    for (row = bottom - rows + 1 ; row <= bottom ; row++)
+    {
+        clearTextGridRow(grid, 0, row, background);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+scrollTextGridDown(
+    TEXT_GRID_T *grid,
+    int16_t top,
+    int16_t bottom,
+    int16_t rows,
+    uint16_t background)
+{
+    if (top < 0)
+    {
+        top = 0;
+    }
+
+    if (bottom >= grid->rows)
+    {
+        bottom = grid->rows - 1;
+    }
+
+    if (rows > (bottom - top + 1))
+    {
+        rows = bottom - top + 1;
+    }
+
+    if (rows <= 0)
+    {
+        return;
+    }
+
+    TEXT_CELL_T *cells = grid->cells + (top * grid->columns);
+
+    memmove(cells + (rows * grid->columns),
+            cells,
+            (bottom - top + 1 - rows) * grid->columns * sizeof(TEXT_CELL_T));
+
+    int16_t row;
+    for (row = top ; row < top + rows ; row++)
+    {
+        clearTextGridRow(grid, 0, row, background);
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Forget what has been drawn, so that the next draw redraws every cell.
+// Needed if anything else has drawn over the grid's part of the image.
+//
+
+void
+invalidateTextGrid(
+    TEXT_GRID_T *grid)
+{
+    grid->redraw = true;
+    grid->drawnCursorColumn = -1;
+    grid->drawnCursorRow = -1;
+}
+
+//-------------------------------------------------------------------------
+
+void
+rollTextGrid(
+    TEXT_GRID_T *grid,
+    IMAGE_T *image,
+    int16_t y,
+    int16_t rows)
+{
+    if ((grid->redraw) || (rows <= 0) || (rows >= grid->rows))
+    {
+        return;
+    }
+
+    int16_t kept = grid->rows - rows;
+    int32_t cells = grid->columns * rows;
+
+    memmove(grid->drawn,
+            grid->drawn + cells,
+            kept * grid->columns * sizeof(TEXT_CELL_T));
+
+    // The rows that wrapped around to the bottom are not kept, so mark
+    // them as holding no glyph. They will differ from whatever is set
+    // there and be redrawn.
+
+    TEXT_CELL_T *drawn = grid->drawn + (kept * grid->columns);
+
+    int32_t index;
+    for (index = 0 ; index < cells ; index++)
+    {
+        drawn[index].c = TEXT_GRID_UNDRAWN;
+    }
+
+    //---------------------------------------------------------------------
+
+    int16_t lineHeight = grid->font->height + grid->lineSpacing;
+    uint16_t *top = image->buffer + (y * image->width);
+
+    memmove(top,
+            top + (rows * lineHeight * image->width),
+            kept * lineHeight * image->width * sizeof(uint16_t));
+
+    //---------------------------------------------------------------------
+
+    if (grid->drawnCursorRow != -1)
+    {
+        grid->drawnCursorRow -= rows;
+
+        if (grid->drawnCursorRow < 0)
+        {
+            grid->drawnCursorColumn = -1;
+            grid->drawnCursorRow = -1;
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+drawCell(
+    TEXT_GRID_T *grid,
+    const TEXT_CELL_T *cell,
+    int16_t column,
+    int16_t row,
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y)
+{
+    const FONT_T *font = grid->font;
+    IMAGE_DAMAGE_T *area = &(grid->dirty[grid->dirtyCount++]);
+
+    area->xMin = x + (column * font->width);
+    area->xMax = area->xMin + font->width - 1;
+    area->yMin = y + (row * (font->height + grid->lineSpacing));
+    area->yMax = area->yMin + font->height - 1;
+
+    drawGridChar(grid, area->xMin, area->yMin, cell, image);
+}
+
+//-------------------------------------------------------------------------
+//
+// Draw the cells that have changed, with the top left of the grid at
+// (x, y) in the image. Returns the number of areas redrawn (one for each
+// row with changes, and for the cursor); they are in grid->dirty in image
+// coordinates.
+//
+
+int16_t
+drawTextGrid(
+    TEXT_GRID_T *grid,
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y)
+{
+    const FONT_T *font = grid->font;
+    int16_t lineHeight = font->height + grid->lineSpacing;
+
+    grid->dirtyCount = 0;
+
+    //---------------------------------------------------------------------
+
+    bool cursorMoved = (grid->cursorVisible == false) ||
+                       (grid->cursorColumn != grid->drawnCursorColumn) ||
+                       (grid->cursorRow != grid->drawnCursorRow);
+
+    if (cursorMoved && (grid->drawnCursorRow != -1))
+    {
+        int16_t column = grid->drawnCursorColumn;
+        int16_t row = grid->drawnCursorRow;
+
+        drawCell(grid,
+                 &(grid->drawn[column + (row * grid->columns)]),
+                 column,
+                 row,
+                 image,
+                 x,
+                 y);
+
+        grid->drawnCursorColumn = -1;
+        grid->drawnCursorRow = -1;
+    }
+
+    bool cursorCovered = false;
+
+    //---------------------------------------------------------------------
+
+    int16_t row;
+    for (row = 0 ; row < grid->rows ; row++)
+    {
+        int16_t first = -1;
+        int16_t last = -1;
+
+        int16_t column;
+        for (column = 0 ; column < grid->columns ; column++)
+        {
+            int32_t index = column + (row * grid->columns);
+
+            TEXT_CELL_T *cell = &(grid->cells[index]);
+            TEXT_CELL_T *drawn = &(grid->drawn[index]);
+
+            if ((grid->redraw == false) && sameCell(cell, drawn))
+            {
+                continue;
+            }
+
+            drawGridChar(grid,
+                         x + (column * font->width),
+                         y + (row * lineHeight),
+                         cell,
+                         image);
+
+            *drawn = *cell;
+
+            if (first == -1)
+            {
+                first = column;
+            }
+
+            last = column;
+        }
+
+        if (first != -1)
+        {
+            IMAGE_DAMAGE_T *dirty = &(grid->dirty[grid->dirtyCount++]);
+
+            dirty->xMin = x + (first * font->width);
+            dirty->xMax = x + ((last + 1) * font->width) - 1;
+            dirty->yMin = y + (row * lineHeight);
+            dirty->yMax = dirty->yMin + font->height - 1;
+
+            if ((row == grid->cursorRow) &&
+                (grid->cursorColumn >= first) &&
+                (grid->cursorColumn <= last))
+            {
+                cursorCovered = true;
+            }
+        }
+    }
+
+    grid->redraw = false;
+
+    //---------------------------------------------------------------------
+
+    if (grid->cursorVisible && (cursorMoved || cursorCovered))
+    {
+        int16_t column = grid->cursorColumn;
+        int16_t row = grid->cursorRow;
+
+        const TEXT_CELL_T *cell = &(grid->drawn[column
+                                                + (row * grid->columns)]);
+
+        IMAGE_DAMAGE_T *area = &(grid->dirty[grid->dirtyCount++]);
+
+        area->xMin = x + (column * font->width);
+        area->xMax = area->xMin + font->width - 1;
+        area->yMax = y + (row * lineHeight) + font->height - 1;
+        area->yMin = area->yMax - ((font->height >= 8) ? 1 : 0);
+
+        // A blank cell may have the same foreground and background.
+
+        uint16_t colour = (cell->foreground != cell->background)
+                        ? cell->foreground
+                        : ~(cell->background);
+
+        drawFilledBoxRGB565(image,
+                            area->xMin,
+                            area->yMin,
+                            font->width,
+                            area->yMax - area->yMin + 1,
+                            colour);
+
+        grid->drawnCursorColumn = column;
+        grid->drawnCursorRow = row;
+    }
+
+    return grid->dirtyCount;
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyTextGrid(
+    TEXT_GRID_T *grid)
+{
+    free(grid->cells);
+    free(grid->drawn);
+    free(grid->dirty);
+
+    grid->columns = 0;
+    grid->rows = 0;
+    grid->cells = NULL;
+    grid->drawn = NULL;
+    grid->dirty = NULL;
+    grid->dirtyCount = 0;
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,177 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef TEXT_GRID_H
+#define TEXT_GRID_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "font.h"
+#include "glyphCache.h"
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// A grid of character cells that remembers what it last drew. Text is
+// set into the grid and drawTextGrid redraws only the cells that differ
+// from what is already in the image, recording for each row the area it
+// redrew, so that only those areas need be sent to the LCD.
+//
+// The cursor is not part of the cells. It is an underline drawn over the
+// cell it is on, and is erased by redrawing that cell.
+//
+// If cache is set the cells are drawn through it, which anti-aliased
+// fonts need.
+//
+// Cells hold glyph numbers. Blank cells are the font's glyph for a space,
+// which need not be glyph 0x20 in a font opened with openFont.
+//
+
+typedef struct
+{
+    uint32_t c;
+    uint16_t foreground;
+    uint16_t background;
+} TEXT_CELL_T;
+
+typedef struct
+{
+    int16_t columns;
+    int16_t rows;
+    int16_t lineSpacing;
+    const FONT_T *font;
+    uint32_t blank;
+    GLYPH_CACHE_T *cache;
+    TEXT_CELL_T *cells;
+    TEXT_CELL_T *drawn;
+    bool redraw;
+    int16_t cursorColumn;
+    int16_t cursorRow;
+    bool cursorVisible;
+    int16_t drawnCursorColumn;
+    int16_t drawnCursorRow;
+    int16_t dirtyCount;
+    IMAGE_DAMAGE_T *dirty;
+} TEXT_GRID_T;
+
+//-------------------------------------------------------------------------
+
+bool
+initTextGrid(
+    TEXT_GRID_T *grid,
+    int16_t columns,
+    int16_t rows,
+    int16_t lineSpacing,
+    const FONT_T *font);
+
+bool
+setTextGridChar(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    uint32_t c,
+    uint16_t foreground,
+    uint16_t background);
+
+int16_t
+setTextGridString(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    const char *string,
+    uint16_t foreground,
+    uint16_t background);
+
+void
+clearTextGridRow(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    uint16_t background);
+
+void
+clearTextGrid(
+    TEXT_GRID_T *grid,
+    uint16_t background);
+
+void
+setTextGridCursor(
+    TEXT_GRID_T *grid,
+    int16_t column,
+    int16_t row,
+    bool visible);
+
+void
+scrollTextGridUp(
+    TEXT_GRID_T *grid,
+    int16_t top,
+    int16_t bottom,
+    int16_t rows,
+    uint16_t background);
+
+void
+scrollTextGridDown(
+    TEXT_GRID_T *grid,
+    int16_t top,
+    int16_t bottom,
+    int16_t rows,
+    uint16_t background);
+
+void
+invalidateTextGrid(
+    TEXT_GRID_T *grid);
+
+// The image is to be scrolled up by rows, as whatever shows it has been.
+// Move the image and what has been drawn up to match, so that only cells
+// that now differ are redrawn. The rows left at the bottom are all
+// redrawn.
+
+void
+rollTextGrid(
+    TEXT_GRID_T *grid,
+    IMAGE_T *image,
+    int16_t y,
+    int16_t rows);
+
+int16_t
+drawTextGrid(
+    TEXT_GRID_T *grid,
+    IMAGE_T *image,
+    int16_t x,
+    int16_t y);
+
+void
+destroyTextGrid(
+    TEXT_GRID_T *grid);
+
+//-------------------------------------------------------------------------
+
+#endif
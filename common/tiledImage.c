@@ -0,0 +1,438 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "image.h"
+#include "tiledImage.h"
+
+//-------------------------------------------------------------------------
+
+static TILE_T *
+allocateTile(void)
+{
+    TILE_T *tile = calloc(1, sizeof(TILE_T));
+
+    if (tile == NULL)
+    {
+        perror("tiledImage: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    tile->references = 1;
+
+    return tile;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+releaseTile(
+    TILE_T *tile)
+{
+    if ((tile != NULL) && (--(tile->references) == 0))
+    {
+        free(tile);
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Return a tile that only this image refers to, copying it if it is
+// shared.
+//
+
+static TILE_T *
+writableTile(
+    TILED_IMAGE_T *image,
+    int32_t index)
+{
+    TILE_T *tile = image->tiles[index];
+
+    if (tile->references > 1)
+    {
+        TILE_T *copy = allocateTile();
+        memcpy(copy->pixels, tile->pixels, sizeof(copy->pixels));
+
+        releaseTile(tile);
+        image->tiles[index] = copy;
+        tile = copy;
+    }
+
+    return tile;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+tileArea(
+    const TILED_IMAGE_T *image,
+    int32_t index,
+    TILE_AREA_T *area)
+{
+    int16_t column = index % image->columns;
+    int16_t row = index / image->columns;
+
+    area->x = column * TILE_SIZE;
+    area->y = row * TILE_SIZE;
+    area->width = image->width - area->x;
+    area->height = image->height - area->y;
+
+    if (area->width > TILE_SIZE)
+    {
+        area->width = TILE_SIZE;
+    }
+
+    if (area->height > TILE_SIZE)
+    {
+        area->height = TILE_SIZE;
+    }
+
+    area->pixels = image->tiles[index]->pixels;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initTiledImage(
+    TILED_IMAGE_T *image,
+    int16_t width,
+    int16_t height)
+{
+    image->width = width;
+    image->height = height;
+    image->columns = (width + TILE_SIZE - 1) / TILE_SIZE;
+    image->rows = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    int32_t count = image->columns * image->rows;
+
+    image->tiles = calloc(count, sizeof(TILE_T *));
+    image->dirty = malloc(count * sizeof(bool));
+
+    if ((image->tiles == NULL) || (image->dirty == NULL))
+    {
+        perror("tiledImage: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t index;
+    for (index = 0 ; index < count ; index++)
+    {
+        image->tiles[index] = allocateTile();
+        image->dirty[index] = true;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// The snapshot shares all of the image's tiles and starts clean.
+//
+
+bool
+snapshotTiledImage(
+    TILED_IMAGE_T *snapshot,
+    const TILED_IMAGE_T *image)
+{
+    int32_t count = image->columns * image->rows;
+
+    snapshot->width = image->width;
+    snapshot->height = image->height;
+    snapshot->columns = image->columns;
+    snapshot->rows = image->rows;
+
+    snapshot->tiles = malloc(count * sizeof(TILE_T *));
+    snapshot->dirty = calloc(count, sizeof(bool));
+
+    if ((snapshot->tiles == NULL) || (snapshot->dirty == NULL))
+    {
+        perror("tiledImage: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int32_t index;
+    for (index = 0 ; index < count ; index++)
+    {
+        snapshot->tiles[index] = image->tiles[index];
+        ++(snapshot->tiles[index]->references);
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// Copy a whole frame of RGB565 pixels (pitch is in bytes) into the image.
+// Each tile is compared first, and only tiles that differ are written
+// (and copied, if shared) and marked dirty. Returns the number of tiles
+// that changed.
+//
+
+int32_t
+updateTiledImageRGB565(
+    TILED_IMAGE_T *image,
+    const void *buffer,
+    int32_t pitch)
+{
+    int32_t changed = 0;
+    int32_t index = 0;
+
+    int16_t row;
+    for (row = 0 ; row < image->rows ; row++)
+    {
+        int16_t column;
+        for (column = 0 ; column < image->columns ; column++, index++)
+        {
+            TILE_AREA_T area;
+            tileArea(image, index, &area);
+
+            const uint8_t *src = (const uint8_t *)buffer
+                               + (area.x * sizeof(uint16_t))
+                               + (area.y * pitch);
+
+            size_t length = area.width * sizeof(uint16_t);
+
+            int16_t j = 0;
+            while ((j < area.height) &&
+                   (memcmp(area.pixels + (j * TILE_SIZE),
+                           src + (j * pitch),
+                           length) == 0))
+            {
+                ++j;
+            }
+
+            if (j == area.height)
+            {
+                continue;
+            }
+
+            // Rows before j already match, so start copying from there.
+
+            uint16_t *pixels = writableTile(image, index)->pixels;
+
+            for ( ; j < area.height ; j++)
+            {
+                memcpy(pixels + (j * TILE_SIZE), src + (j * pitch), length);
+            }
+
+            image->dirty[index] = true;
+            ++changed;
+        }
+    }
+
+    return changed;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+updateTiledImage(
+    TILED_IMAGE_T *image,
+    const IMAGE_T *src)
+{
+    if ((src->width != image->width) || (src->height != image->height))
+    {
+        return false;
+    }
+
+    if (isImageBigEndian(src))
+    {
+        return false;
+    }
+
+    updateTiledImageRGB565(image,
+                           src->buffer,
+                           src->width * sizeof(uint16_t));
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+convertTiledImage(
+    const TILED_IMAGE_T *src,
+    IMAGE_T *dst)
+{
+    if ((src->width != dst->width) || (src->height != dst->height))
+    {
+        return false;
+    }
+
+    bool bigEndian = isImageBigEndian(dst);
+    int32_t count = src->columns * src->rows;
+
+    int32_t index;
+    for (index = 0 ; index < count ; index++)
+    {
+        TILE_AREA_T area;
+        tileArea(src, index, &area);
+
+        int16_t j;
+        for (j = 0 ; j < area.height ; j++)
+        {
+            uint16_t *to = dst->buffer + area.x + ((area.y + j) * dst->width);
+            const uint16_t *from = area.pixels + (j * TILE_SIZE);
+
+            if (bigEndian)
+            {
+                htonsRGB565(to, from, area.width);
+            }
+            else
+            {
+                memcpy(to, from, area.width * sizeof(uint16_t));
+            }
+        }
+    }
+
+    damageImage(dst, 0, 0, dst->width, dst->height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+isTileDirty(
+    const TILED_IMAGE_T *image,
+    int16_t column,
+    int16_t row)
+{
+    if ((column < 0) || (column >= image->columns) ||
+        (row < 0) || (row >= image->rows))
+    {
+        return false;
+    }
+
+    return image->dirty[column + (row * image->columns)];
+}
+
+//-------------------------------------------------------------------------
+//
+// Find the first dirty tile at or after *index. Start with *index at 0;
+// it is left pointing past the tile found, ready for the next call.
+//
+
+bool
+nextDirtyTile(
+    const TILED_IMAGE_T *image,
+    int32_t *index,
+    TILE_AREA_T *area)
+{
+    int32_t count = image->columns * image->rows;
+
+    while (*index < count)
+    {
+        int32_t i = (*index)++;
+
+        if (image->dirty[i])
+        {
+            tileArea(image, i, area);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//-------------------------------------------------------------------------
+//
+// As nextDirtyTile, but the area also covers the dirty tiles that follow
+// it in the same row of tiles. The tiles of a run are not contiguous, so
+// area->pixels is only the first tile's; send the run from the frame the
+// image was updated from.
+//
+
+bool
+nextDirtyRun(
+    const TILED_IMAGE_T *image,
+    int32_t *index,
+    TILE_AREA_T *area)
+{
+    if (nextDirtyTile(image, index, area) == false)
+    {
+        return false;
+    }
+
+    int16_t lastColumn = image->columns - 1;
+
+    while (((*index - 1) % image->columns != lastColumn) &&
+           image->dirty[*index])
+    {
+        TILE_AREA_T next;
+        tileArea(image, (*index)++, &next);
+
+        area->width += next.width;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+clearTiledImageDirty(
+    TILED_IMAGE_T *image)
+{
+    memset(image->dirty, 0, image->columns * image->rows * sizeof(bool));
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyTiledImage(
+    TILED_IMAGE_T *image)
+{
+    int32_t count = image->columns * image->rows;
+
+    int32_t index;
+    for (index = 0 ; index < count ; index++)
+    {
+        releaseTile(image->tiles[index]);
+    }
+
+    free(image->tiles);
+    free(image->dirty);
+
+    image->width = 0;
+    image->height = 0;
+    image->columns = 0;
+    image->rows = 0;
+    image->tiles = NULL;
+    image->dirty = NULL;
+}
+
+//-------------------------------------------------------------------------
+
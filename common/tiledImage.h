@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef TILED_IMAGE_H
+#define TILED_IMAGE_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// An RGB565 image (native byte order) held as 16x16 tiles. Tiles are
+// reference counted, so a snapshot shares every tile with the image it
+// was taken from and a tile is only copied when one of them writes to it.
+// Updating a tile with the pixels it already holds leaves it shared and
+// clean, so keeping the previous frame costs only the tiles that changed.
+// updateTiledImageRGB565 only compares and copies pixels, so it works as
+// well on big-endian pixels, as long as the tiles are sent as such.
+//
+
+#define TILE_SIZE 16
+#define TILE_PITCH (TILE_SIZE * sizeof(uint16_t))
+
+//-------------------------------------------------------------------------
+
+typedef struct
+{
+    int32_t references;
+    uint16_t pixels[TILE_SIZE * TILE_SIZE];
+} TILE_T;
+
+typedef struct
+{
+    int16_t width;
+    int16_t height;
+    int16_t columns;
+    int16_t rows;
+    TILE_T **tiles;
+    bool *dirty;
+} TILED_IMAGE_T;
+
+// Where a tile sits in the image. Tiles on the right and bottom edges may
+// be smaller than TILE_SIZE. Rows of pixels are TILE_PITCH bytes apart.
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t width;
+    int16_t height;
+    const uint16_t *pixels;
+} TILE_AREA_T;
+
+//-------------------------------------------------------------------------
+
+bool
+initTiledImage(
+    TILED_IMAGE_T *image,
+    int16_t width,
+    int16_t height);
+
+bool
+snapshotTiledImage(
+    TILED_IMAGE_T *snapshot,
+    const TILED_IMAGE_T *image);
+
+int32_t
+updateTiledImageRGB565(
+    TILED_IMAGE_T *image,
+    const void *buffer,
+    int32_t pitch);
+
+bool
+updateTiledImage(
+    TILED_IMAGE_T *image,
+    const IMAGE_T *src);
+
+bool
+convertTiledImage(
+    const TILED_IMAGE_T *src,
+    IMAGE_T *dst);
+
+bool
+isTileDirty(
+    const TILED_IMAGE_T *image,
+    int16_t column,
+    int16_t row);
+
+bool
+nextDirtyTile(
+    const TILED_IMAGE_T *image,
+    int32_t *index,
+    TILE_AREA_T *area);
+
+bool
+nextDirtyRun(
+    const TILED_IMAGE_T *image,
+    int32_t *index,
+    TILE_AREA_T *area);
+
+void
+clearTiledImageDirty(
+    TILED_IMAGE_T *image);
+
+void
+destroyTiledImage(
+    TILED_IMAGE_T *image);
+
+//-------------------------------------------------------------------------
+
+#endif
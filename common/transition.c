@@ -0,0 +1,183 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "image.h"
+#include "transition.h"
+
+//-------------------------------------------------------------------------
+
+bool
+parseTransition(
+    const char *name,
+    TRANSITION_T *transition)
+{
+    if (strcmp(name, "none") == 0)
+    {
+        *transition = TRANSITION_NONE;
+    }
+    else if (strcmp(name, "fade") == 0)
+    {
+        *transition = TRANSITION_FADE;
+    }
+    else if (strcmp(name, "wipe") == 0)
+    {
+        *transition = TRANSITION_WIPE;
+    }
+    else if (strcmp(name, "slide") == 0)
+    {
+        *transition = TRANSITION_SLIDE;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// Each row of the frame is a run of columns from one image followed by
+// the rest of the row from the other, so wipes and slides are two
+// memcpy's per row.
+//
+
+static void
+joinRows(
+    IMAGE_T *frame,
+    const IMAGE_T *left,
+    int16_t leftOffset,
+    const IMAGE_T *right,
+    int16_t rightOffset,
+    int16_t columns)
+{
+    int16_t width = frame->width;
+
+    int16_t j;
+    for (j = 0 ; j < frame->height ; j++)
+    {
+        int32_t row = j * width;
+
+        memcpy(frame->buffer + row,
+               left->buffer + row + leftOffset,
+               columns * sizeof(uint16_t));
+
+        memcpy(frame->buffer + row + columns,
+               right->buffer + row + rightOffset,
+               (width - columns) * sizeof(uint16_t));
+    }
+}
+
+//-------------------------------------------------------------------------
+
+bool
+transitionFrame(
+    TRANSITION_T transition,
+    uint8_t step,
+    const IMAGE_T *from,
+    const IMAGE_T *to,
+    IMAGE_T *frame)
+{
+    if ((from->width != to->width) ||
+        (from->height != to->height) ||
+        (from->width != frame->width) ||
+        (from->height != frame->height))
+    {
+        return false;
+    }
+
+    // The fade works on the pixel values, so all three images must hold
+    // the same byte order. Only native order is supported.
+
+    if (isImageBigEndian(from) ||
+        isImageBigEndian(to) ||
+        isImageBigEndian(frame))
+    {
+        return false;
+    }
+
+    if (step > TRANSITION_STEPS)
+    {
+        step = TRANSITION_STEPS;
+    }
+
+    int16_t columns = (frame->width * step) / TRANSITION_STEPS;
+
+    switch (transition)
+    {
+    case TRANSITION_FADE:
+
+        crossFadeRGB565(frame->buffer,
+                        from->buffer,
+                        to->buffer,
+                        step,
+                        frame->width * frame->height);
+
+        break;
+
+    case TRANSITION_WIPE:
+
+        joinRows(frame, to, 0, from, columns, columns);
+
+        break;
+
+    case TRANSITION_SLIDE:
+
+        // the new image pushes the old one out to the left
+
+        joinRows(frame,
+                 from,
+                 columns,
+                 to,
+                 0,
+                 frame->width - columns);
+
+        break;
+
+    default:
+
+        memcpy(frame->buffer,
+               (step < TRANSITION_STEPS) ? from->buffer : to->buffer,
+               frame->size);
+
+        break;
+    }
+
+    damageImage(frame, 0, 0, frame->width, frame->height);
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
@@ -0,0 +1,76 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef TRANSITION_H
+#define TRANSITION_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "image.h"
+
+//-------------------------------------------------------------------------
+//
+// A transition between two images of the same size is drawn as a
+// sequence of TRANSITION_STEPS frames. Step 0 is the first image and
+// step TRANSITION_STEPS is the second.
+//
+
+#define TRANSITION_STEPS RGB565_FADE_STEPS
+
+//-------------------------------------------------------------------------
+
+typedef enum
+{
+    TRANSITION_NONE,
+    TRANSITION_FADE,
+    TRANSITION_WIPE,
+    TRANSITION_SLIDE
+} TRANSITION_T;
+
+//-------------------------------------------------------------------------
+
+bool
+parseTransition(
+    const char *name,
+    TRANSITION_T *transition);
+
+bool
+transitionFrame(
+    TRANSITION_T transition,
+    uint8_t step,
+    const IMAGE_T *from,
+    const IMAGE_T *to,
+    IMAGE_T *frame);
+
+//-------------------------------------------------------------------------
+
+#endif
+
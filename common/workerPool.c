@@ -0,0 +1,222 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "workerPool.h"
+
+//-------------------------------------------------------------------------
+
+static void
+runBand(
+    WORKER_POOL_T *pool,
+    int16_t index,
+    WORKER_POOL_JOB_T job,
+    void *context,
+    int32_t rows)
+{
+    int32_t start = (rows * index) / pool->threads;
+    int32_t end = (rows * (index + 1)) / pool->threads;
+
+    if (start < end)
+    {
+        job(context, start, end);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void *
+worker(
+    void *arg)
+{
+    WORKER_POOL_THREAD_T *self = arg;
+    WORKER_POOL_T *pool = self->pool;
+    uint32_t generation = 0;
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    while (true)
+    {
+        while ((pool->quit == false) && (pool->generation == generation))
+        {
+            pthread_cond_wait(&(pool->start), &(pool->mutex));
+        }
+
+        if (pool->quit)
+        {
+            break;
+        }
+
+        generation = pool->generation;
+
+        WORKER_POOL_JOB_T job = pool->job;
+        void *context = pool->context;
+        int32_t rows = pool->rows;
+
+        pthread_mutex_unlock(&(pool->mutex));
+
+        runBand(pool, self->index, job, context, rows);
+
+        pthread_mutex_lock(&(pool->mutex));
+
+        if (--(pool->pending) == 0)
+        {
+            pthread_cond_signal(&(pool->finish));
+        }
+    }
+
+    pthread_mutex_unlock(&(pool->mutex));
+
+    return NULL;
+}
+
+//-------------------------------------------------------------------------
+
+bool
+initWorkerPool(
+    WORKER_POOL_T *pool,
+    int16_t threads)
+{
+    if (threads < 1)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus > 0) ? cpus : 1;
+    }
+
+    if (threads > WORKER_POOL_MAX_THREADS)
+    {
+        threads = WORKER_POOL_MAX_THREADS;
+    }
+
+    pool->threads = 1;
+    pool->generation = 0;
+    pool->pending = 0;
+    pool->quit = false;
+    pool->job = NULL;
+    pool->context = NULL;
+    pool->rows = 0;
+
+    pthread_mutex_init(&(pool->mutex), NULL);
+    pthread_cond_init(&(pool->start), NULL);
+    pthread_cond_init(&(pool->finish), NULL);
+
+    // The calling thread works on the first band, so it needs no thread
+    // of its own.
+
+    int16_t i;
+    for (i = 1 ; i < threads ; i++)
+    {
+        WORKER_POOL_THREAD_T *thread = &(pool->workers[i]);
+
+        thread->pool = pool;
+        thread->index = i;
+
+        if (pthread_create(&(thread->thread), NULL, worker, thread) != 0)
+        {
+            destroyWorkerPool(pool);
+            return false;
+        }
+
+        pool->threads = i + 1;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+
+void
+runWorkerPool(
+    WORKER_POOL_T *pool,
+    WORKER_POOL_JOB_T job,
+    void *context,
+    int32_t rows)
+{
+    if (pool->threads == 1)
+    {
+        runBand(pool, 0, job, context, rows);
+        return;
+    }
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    pool->job = job;
+    pool->context = context;
+    pool->rows = rows;
+    pool->pending = pool->threads - 1;
+    ++(pool->generation);
+
+    pthread_cond_broadcast(&(pool->start));
+    pthread_mutex_unlock(&(pool->mutex));
+
+    runBand(pool, 0, job, context, rows);
+
+    pthread_mutex_lock(&(pool->mutex));
+
+    while (pool->pending > 0)
+    {
+        pthread_cond_wait(&(pool->finish), &(pool->mutex));
+    }
+
+    pthread_mutex_unlock(&(pool->mutex));
+}
+
+//-------------------------------------------------------------------------
+
+void
+destroyWorkerPool(
+    WORKER_POOL_T *pool)
+{
+    pthread_mutex_lock(&(pool->mutex));
+    pool->quit = true;
+    pthread_cond_broadcast(&(pool->start));
+    pthread_mutex_unlock(&(pool->mutex));
+
+    int16_t i;
+    for (i = 1 ; i < pool->threads ; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_mutex_destroy(&(pool->mutex));
+    pthread_cond_destroy(&(pool->start));
+    pthread_cond_destroy(&(pool->finish));
+
+    pool->threads = 0;
+}
+
+//-------------------------------------------------------------------------
+
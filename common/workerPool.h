@@ -0,0 +1,102 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+//-------------------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//-------------------------------------------------------------------------
+//
+// A fixed set of threads, created once, that split a job into bands of
+// rows. runWorkerPool gives each thread a band (the calling thread does
+// the first) and returns when every band is finished, so a job may use
+// any data on the caller's stack. A pool must not be moved once it has
+// been initialised, as its threads hold a pointer to it.
+//
+
+#define WORKER_POOL_MAX_THREADS 8
+
+//-------------------------------------------------------------------------
+
+typedef void (*WORKER_POOL_JOB_T)(void *context, int32_t start, int32_t end);
+
+typedef struct WORKER_POOL_T_ WORKER_POOL_T;
+
+typedef struct
+{
+    WORKER_POOL_T *pool;
+    int16_t index;
+    pthread_t thread;
+} WORKER_POOL_THREAD_T;
+
+struct WORKER_POOL_T_
+{
+    int16_t threads;
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t finish;
+    uint32_t generation;
+    int16_t pending;
+    bool quit;
+    WORKER_POOL_JOB_T job;
+    void *context;
+    int32_t rows;
+    WORKER_POOL_THREAD_T workers[WORKER_POOL_MAX_THREADS];
+};
+
+//-------------------------------------------------------------------------
+
+// A threads value less than 1 uses one thread for each online CPU.
+
+bool
+initWorkerPool(
+    WORKER_POOL_T *pool,
+    int16_t threads);
+
+// Call job once for each band of rows in 0 to rows - 1. The bands are
+// contiguous and as close to equal as possible.
+
+void
+runWorkerPool(
+    WORKER_POOL_T *pool,
+    WORKER_POOL_JOB_T job,
+    void *context,
+    int32_t rows);
+
+void
+destroyWorkerPool(
+    WORKER_POOL_T *pool);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -43,6 +43,7 @@
 #include "bcm_host.h"
 
 #include "lcd.h"
+#include "rotate.h"
 #include "syslogUtilities.h"
 
 //-------------------------------------------------------------------------
@@ -215,9 +216,10 @@ main(
 
     //---------------------------------------------------------------------
     //
-    // Calling vc_dispmanx_snapshot() fails when the display is rotate
-    // either 90 or 270 degrees. It sometimes causes the program to hang.
-    // check the config to make sure the screen is not rotated.
+    // Calling vc_dispmanx_snapshot() into a landscape resource fails (and
+    // sometimes hangs) when the display is rotated either 90 or 270
+    // degrees. In that case the snapshot is taken into a resource the
+    // shape of the rotated display and rotated in software to fit the LCD.
     //
 
     char response[1024];
@@ -230,16 +232,11 @@ main(
                                   &display_rotate);
     }
 
-    // only need to check low bit of display_rotate (value of 1 or 3).
+    // the low two bits of display_rotate hold the rotation (0 to 3), the
+    // higher bits hold the horizontal and vertical flips.
 
-    if (display_rotate & 1)
-    {
-        messageLog(isDaemon,
-                   program,
-                   LOG_ERR,
-                   "cannot copy rotated display");
-        exitAndRemovePidFile(EXIT_FAILURE, pfh);
-    }
+    int rotation = display_rotate & 3;
+    bool rotated = (rotation == 1) || (rotation == 3);
 
     //---------------------------------------------------------------------
 
@@ -274,8 +271,8 @@ main(
 
     VC_IMAGE_TYPE_T imageType = VC_IMAGE_RGB565;
     int bytesPerPixel = 2;
-    int width = lcd.width;
-    int height = lcd.height;
+    int width = (rotated) ? lcd.height : lcd.width;
+    int height = (rotated) ? lcd.width : lcd.height;
     int pitch = bytesPerPixel * ALIGN_TO_16(width);
 
     void *dmxImagePtr = malloc(pitch * height);
@@ -289,6 +286,23 @@ main(
         exitAndRemovePidFile(EXIT_FAILURE, pfh);
     }
 
+    int lcdPitch = bytesPerPixel * lcd.width;
+    void *lcdImagePtr = NULL;
+
+    if (rotated)
+    {
+        lcdImagePtr = malloc(lcdPitch * lcd.height);
+
+        if (lcdImagePtr == NULL)
+        {
+            messageLog(isDaemon,
+                       program,
+                       LOG_ERR,
+                       "unable to allocated image buffer");
+            exitAndRemovePidFile(EXIT_FAILURE, pfh);
+        }
+    }
+
     //---------------------------------------------------------------------
 
     DISPMANX_DISPLAY_HANDLE_T displayHandle = vc_dispmanx_display_open(0);
@@ -360,13 +374,45 @@ main(
 
         //-----------------------------------------------------------------
 
-        putRGB565Lcd(&lcd,
-                     0,
-                     0,
-                     width,
-                     height,
-                     pitch,
-                     dmxImagePtr);
+        if (rotated)
+        {
+            if (rotation == 1)
+            {
+                rotate90RGB565(lcdImagePtr,
+                               lcdPitch,
+                               dmxImagePtr,
+                               pitch,
+                               width,
+                               height);
+            }
+            else
+            {
+                rotate270RGB565(lcdImagePtr,
+                                lcdPitch,
+                                dmxImagePtr,
+                                pitch,
+                                width,
+                                height);
+            }
+
+            putRGB565Lcd(&lcd,
+                         0,
+                         0,
+                         lcd.width,
+                         lcd.height,
+                         lcdPitch,
+                         lcdImagePtr);
+        }
+        else
+        {
+            putRGB565Lcd(&lcd,
+                         0,
+                         0,
+                         width,
+                         height,
+                         pitch,
+                         dmxImagePtr);
+        }
 
         //-----------------------------------------------------------------
 
@@ -390,6 +436,7 @@ main(
     //---------------------------------------------------------------------
 
     free(dmxImagePtr);
+    free(lcdImagePtr);
 
     //---------------------------------------------------------------------
 
@@ -48,9 +48,13 @@
 #include <sys/mman.h>
 #include <sys/time.h>
 
+#include "bilinear.h"
 #include "lcd.h"
+#include "pixelPipeline.h"
 #include "resizeDispmanX.h"
 #include "syslogUtilities.h"
+#include "tiledImage.h"
+#include "workerPool.h"
 
 //-------------------------------------------------------------------------
 
@@ -77,6 +81,10 @@ printUsage(
             1000000 / DEFAULT_FRAME_DURATION);
     fprintf(fp, "    --pidfile <pidfile> - create and lock PID file (if being run as a daemon)\n");
     fprintf(fp, "    --help - print usage and exit\n");
+    fprintf(fp, "    --nearest - resize with nearest neighbour in a single");
+    fprintf(fp, " pass (always used for 32 bit framebuffers)\n");
+    fprintf(fp, "    --bilinear - resize 16 bit framebuffers with bilinear");
+    fprintf(fp, " interpolation in software\n");
     fprintf(fp, "\n");
 }
 
@@ -96,6 +104,84 @@ signalHandler(
     };
 }
 
+//-------------------------------------------------------------------------
+//
+// Find the pipeline format of a 32 bit framebuffer from where its red,
+// green and blue bytes are.
+//
+
+static bool
+framebufferFormat(
+    const struct fb_var_screeninfo *vinfo,
+    PIXEL_FORMAT_T *format)
+{
+    if ((vinfo->red.length != 8) ||
+        (vinfo->green.length != 8) ||
+        (vinfo->blue.length != 8))
+    {
+        return false;
+    }
+
+    uint32_t red = vinfo->red.offset;
+    uint32_t green = vinfo->green.offset;
+    uint32_t blue = vinfo->blue.offset;
+
+    if ((red == 16) && (green == 8) && (blue == 0))
+    {
+        *format = PIXEL_FORMAT_XRGB8888;
+    }
+    else if ((red == 0) && (green == 8) && (blue == 16))
+    {
+        *format = PIXEL_FORMAT_XBGR8888;
+    }
+    else if ((red == 24) && (green == 16) && (blue == 8))
+    {
+        *format = PIXEL_FORMAT_RGBX8888;
+    }
+    else if ((red == 8) && (green == 16) && (blue == 24))
+    {
+        *format = PIXEL_FORMAT_BGRX8888;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//-------------------------------------------------------------------------
+//
+// A converted frame holds big-endian pixels (see pixelPipeline.h).
+//
+
+static void
+sendArea(
+    LCD_T *lcd,
+    bool bigEndian,
+    int16_t x,
+    int16_t y,
+    int16_t width,
+    int16_t height,
+    const uint8_t *pixels,
+    int32_t pitch)
+{
+    if (bigEndian)
+    {
+        putBigEndianRGB565Lcd(lcd,
+                              x,
+                              y,
+                              width,
+                              height,
+                              pitch,
+                              (void *)pixels);
+    }
+    else
+    {
+        putRGB565Lcd(lcd, x, y, width, height, pitch, (void *)pixels);
+    }
+}
+
 //-------------------------------------------------------------------------
 
 int
@@ -108,15 +194,19 @@ main(
     suseconds_t frameDuration =  DEFAULT_FRAME_DURATION;
     bool isDaemon =  false;
     char *pidfile = NULL;
+    bool nearest = false;
+    bool bilinear = false;
 
     //---------------------------------------------------------------------
 
-    static const char *sopts = "df:hp:";
+    static const char *sopts = "bdf:hnp:";
     static struct option lopts[] = 
     {
+        { "bilinear", no_argument, NULL, 'b' },
         { "daemon", no_argument, NULL, 'd' },
         { "fps", required_argument, NULL, 'f' },
         { "help", no_argument, NULL, 'h' },
+        { "nearest", no_argument, NULL, 'n' },
         { "pidfile", required_argument, NULL, 'p' },
         { NULL, no_argument, NULL, 0 }
     };
@@ -127,6 +217,12 @@ main(
     {
         switch (opt)
         {
+        case 'b':
+
+            bilinear = true;
+
+            break;
+
         case 'd':
 
             isDaemon = true;
@@ -150,6 +246,12 @@ main(
 
             break;
 
+        case 'n':
+
+            nearest = true;
+
+            break;
+
         case 'p':
 
             pidfile = optarg;
@@ -270,12 +372,12 @@ main(
         exitAndRemovePidFile(EXIT_FAILURE, pfh);
     }
 
-    if (vinfo.bits_per_pixel != 16)
+    if ((vinfo.bits_per_pixel != 16) && (vinfo.bits_per_pixel != 32))
     {
         messageLog(isDaemon,
                    program,
                    LOG_ERR,
-                   "only 16 bits per pixels supported");
+                   "only 16 and 32 bits per pixel supported");
         exitAndRemovePidFile(EXIT_FAILURE, pfh);
     }
 
@@ -304,13 +406,82 @@ main(
 
     //---------------------------------------------------------------------
 
-    bool resize = ((width != vinfo.xres) ||
-                   (height != vinfo.yres) ||
-                   (pitch != finfo.line_length));
+    // A 32 bit framebuffer (or any resize with --nearest) is scaled,
+    // dithered and byte swapped for the LCD in a single pass. With
+    // --bilinear an RGB565 framebuffer that is not the size of the LCD is
+    // interpolated in software, otherwise the GPU resizes it.
+
+    bool differentSize = (width != vinfo.xres) || (height != vinfo.yres);
+
+    bool fused = (vinfo.bits_per_pixel == 32) || (nearest && differentSize);
+
+    bool interpolate = (fused == false) && bilinear && differentSize;
+
+    bool resize = (fused == false) &&
+                  (interpolate == false) &&
+                  (differentSize || (pitch != finfo.line_length));
 
     RESIZE_DISPMANX_T rd;
+    BILINEAR_T bl;
+    PIXEL_PIPELINE_T pipeline;
+    WORKER_POOL_T pool;
 
-    if (resize)
+    if (fused)
+    {
+        PIXEL_FORMAT_T format = PIXEL_FORMAT_RGB565;
+
+        if ((vinfo.bits_per_pixel == 32) &&
+            (framebufferFormat(&vinfo, &format) == false))
+        {
+            messageLog(isDaemon,
+                       program,
+                       LOG_ERR,
+                       "unsupported 32 bit pixel layout"
+                       " (red %u, green %u, blue %u)",
+                       vinfo.red.offset,
+                       vinfo.green.offset,
+                       vinfo.blue.offset);
+            exitAndRemovePidFile(EXIT_FAILURE, pfh);
+        }
+
+        initPixelPipeline(&pipeline,
+                          format,
+                          IMAGE_BYTE_ORDER_BIG_ENDIAN,
+                          true,
+                          width,
+                          height,
+                          vinfo.xres,
+                          vinfo.yres,
+                          true);
+
+        if (initWorkerPool(&pool, 0) == false)
+        {
+            messageLog(isDaemon,
+                       program,
+                       LOG_ERR,
+                       "cannot start worker threads");
+            exitAndRemovePidFile(EXIT_FAILURE, pfh);
+        }
+
+        width = pipeline.nn.destinationWidth;
+        height = pipeline.nn.destinationHeight;
+        pitch = width * sizeof(uint16_t);
+
+        xOffset = (lcd.width - width) / 2;
+        yOffset = (lcd.height - height) / 2;
+    }
+    else if (interpolate)
+    {
+        initBilinear(&bl, width, height, vinfo.xres, vinfo.yres, true);
+
+        width = bl.destinationWidth;
+        height = bl.destinationHeight;
+        pitch = width * sizeof(uint16_t);
+
+        xOffset = (lcd.width - width) / 2;
+        yOffset = (lcd.height - height) / 2;
+    }
+    else if (resize)
     {
         initResizeDispmanX(&rd,
                            width,
@@ -329,14 +500,28 @@ main(
 
     //---------------------------------------------------------------------
 
-    void *fbcopy = calloc(1, pitch * height);
+    // The resized (or converted) frame goes via a copy, but otherwise the
+    // tiles are compared against the framebuffer directly. Only tiles that
+    // have changed since the last frame are sent to the LCD. The tiles of
+    // a converted frame hold big-endian pixels.
 
-    if (fbcopy == NULL)
+    bool copy = resize || fused || interpolate;
+    void *fbcopy = NULL;
+
+    if (copy)
+    {
+        fbcopy = calloc(1, pitch * height);
+    }
+
+    if (copy && (fbcopy == NULL))
     {
         perrorLog(isDaemon, program, "failed to create copy buffer");
         exitAndRemovePidFile(EXIT_FAILURE, pfh);
     }
 
+    TILED_IMAGE_T tiled;
+    initTiledImage(&tiled, width, height);
+
     //---------------------------------------------------------------------
 
     struct timeval start_time;
@@ -351,7 +536,31 @@ main(
 
         //-----------------------------------------------------------------
 
-        if (resize)
+        // The frame the tiles are updated from, also used to send them.
+
+        const uint8_t *frame = fbp;
+        int32_t framePitch = finfo.line_length;
+
+        if (copy)
+        {
+            frame = fbcopy;
+            framePitch = pitch;
+        }
+
+        if (fused)
+        {
+            pixelPipelineThreaded(&pipeline,
+                                  &pool,
+                                  fbcopy,
+                                  pitch,
+                                  fbp,
+                                  finfo.line_length);
+        }
+        else if (interpolate)
+        {
+            resizeBilinear(&bl, fbcopy, pitch, fbp, finfo.line_length);
+        }
+        else if (resize)
         {
             resizeDispmanX(&rd,
                            fbcopy,
@@ -359,20 +568,48 @@ main(
                            fbp,
                            finfo.line_length);
         }
-        else
-        {
-            memcpy(fbcopy, fbp, finfo.smem_len);
-        }
+
+        int32_t changed = updateTiledImageRGB565(&tiled, frame, framePitch);
 
         //-----------------------------------------------------------------
 
-        putRGB565Lcd(&lcd,
+        // Each run of dirty tiles along a row of tiles goes to the LCD as
+        // one window, or the whole frame once most of the tiles are dirty.
+
+        int32_t index = 0;
+        TILE_AREA_T area;
+
+        if (changed > (tiled.columns * tiled.rows) / 2)
+        {
+            sendArea(&lcd,
+                     fused,
                      xOffset,
                      yOffset,
                      width,
                      height,
-                     pitch,
-                     fbcopy);
+                     frame,
+                     framePitch);
+        }
+        else
+        {
+            while (nextDirtyRun(&tiled, &index, &area))
+            {
+                const uint8_t *pixels = frame
+                                      + (area.x * sizeof(uint16_t))
+                                      + (area.y * framePitch);
+
+                sendArea(&lcd,
+                         fused,
+                         xOffset + area.x,
+                         yOffset + area.y,
+                         area.width,
+                         area.height,
+                         pixels,
+                         framePitch);
+            }
+        }
+
+        clearTiledImageDirty(&tiled);
 
         //-----------------------------------------------------------------
 
@@ -390,7 +627,32 @@ main(
 
     //--------------------------------------------------------------------
 
-	destroyResizeDispmanX(&rd);
+    if (resize)
+    {
+        if (rd.frames > 0)
+        {
+            messageLog(isDaemon,
+                       program,
+                       LOG_INFO,
+                       "resized %u frames, average %u us, longest %u us",
+                       rd.frames,
+                       (uint32_t)(rd.totalFrameTime / rd.frames),
+                       rd.maxFrameTime);
+        }
+
+        destroyResizeDispmanX(&rd);
+    }
+
+    if (fused)
+    {
+        destroyPixelPipeline(&pipeline);
+        destroyWorkerPool(&pool);
+    }
+
+    if (interpolate)
+    {
+        destroyBilinear(&bl);
+    }
 
     //--------------------------------------------------------------------
 
@@ -400,6 +662,7 @@ main(
     //---------------------------------------------------------------------
 
     free(fbcopy);
+    destroyTiledImage(&tiled);
 
     //---------------------------------------------------------------------
 
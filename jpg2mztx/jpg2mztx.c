@@ -40,47 +40,70 @@
 
 #include <jpeglib.h>
 
+#include "dither.h"
 #include "image.h"
 #include "key.h"
 #include "lcd.h"
-#include "nearestNeighbour.h"
+#include "pixelPipeline.h"
+#include "slideshow.h"
+#include "transition.h"
+#include "workerPool.h"
 
 //-------------------------------------------------------------------------
 
 const char* program = NULL;
 
 //-------------------------------------------------------------------------
+//
+// Open a JPEG and start decompressing it as 8 bit RGB, scaled by libjpeg
+// to no less than the size of the display. Returns the file (for
+// finishJpeg) or NULL.
+//
 
-static bool
-readJpeg(
+static FILE *
+startJpeg(
     const char *file,
     LCD_T *lcd,
-    IMAGE_T *image)
+    bool autorotate,
+    struct jpeg_decompress_struct *cinfo,
+    struct jpeg_error_mgr *jerr)
 {
     FILE *fpin = fopen(file, "rb");
 
     if (fpin == NULL)
     {
         perror("Error: cannot open file");
-        return false;
+        return NULL;
     }
 
     //---------------------------------------------------------------------
 
-    struct jpeg_decompress_struct cinfo;
-    struct jpeg_error_mgr jerr;
-
-    cinfo.err = jpeg_std_error(&jerr);
-    jpeg_create_decompress(&cinfo);
-    jpeg_stdio_src(&cinfo, fpin);
-    jpeg_read_header(&cinfo, TRUE);
+    cinfo->err = jpeg_std_error(jerr);
+    jpeg_create_decompress(cinfo);
+    jpeg_stdio_src(cinfo, fpin);
+    jpeg_read_header(cinfo, TRUE);
 
     //---------------------------------------------------------------------
 
-    jpeg_calc_output_dimensions(&cinfo);
+    jpeg_calc_output_dimensions(cinfo);
+
+    // scale for the display as the image will be seen, after any rotation
+
+    int16_t width = lcd->width;
+    int16_t height = lcd->height;
 
-    double xratio = (double)(cinfo.output_width) / lcd->width;
-    double yratio = (double)(cinfo.output_height) / lcd->height;
+    if (autorotate &&
+        needsRotation(cinfo->output_width,
+                      cinfo->output_height,
+                      width,
+                      height))
+    {
+        width = lcd->height;
+        height = lcd->width;
+    }
+
+    double xratio = (double)(cinfo->output_width) / width;
+    double yratio = (double)(cinfo->output_height) / height;
 
     double ratio = xratio;
 
@@ -91,58 +114,95 @@ readJpeg(
 
     if (ratio > (8.0/1.0))
     {
-        cinfo.scale_num = 1;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 1;
+        cinfo->scale_denom = 8;
     }
     else if (ratio > (8.0/2.0))
     {
-        cinfo.scale_num = 2;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 2;
+        cinfo->scale_denom = 8;
     }
     else if (ratio > (8.0/3.0))
     {
-        cinfo.scale_num = 3;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 3;
+        cinfo->scale_denom = 8;
     }
     else if (ratio > (8.0/4.0))
     {
-        cinfo.scale_num = 4;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 4;
+        cinfo->scale_denom = 8;
     }
     else if (ratio > (8.0/5.0))
     {
-        cinfo.scale_num = 5;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 5;
+        cinfo->scale_denom = 8;
     }
     else if (ratio > (8.0/6.0))
     {
-        cinfo.scale_num = 6;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 6;
+        cinfo->scale_denom = 8;
     }
     else if (ratio > (8.0/7.0))
     {
-        cinfo.scale_num = 7;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 7;
+        cinfo->scale_denom = 8;
     }
     else
     {
-        cinfo.scale_num = 8;
-        cinfo.scale_denom = 8;
+        cinfo->scale_num = 8;
+        cinfo->scale_denom = 8;
     }
 
-    jpeg_calc_output_dimensions(&cinfo);
+    jpeg_calc_output_dimensions(cinfo);
 
     //---------------------------------------------------------------------
 
-    cinfo.out_color_space = JCS_RGB;
-    jpeg_start_decompress(&cinfo);
+    cinfo->out_color_space = JCS_RGB;
+    jpeg_start_decompress(cinfo);
 
-    //---------------------------------------------------------------------
+    return fpin;
+}
+
+//-------------------------------------------------------------------------
+//
+// Any scanlines that were not needed are discarded rather than decoded.
+//
+
+static void
+finishJpeg(
+    struct jpeg_decompress_struct *cinfo,
+    FILE *fpin)
+{
+    if (cinfo->output_scanline < cinfo->output_height)
+    {
+        jpeg_abort_decompress(cinfo);
+    }
+    else
+    {
+        jpeg_finish_decompress(cinfo);
+    }
+
+    jpeg_destroy_decompress(cinfo);
+
+    fclose(fpin);
+}
 
+//-------------------------------------------------------------------------
+//
+// Decode the whole JPEG into an image. Only needed when the image is
+// error diffused (at the size it was decoded) or rotated.
+//
+
+static bool
+decodeJpeg(
+    struct jpeg_decompress_struct *cinfo,
+    DITHER_T dither,
+    IMAGE_T *image)
+{
     bool result = initImage(image,
-                            cinfo.output_width,
-                            cinfo.output_height,
-                            true);
+                            cinfo->output_width,
+                            cinfo->output_height,
+                            dither == DITHER_ORDERED);
 
     if (result == false)
     {
@@ -151,7 +211,7 @@ readJpeg(
 
     //---------------------------------------------------------------------
 
-    uint8_t *row = malloc(cinfo.output_width * 3);
+    uint8_t *row = malloc(cinfo->output_width * 3);
 
     if (row == NULL)
     {
@@ -162,33 +222,133 @@ readJpeg(
 
     //---------------------------------------------------------------------
 
+    bool diffuse = (dither == DITHER_ERROR_DIFFUSION) ||
+                   (dither == DITHER_SERPENTINE);
+
+    ERROR_DIFFUSION_T ed;
+
+    if (diffuse)
+    {
+        initErrorDiffusion(&ed,
+                           cinfo->output_width,
+                           dither == DITHER_SERPENTINE);
+    }
+
+    //---------------------------------------------------------------------
+
     int j = 0;
-    for (j = 0 ; j < cinfo.output_height ; j++)
+    for (j = 0 ; j < cinfo->output_height ; j++)
     {
-        jpeg_read_scanlines(&cinfo, &row, 1);
+        jpeg_read_scanlines(cinfo, &row, 1);
 
-        int i = 0;
-        for (i = 0 ; i < cinfo.output_width ; i++)
+        if (diffuse)
         {
-            uint8_t *pixel = row + (i * 3);
+            errorDiffuseRow(&ed,
+                            row,
+                            3,
+                            image->buffer + (j * image->width));
 
-            RGB8_T rgb = { pixel[0], pixel[1], pixel[2] };
-            setPixelRGB(image, i, j, &rgb);        
+            damageImage(image, 0, j, image->width, 1);
+        }
+        else
+        {
+            int i = 0;
+            for (i = 0 ; i < cinfo->output_width ; i++)
+            {
+                uint8_t *pixel = row + (i * 3);
+
+                RGB8_T rgb = { pixel[0], pixel[1], pixel[2] };
+                setPixelRGB(image, i, j, &rgb);        
+            }
         }
     }
 
     //---------------------------------------------------------------------
 
+    if (diffuse)
+    {
+        destroyErrorDiffusion(&ed);
+    }
+
     free(row);
 
-    jpeg_finish_decompress(&cinfo);
-    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
 
-    fclose(fpin);
+//-------------------------------------------------------------------------
+//
+// Scale the JPEG, centred, into the slide as it is decoded. Each scanline
+// goes straight from libjpeg's RGB to the slide's RGB565 (dithered if
+// asked), so the JPEG is never held at its decoded size. Scanlines that
+// no slide row comes from are decoded and dropped. When the JPEG is 2, 3
+// or 4 times the size of the slide, each slide pixel is the average of
+// the block of JPEG pixels it covers.
+//
 
-    //---------------------------------------------------------------------
+static void
+scaleJpeg(
+    struct jpeg_decompress_struct *cinfo,
+    DITHER_T dither,
+    IMAGE_T *slide)
+{
+    PIXEL_PIPELINE_T pipeline;
+
+    initPixelPipeline(&pipeline,
+                      PIXEL_FORMAT_RGB888,
+                      slide->byteOrder,
+                      dither == DITHER_ORDERED,
+                      slide->width,
+                      slide->height,
+                      cinfo->output_width,
+                      cinfo->output_height,
+                      true);
+
+    int16_t width = pipeline.nn.destinationWidth;
+    int16_t height = pipeline.nn.destinationHeight;
+    int16_t x = (slide->width - width) / 2;
+    int16_t y = (slide->height - height) / 2;
+
+    // Enough scanlines for one destination row; more than one when the
+    // box filter is used.
+
+    int16_t rows = pixelPipelineSourceRows(&pipeline);
+    int32_t pitch = cinfo->output_width * 3;
+    uint8_t *buffer = malloc(pitch * rows);
+
+    if (buffer == NULL)
+    {
+        perror("jpg2mztx: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
 
-    return true;
+    int16_t j;
+    for (j = 0 ; j < height ; j++)
+    {
+        int16_t source = pixelPipelineSourceRow(&pipeline, j);
+
+        while (cinfo->output_scanline <= source)
+        {
+            jpeg_read_scanlines(cinfo, &buffer, 1);
+        }
+
+        int16_t k;
+        for (k = 1 ; k < rows ; k++)
+        {
+            uint8_t *row = buffer + (k * pitch);
+            jpeg_read_scanlines(cinfo, &row, 1);
+        }
+
+        pixelPipelineRow(&pipeline,
+                         slide->buffer + x + ((y + j) * slide->width),
+                         buffer,
+                         pitch,
+                         j);
+    }
+
+    damageImage(slide, x, y, width, height);
+
+    free(buffer);
+    destroyPixelPipeline(&pipeline);
 }
 
 //-------------------------------------------------------------------------
@@ -198,11 +358,81 @@ printUsage(
     const char *name)
 {
     printf("usage: %s --file <file.jpg> ... options\n", name);
+    printf("    --autorotate - rotate portrait images on a landscape display");
+    printf(" (and the reverse)\n");
+    printf("    --delay <seconds> - time each image is shown (default 5)\n");
+    printf("    --dither <method> - none, ordered (default), diffusion");
+    printf(" or serpentine\n");
     printf("    --help - print this help message\n");
     printf("    --portrait - display in portrait orientation\n");
+    printf("    --transition <type> - none, fade (default), wipe or slide\n");
+    printf("\n");
+    printf("    more than one file can be given (--file may be repeated\n");
+    printf("    or the files listed after the options) for a slideshow\n");
     printf("\n");
 }
 
+//-------------------------------------------------------------------------
+//
+// Load a JPEG and fit it, centred, into a slide the size of the LCD.
+//
+
+static bool
+loadSlide(
+    const char *filename,
+    LCD_T *lcd,
+    DITHER_T dither,
+    bool autorotate,
+    WORKER_POOL_T *pool,
+    IMAGE_T *slide)
+{
+    struct jpeg_decompress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+
+    FILE *fpin = startJpeg(filename, lcd, autorotate, &cinfo, &jerr);
+
+    if (fpin == NULL)
+    {
+        return false;
+    }
+
+    bool diffuse = (dither == DITHER_ERROR_DIFFUSION) ||
+                   (dither == DITHER_SERPENTINE);
+
+    bool rotate = autorotate &&
+                  needsRotation(cinfo.output_width,
+                                cinfo.output_height,
+                                slide->width,
+                                slide->height);
+
+    if ((diffuse == false) && (rotate == false))
+    {
+        clearImageRGB565(slide, packRGB565(0, 0, 0));
+        scaleJpeg(&cinfo, dither, slide);
+        finishJpeg(&cinfo, fpin);
+
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+
+    IMAGE_T image;
+    bool result = decodeJpeg(&cinfo, dither, &image);
+
+    finishJpeg(&cinfo, fpin);
+
+    if (result == false)
+    {
+        return false;
+    }
+
+    fitSlide(slide, &image, rotate, true, pool);
+
+    destroyImage(&image);
+
+    return true;
+}
+
 //-------------------------------------------------------------------------
 
 int
@@ -211,18 +441,34 @@ main(
     char *argv[])
 {
     program = basename(argv[0]);
-    char *filename = NULL;
+
+    const char **filenames = calloc(argc, sizeof(char *));
+    int files = 0;
+
+    if (filenames == NULL)
+    {
+        perror("jpg2mztx: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
 
     uint16_t rotate = 90;
+    bool autorotate = false;
+    int delay = 5;
+    DITHER_T dither = DITHER_ORDERED;
+    TRANSITION_T transition = TRANSITION_FADE;
 
     //---------------------------------------------------------------------
 
-    static const char *sopts = "f:hp";
+    static const char *sopts = "aD:d:f:hpt:";
     static struct option lopts[] = 
     {
+        { "autorotate", no_argument, NULL, 'a' },
+        { "delay", required_argument, NULL, 'D' },
+        { "dither", required_argument, NULL, 'd' },
         { "file", required_argument, NULL, 'f' },
         { "help", no_argument, NULL, 'h' },
         { "portrait", no_argument, NULL, 'p' },
+        { "transition", required_argument, NULL, 't' },
         { NULL, no_argument, NULL, 0 }
     };
 
@@ -232,9 +478,36 @@ main(
     {
         switch (opt)
         {
+        case 'a':
+
+            autorotate = true;
+
+            break;
+
+        case 'D':
+
+            delay = atoi(optarg);
+
+            if (delay < 1)
+            {
+                delay = 1;
+            }
+
+            break;
+
+        case 'd':
+
+            if (parseDither(optarg, &dither) == false)
+            {
+                printUsage(program);
+                exit(EXIT_FAILURE);
+            }
+
+            break;
+
         case 'f':
 
-            filename = optarg;
+            filenames[files++] = optarg;
 
             break;
 
@@ -251,6 +524,16 @@ main(
 
             break;
 
+        case 't':
+
+            if (parseTransition(optarg, &transition) == false)
+            {
+                printUsage(program);
+                exit(EXIT_FAILURE);
+            }
+
+            break;
+
         default:
 
             printUsage(program);
@@ -260,9 +543,14 @@ main(
         }
     }
 
+    while (optind < argc)
+    {
+        filenames[files++] = argv[optind++];
+    }
+
     //---------------------------------------------------------------------
 
-    if (filename == NULL)
+    if (files == 0)
     {
         printUsage(program);
         exit(EXIT_FAILURE);
@@ -284,64 +572,82 @@ main(
         exit(EXIT_FAILURE);
     }
 
-    IMAGE_T image;
-    if (readJpeg(filename, &lcd, &image) == false)
+    WORKER_POOL_T pool;
+
+    if (initWorkerPool(&pool, 0) == false)
     {
-        fprintf(stderr, "%s: failed to open %s\n", program, filename);
+        fprintf(stderr, "%s: cannot start worker threads\n", program);
         exit(EXIT_FAILURE);
     }
-    
 
-    //---------------------------------------------------------------------
+    IMAGE_T current;
+    IMAGE_T next;
+    IMAGE_T frame;
+
+    initImage(&current, lcd.width, lcd.height, false);
+    initImage(&next, lcd.width, lcd.height, false);
+    initImage(&frame, lcd.width, lcd.height, false);
 
+    // Without a transition the slides are only ever sent to the LCD, so
+    // they are scaled straight into the byte order it expects.
 
-    if ((image.width != lcd.width) || (image.height != lcd.height))
+    if (transition == TRANSITION_NONE)
     {
-        NEAREST_NEIGHBOUR_T nn;
+        setImageByteOrder(&current, IMAGE_BYTE_ORDER_BIG_ENDIAN);
+        setImageByteOrder(&next, IMAGE_BYTE_ORDER_BIG_ENDIAN);
+    }
 
-        initNearestNeighbour(&nn,
-                             lcd.width,
-                             lcd.height,
-                             image.width,
-                             image.height,
-                             true);
+    if (loadSlide(filenames[0],
+                  &lcd,
+                  dither,
+                  autorotate,
+                  &pool,
+                  &current) == false)
+    {
+        fprintf(stderr, "%s: failed to open %s\n", program, filenames[0]);
+        exit(EXIT_FAILURE);
+    }
 
-        IMAGE_T resized;
-        initImage(&resized,
-                  nn.destinationWidth,
-                  nn.destinationHeight,
-                  false);
+    putImageLcd(&lcd, 0, 0, &current);
 
-        resizeNearestNeighbour(&nn,
-                               resized.buffer,
-                               resized.width * sizeof(uint16_t),
-                               image.buffer,
-                               image.width * sizeof(uint16_t));
+    //---------------------------------------------------------------------
 
-        putImageLcd(&lcd,
-                    (lcd.width - resized.width) / 2,
-                    (lcd.height - resized.height) / 2,
-                    &resized);
+    int index = 0;
 
-        destroyImage(&resized);
-    }
-    else
+    while (waitForEscape((files > 1) ? delay : -1) == false)
     {
-        putImageLcd(&lcd, 0, 0, &image);
-    }
-
-    destroyImage(&image);
+        index = (index + 1) % files;
+
+        if (loadSlide(filenames[index],
+                      &lcd,
+                      dither,
+                      autorotate,
+                      &pool,
+                      &next))
+        {
+            showTransition(&lcd, transition, &current, &next, &frame);
 
-    int c = 0;
-    while (c != 27)
-    {
-        usleep(100000);
-        keyPressed(&c);
+            IMAGE_T swap = current;
+            current = next;
+            next = swap;
+        }
+        else
+        {
+            fprintf(stderr,
+                    "%s: failed to open %s\n",
+                    program,
+                    filenames[index]);
+        }
     }
 
+    destroyImage(&current);
+    destroyImage(&next);
+    destroyImage(&frame);
+    destroyWorkerPool(&pool);
+    free(filenames);
+
     keyboardReset();
     closeLcd(&lcd);
 
     return 0 ;
 }
-
@@ -40,11 +40,14 @@
 
 #include <png.h>
 
+#include "dither.h"
 #include "image.h"
 #include "key.h"
 #include "lcd.h"
 #include "loadpng.h"
-#include "nearestNeighbour.h"
+#include "slideshow.h"
+#include "transition.h"
+#include "workerPool.h"
 
 //-------------------------------------------------------------------------
 
@@ -56,12 +59,49 @@ void
 printUsage(
     const char *name)
 {
-    printf("usage: %s --file <file.jpg> ... options\n", name);
+    printf("usage: %s --file <file.png> ... options\n", name);
+    printf("    --autorotate - rotate portrait images on a landscape display");
+    printf(" (and the reverse)\n");
+    printf("    --delay <seconds> - time each image is shown (default 5)\n");
+    printf("    --dither <method> - none, ordered (default), diffusion");
+    printf(" or serpentine\n");
     printf("    --help - print this help message\n");
     printf("    --portrait - display in portrait orientation\n");
+    printf("    --transition <type> - none, fade (default), wipe or slide\n");
+    printf("\n");
+    printf("    more than one file can be given (--file may be repeated\n");
+    printf("    or the files listed after the options) for a slideshow\n");
     printf("\n");
 }
 
+//-------------------------------------------------------------------------
+//
+// Load a PNG and fit it, centred, into a slide the size of the LCD.
+//
+
+static bool
+loadSlide(
+    const char *filename,
+    DITHER_T dither,
+    bool autorotate,
+    WORKER_POOL_T *pool,
+    IMAGE_T *slide)
+{
+    RGB8_T background = { 0, 0, 0 };
+    IMAGE_T image;
+
+    if (loadPng(filename, &background, dither, pool, &image) == false)
+    {
+        return false;
+    }
+
+    fitSlide(slide, &image, autorotate, false, pool);
+
+    destroyImage(&image);
+
+    return true;
+}
+
 //-------------------------------------------------------------------------
 
 int
@@ -70,18 +110,34 @@ main(
     char *argv[])
 {
     program = basename(argv[0]);
-    char *filename = NULL;
+
+    const char **filenames = calloc(argc, sizeof(char *));
+    int files = 0;
+
+    if (filenames == NULL)
+    {
+        perror("png2mztx: memory exhausted\n");
+        exit(EXIT_FAILURE);
+    }
 
     uint16_t rotate = 90;
+    bool autorotate = false;
+    int delay = 5;
+    DITHER_T dither = DITHER_ORDERED;
+    TRANSITION_T transition = TRANSITION_FADE;
 
     //---------------------------------------------------------------------
 
-    static const char *sopts = "f:hp";
+    static const char *sopts = "aD:d:f:hpt:";
     static struct option lopts[] = 
     {
+        { "autorotate", no_argument, NULL, 'a' },
+        { "delay", required_argument, NULL, 'D' },
+        { "dither", required_argument, NULL, 'd' },
         { "file", required_argument, NULL, 'f' },
         { "help", no_argument, NULL, 'h' },
         { "portrait", no_argument, NULL, 'p' },
+        { "transition", required_argument, NULL, 't' },
         { NULL, no_argument, NULL, 0 }
     };
 
@@ -91,9 +147,36 @@ main(
     {
         switch (opt)
         {
+        case 'a':
+
+            autorotate = true;
+
+            break;
+
+        case 'D':
+
+            delay = atoi(optarg);
+
+            if (delay < 1)
+            {
+                delay = 1;
+            }
+
+            break;
+
+        case 'd':
+
+            if (parseDither(optarg, &dither) == false)
+            {
+                printUsage(program);
+                exit(EXIT_FAILURE);
+            }
+
+            break;
+
         case 'f':
 
-            filename = optarg;
+            filenames[files++] = optarg;
 
             break;
 
@@ -110,6 +193,16 @@ main(
 
             break;
 
+        case 't':
+
+            if (parseTransition(optarg, &transition) == false)
+            {
+                printUsage(program);
+                exit(EXIT_FAILURE);
+            }
+
+            break;
+
         default:
 
             printUsage(program);
@@ -119,9 +212,14 @@ main(
         }
     }
 
+    while (optind < argc)
+    {
+        filenames[files++] = argv[optind++];
+    }
+
     //---------------------------------------------------------------------
 
-    if (filename == NULL)
+    if (files == 0)
     {
         printUsage(program);
         exit(EXIT_FAILURE);
@@ -143,68 +241,63 @@ main(
         exit(EXIT_FAILURE);
     }
 
-    RGB8_T background = { 0, 0, 0 };
-    IMAGE_T image;
-    if (loadPng(filename, &background, &image) == false)
+    WORKER_POOL_T pool;
+
+    if (initWorkerPool(&pool, 0) == false)
     {
-        fprintf(stderr, "%s: failed to open %s\n", program, filename);
+        fprintf(stderr, "%s: cannot start worker threads\n", program);
         exit(EXIT_FAILURE);
     }
-    
 
-    //---------------------------------------------------------------------
+    IMAGE_T current;
+    IMAGE_T next;
+    IMAGE_T frame;
 
+    initImage(&current, lcd.width, lcd.height, false);
+    initImage(&next, lcd.width, lcd.height, false);
+    initImage(&frame, lcd.width, lcd.height, false);
 
-    if ((image.width > lcd.width) || (image.height > lcd.height))
+    if (loadSlide(filenames[0], dither, autorotate, &pool, &current) == false)
     {
-        NEAREST_NEIGHBOUR_T nn;
-
-        initNearestNeighbour(&nn,
-                             lcd.width,
-                             lcd.height,
-                             image.width,
-                             image.height,
-                             true);
-
-        IMAGE_T resized;
-        initImage(&resized,
-                  nn.destinationWidth,
-                  nn.destinationHeight,
-                  false);
-
-        resizeNearestNeighbour(&nn,
-                               resized.buffer,
-                               resized.width * sizeof(uint16_t),
-                               image.buffer,
-                               image.width * sizeof(uint16_t));
-
-        putImageLcd(&lcd,
-                    (lcd.width - resized.width) / 2,
-                    (lcd.height - resized.height) / 2,
-                    &resized);
-
-        destroyImage(&resized);
-    }
-    else
-    {
-        putImageLcd(&lcd,
-                    (lcd.width - image.width) / 2,
-                    (lcd.height - image.height) / 2,
-                    &image);
+        fprintf(stderr, "%s: failed to open %s\n", program, filenames[0]);
+        exit(EXIT_FAILURE);
     }
 
-    destroyImage(&image);
+    putImageLcd(&lcd, 0, 0, &current);
 
-    int c = 0;
-    while (c != 27)
+    //---------------------------------------------------------------------
+
+    int index = 0;
+
+    while (waitForEscape((files > 1) ? delay : -1) == false)
     {
-        usleep(100000);
-        keyPressed(&c);
+        index = (index + 1) % files;
+
+        if (loadSlide(filenames[index], dither, autorotate, &pool, &next))
+        {
+            showTransition(&lcd, transition, &current, &next, &frame);
+
+            IMAGE_T swap = current;
+            current = next;
+            next = swap;
+        }
+        else
+        {
+            fprintf(stderr,
+                    "%s: failed to open %s\n",
+                    program,
+                    filenames[index]);
+        }
     }
 
+    destroyImage(&current);
+    destroyImage(&next);
+    destroyImage(&frame);
+    destroyWorkerPool(&pool);
+    free(filenames);
+
     keyboardReset();
     closeLcd(&lcd);
 
     return 0 ;
 }
-
@@ -37,7 +37,9 @@
 #include "cpuTrace.h"
 #include "font.h"
 #include "image.h"
+#include "indexedImage.h"
 #include "lcd.h"
+#include "trace.h"
 
 //-------------------------------------------------------------------------
 
@@ -136,95 +138,112 @@ initCpuTrace(
         exit(EXIT_FAILURE);
     }
 
-    if (initImage(&(trace->image), width, height, true) == false)
+    if (initIndexedImage(&(trace->image), width, height) == false)
     {
         exit(EXIT_FAILURE);
     }
 
-    trace->userColour = packRGB565(4, 90, 141);
-    trace->niceColour = packRGB565(116, 169, 207);
-    trace->systemColour = packRGB565(241, 238, 246);
-    trace->foreground = packRGB565(255, 255, 255);
-    trace->background = packRGB565(0, 0, 0);
-    trace->gridColour = packRGB565(48, 48, 48);
+    // Each colour is a palette index, the RGB565 values are set below.
 
-    trace->userGridColour = blendRGB565(63,
-                                        trace->gridColour,
-                                        trace->userColour);
+    trace->background = 0;
+    trace->foreground = 1;
+    trace->gridColour = 2;
+    trace->userColour = 3;
+    trace->userGridColour = 4;
+    trace->niceColour = 5;
+    trace->niceGridColour = 6;
+    trace->systemColour = 7;
+    trace->systemGridColour = 8;
 
-    trace->niceGridColour = blendRGB565(63,
-                                        trace->gridColour,
-                                        trace->niceColour);
+    INDEXED_IMAGE_T *image = &(trace->image);
 
-    trace->systemGridColour = blendRGB565(63,
-                                          trace->gridColour,
-                                          trace->systemColour);
+    uint16_t gridColour = packRGB565(48, 48, 48);
+    uint16_t userColour = packRGB565(4, 90, 141);
+    uint16_t niceColour = packRGB565(116, 169, 207);
+    uint16_t systemColour = packRGB565(241, 238, 246);
 
-    //---------------------------------------------------------------------
+    setPaletteRGB565(image, trace->background, packRGB565(0, 0, 0));
+    setPaletteRGB565(image, trace->foreground, packRGB565(255, 255, 255));
+    setPaletteRGB565(image, trace->gridColour, gridColour);
+    setPaletteRGB565(image, trace->userColour, userColour);
+    setPaletteRGB565(image, trace->niceColour, niceColour);
+    setPaletteRGB565(image, trace->systemColour, systemColour);
+
+    setPaletteRGB565(image,
+                     trace->userGridColour,
+                     blendRGB565(63, gridColour, userColour));
+
+    setPaletteRGB565(image,
+                     trace->niceGridColour,
+                     blendRGB565(63, gridColour, niceColour));
 
-    IMAGE_T *image = &(trace->image);
+    setPaletteRGB565(image,
+                     trace->systemGridColour,
+                     blendRGB565(63, gridColour, systemColour));
+
+    //---------------------------------------------------------------------
 
-    clearImageRGB565(image, trace->background);
+    clearIndexedImage(image, trace->background);
 
     uint8_t smallSquare = 0xFE;
 
     FONT_POSITION_T position = 
-        drawStringRGB565(0,
-                         image->height - 2 - FONT_HEIGHT,
-                         "CPU",
-                         trace->foreground,
-                         image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " (user:",
-                                trace->foreground,
-                                image);
-
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              smallSquare,
-                              trace->userColour,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " nice:",
-                                trace->foreground,
-                                image);
-
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              smallSquare,
-                              trace->niceColour,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " system:",
-                                trace->foreground,
-                                image);
-
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              smallSquare,
-                              trace->systemColour,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                ")",
-                                trace->foreground,
-                                image);
+        drawStringIndexed(0,
+                          image->height - 2 - FONT_HEIGHT,
+                          "CPU",
+                          trace->foreground,
+                          image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 " (user:",
+                                 trace->foreground,
+                                 image);
+
+    position = drawCharIndexed(position.x,
+                               position.y,
+                               smallSquare,
+                               trace->userColour,
+                               image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 " nice:",
+                                 trace->foreground,
+                                 image);
+
+    position = drawCharIndexed(position.x,
+                               position.y,
+                               smallSquare,
+                               trace->niceColour,
+                               image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 " system:",
+                                 trace->foreground,
+                                 image);
+
+    position = drawCharIndexed(position.x,
+                               position.y,
+                               smallSquare,
+                               trace->systemColour,
+                               image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 ")",
+                                 trace->foreground,
+                                 image);
 
     int32_t j = 0;
     for (j = 0 ; j < traceHeight + 1 ; j+= 20)
     {
-        int32_t i = 0;
-        for (i = 0 ; i < image->width ;  i++)
-        {
-            setPixelRGB565(image, i, j, trace->gridColour);
-        }
+        drawHorizontalLineIndexed(image,
+                                  0,
+                                  j,
+                                  image->width,
+                                  trace->gridColour);
     }
 
     //---------------------------------------------------------------------
@@ -247,7 +266,7 @@ destroyCpuTrace(
     free(trace->system);
     free(trace->time);
 
-    destroyImage(&(trace->image));
+    destroyIndexedImage(&(trace->image));
 }
 
 //-------------------------------------------------------------------------
@@ -258,7 +277,7 @@ graphCpuUsage(
     LCD_T *lcd,
     CPU_TRACE_T *trace)
 {
-    IMAGE_T *image = &(trace->image);
+    INDEXED_IMAGE_T *image = &(trace->image);
 
     CPU_STATS_T diff;
 
@@ -315,60 +334,42 @@ graphCpuUsage(
     int16_t i = 0;
     for (i = 0 ; i < trace->values ; i++)
     {
+        bool gridColumn = (trace->time[i] == 0);
         int16_t j = trace->traceHeight;
 
-        int16_t u = 0;
-        for (u = 0 ; u < trace->user[i] ; u++)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j--, trace->userGridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j--, trace->userColour);
-            }
-        }
-
-        int16_t n = 0;
-        for (n = 0 ; n < trace->nice[i] ; n++)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j--, trace->niceGridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j--, trace->niceColour);
-            }
-        }
-
-        int16_t s = 0;
-        for (s = 0 ; s < trace->system[i] ; s++)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j--, trace->systemGridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j--, trace->systemColour);
-            }
-        }
-
-        for ( ; j >= 0 ; j--)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j, trace->gridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j, trace->background);
-            }
-        }
+        j = drawTraceSegment(image,
+                             i,
+                             j,
+                             trace->user[i],
+                             gridColumn,
+                             trace->userColour,
+                             trace->userGridColour);
+
+        j = drawTraceSegment(image,
+                             i,
+                             j,
+                             trace->nice[i],
+                             gridColumn,
+                             trace->niceColour,
+                             trace->niceGridColour);
+
+        j = drawTraceSegment(image,
+                             i,
+                             j,
+                             trace->system[i],
+                             gridColumn,
+                             trace->systemColour,
+                             trace->systemGridColour);
+
+        drawTraceSegment(image,
+                         i,
+                         j,
+                         j + 1,
+                         gridColumn,
+                         trace->background,
+                         trace->gridColour);
     }
 
-    putImageLcd(lcd, 0, trace->yPosition, image);
+    putIndexedImageLcd(lcd, 0, trace->yPosition, image);
 }
 
@@ -32,7 +32,7 @@
 
 #include <stdint.h>
 
-#include "image.h"
+#include "indexedImage.h"
 #include "lcd.h"
 
 //-------------------------------------------------------------------------
@@ -64,16 +64,16 @@ typedef struct
     int8_t *time;
     CPU_STATS_T currentStats;
     CPU_STATS_T previousStats;
-    IMAGE_T image;
-    uint16_t userColour;
-    uint16_t userGridColour;
-    uint16_t niceColour;
-    uint16_t niceGridColour;
-    uint16_t systemColour;
-    uint16_t systemGridColour;
-    uint16_t foreground;
-    uint16_t background;
-    uint16_t gridColour;
+    INDEXED_IMAGE_T image;
+    uint8_t userColour;
+    uint8_t userGridColour;
+    uint8_t niceColour;
+    uint8_t niceGridColour;
+    uint8_t systemColour;
+    uint8_t systemGridColour;
+    uint8_t foreground;
+    uint8_t background;
+    uint8_t gridColour;
 } CPU_TRACE_T;
 
 //-------------------------------------------------------------------------
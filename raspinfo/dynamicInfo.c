@@ -157,6 +157,24 @@ getTemperature(
 
 //-------------------------------------------------------------------------
 
+static int16_t
+setField(
+    DYNAMIC_INFO_T *info,
+    int16_t column,
+    int16_t row,
+    const char *string,
+    uint16_t colour)
+{
+    return setTextGridString(&(info->grid),
+                             column,
+                             row,
+                             string,
+                             colour,
+                             info->background);
+}
+
+//-------------------------------------------------------------------------
+
 int16_t
 initDynamicInfo(
     int16_t width,
@@ -178,6 +196,13 @@ initDynamicInfo(
     info->foreground = packRGB565(255, 255, 255);
     info->background = packRGB565(0, 0, 0);
 
+    clearImageRGB565(image, info->background);
+
+    //---------------------------------------------------------------------
+
+    initTextGrid(&(info->grid), width / FONT_WIDTH, 2, 4, &defaultFont);
+    clearTextGrid(&(info->grid), info->background);
+
     //---------------------------------------------------------------------
 
     return yPosition + image->height;
@@ -189,6 +214,7 @@ void
 destroyDynamicInfo(
     DYNAMIC_INFO_T *info)
 {
+    destroyTextGrid(&(info->grid));
     destroyImage(&(info->image));
 }
 
@@ -199,112 +225,80 @@ showDynamicInfo(
     LCD_T *lcd,
     DYNAMIC_INFO_T *info)
 {
-    IMAGE_T *image = &(info->image);
-
-    clearImageRGB565(image, info->background);
+    TEXT_GRID_T *grid = &(info->grid);
 
     //---------------------------------------------------------------------
 
-    FONT_POSITION_T position = { .x = 0, .y = 0 };
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                "ip(",
-                                info->heading,
-                                image);
-
     char ipaddress[INET_ADDRSTRLEN];
     char networkInterface = getIpAddress(ipaddress, sizeof(ipaddress));
 
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              networkInterface,
-                              info->foreground,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                ") ",
-                                info->heading,
-                                image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                ipaddress,
-                                info->foreground,
-                                image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " memory ",
-                                info->heading,
-                                image);
-
     char memorySplit[10];
     getMemorySplit(memorySplit, sizeof(memorySplit));
 
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                memorySplit,
-                                info->foreground,
-                                image);
+    int16_t column = 0;
 
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " MB",
-                                info->foreground,
-                                image);
+    column = setField(info, column, 0, "ip(", info->heading);
 
-    //---------------------------------------------------------------------
+    setTextGridChar(grid,
+                    column++,
+                    0,
+                    networkInterface,
+                    info->foreground,
+                    info->background);
+
+    column = setField(info, column, 0, ") ", info->heading);
+    column = setField(info, column, 0, ipaddress, info->foreground);
+    column = setField(info, column, 0, " memory ", info->heading);
+    column = setField(info, column, 0, memorySplit, info->foreground);
+    column = setField(info, column, 0, " MB", info->foreground);
 
-    position.x = 0;
-    position.y += FONT_HEIGHT + 4;
+    clearTextGridRow(grid, column, 0, info->background);
 
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                "time ",
-                                info->heading,
-                                image);
+    //---------------------------------------------------------------------
 
     char timeString[32];
     getTime(timeString, sizeof(timeString));
 
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                timeString,
-                                info->foreground,
-                                image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " temperature ",
-                                info->heading,
-                                image);
-
     char temperatureString[10];
     getTemperature(temperatureString, sizeof(temperatureString));
 
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                temperatureString,
-                                info->foreground,
-                                image);
-
     uint8_t degreeSymbol = 0xF8;
 
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              degreeSymbol,
-                              info->foreground,
-                              image);
+    column = 0;
+
+    column = setField(info, column, 1, "time ", info->heading);
+    column = setField(info, column, 1, timeString, info->foreground);
+    column = setField(info, column, 1, " temperature ", info->heading);
+    column = setField(info, column, 1, temperatureString, info->foreground);
+
+    setTextGridChar(grid,
+                    column++,
+                    1,
+                    degreeSymbol,
+                    info->foreground,
+                    info->background);
 
+    column = setField(info, column, 1, "C", info->foreground);
 
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                "C",
-                                info->foreground,
-                                image);
+    clearTextGridRow(grid, column, 1, info->background);
+
+    //---------------------------------------------------------------------
+
+    // Only the cells that changed (normally the seconds) are redrawn and
+    // sent to the LCD.
+
+    int16_t count = drawTextGrid(grid, &(info->image), 0, 0);
+
+    int16_t i;
+    for (i = 0 ; i < count ; i++)
+    {
+        putImagePartLcd(lcd,
+                        0,
+                        info->yPosition,
+                        &(info->image),
+                        &(grid->dirty[i]));
+    }
 
-    putImageLcd(lcd, 0, info->yPosition, &(info->image));
+    resetImageDamage(&(info->image));
 }
 
@@ -34,6 +34,7 @@
 
 #include "image.h"
 #include "lcd.h"
+#include "textGrid.h"
 
 //-------------------------------------------------------------------------
 
@@ -41,6 +42,7 @@ typedef struct
 {
     int16_t yPosition;
     IMAGE_T image;
+    TEXT_GRID_T grid;
     uint16_t heading;
     uint16_t foreground;
     uint16_t background;
@@ -34,7 +34,9 @@
 
 #include "font.h"
 #include "image.h"
+#include "indexedImage.h"
 #include "lcd.h"
+#include "trace.h"
 #include "memoryTrace.h"
 
 //-------------------------------------------------------------------------
@@ -146,94 +148,111 @@ initMemoryTrace(
         exit(EXIT_FAILURE);
     }
 
-    if (initImage(&(trace->image), width, height, true) == false)
+    if (initIndexedImage(&(trace->image), width, height) == false)
     {
         exit(EXIT_FAILURE);
     }
 
-    trace->usedColour = packRGB565(0, 109, 44);
-    trace->buffersColour = packRGB565(102, 194, 164);
-    trace->cachedColour = packRGB565(237, 248, 251);
-    trace->foreground = packRGB565(255, 255, 255);
-    trace->background = packRGB565(0, 0, 0);
-    trace->gridColour = packRGB565(48, 48, 48);
+    // Each colour is a palette index, the RGB565 values are set below.
 
-    trace->usedGridColour = blendRGB565(63,
-                                        trace->gridColour,
-                                        trace->usedColour);
+    trace->background = 0;
+    trace->foreground = 1;
+    trace->gridColour = 2;
+    trace->usedColour = 3;
+    trace->usedGridColour = 4;
+    trace->buffersColour = 5;
+    trace->buffersGridColour = 6;
+    trace->cachedColour = 7;
+    trace->cachedGridColour = 8;
 
-    trace->buffersGridColour = blendRGB565(63,
-                                           trace->gridColour,
-                                           trace->buffersColour);
+    INDEXED_IMAGE_T *image = &(trace->image);
 
-    trace->cachedGridColour = blendRGB565(63,
-                                          trace->gridColour,
-                                          trace->cachedColour);
+    uint16_t gridColour = packRGB565(48, 48, 48);
+    uint16_t usedColour = packRGB565(0, 109, 44);
+    uint16_t buffersColour = packRGB565(102, 194, 164);
+    uint16_t cachedColour = packRGB565(237, 248, 251);
 
-    //---------------------------------------------------------------------
+    setPaletteRGB565(image, trace->background, packRGB565(0, 0, 0));
+    setPaletteRGB565(image, trace->foreground, packRGB565(255, 255, 255));
+    setPaletteRGB565(image, trace->gridColour, gridColour);
+    setPaletteRGB565(image, trace->usedColour, usedColour);
+    setPaletteRGB565(image, trace->buffersColour, buffersColour);
+    setPaletteRGB565(image, trace->cachedColour, cachedColour);
+
+    setPaletteRGB565(image,
+                     trace->usedGridColour,
+                     blendRGB565(63, gridColour, usedColour));
+
+    setPaletteRGB565(image,
+                     trace->buffersGridColour,
+                     blendRGB565(63, gridColour, buffersColour));
 
-    IMAGE_T *image = &(trace->image);
+    setPaletteRGB565(image,
+                     trace->cachedGridColour,
+                     blendRGB565(63, gridColour, cachedColour));
+
+    //---------------------------------------------------------------------
 
-    clearImageRGB565(image, trace->background);
+    clearIndexedImage(image, trace->background);
 
     uint8_t smallSquare = 0xFE;
 
     FONT_POSITION_T position = 
-        drawStringRGB565(0,
-                         image->height - 2 - FONT_HEIGHT,
-                         "Memory",
-                         trace->foreground,
-                         image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " (used:",
-                                trace->foreground,
-                                image);
-
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              smallSquare,
-                              trace->usedColour,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " buffers:",
-                                trace->foreground,
-                                image);
-
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              smallSquare,
-                              trace->buffersColour,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y,
-                                " cached:",
-                                trace->foreground,
-                                image);
-
-    position = drawCharRGB565(position.x,
-                              position.y,
-                              smallSquare,
-                              trace->cachedColour,
-                              image);
-
-    position = drawStringRGB565(position.x,
-                                position.y, ")",
-                                trace->foreground,
-                                image);
+        drawStringIndexed(0,
+                          image->height - 2 - FONT_HEIGHT,
+                          "Memory",
+                          trace->foreground,
+                          image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 " (used:",
+                                 trace->foreground,
+                                 image);
+
+    position = drawCharIndexed(position.x,
+                               position.y,
+                               smallSquare,
+                               trace->usedColour,
+                               image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 " buffers:",
+                                 trace->foreground,
+                                 image);
+
+    position = drawCharIndexed(position.x,
+                               position.y,
+                               smallSquare,
+                               trace->buffersColour,
+                               image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y,
+                                 " cached:",
+                                 trace->foreground,
+                                 image);
+
+    position = drawCharIndexed(position.x,
+                               position.y,
+                               smallSquare,
+                               trace->cachedColour,
+                               image);
+
+    position = drawStringIndexed(position.x,
+                                 position.y, ")",
+                                 trace->foreground,
+                                 image);
 
     int32_t j = 0;
     for (j = 0 ; j < traceHeight + 1 ; j+= 20)
     {
-        int32_t i = 0;
-        for (i = 0 ; i < image->width ;  i++)
-        {
-            setPixelRGB565(image, i, j, trace->gridColour);
-        }
+        drawHorizontalLineIndexed(image,
+                                  0,
+                                  j,
+                                  image->width,
+                                  trace->gridColour);
     }
 
     //---------------------------------------------------------------------
@@ -252,7 +271,7 @@ destroyMemoryTrace(
     free(trace->cached);
     free(trace->time);
 
-    destroyImage(&(trace->image));
+    destroyIndexedImage(&(trace->image));
 }
 
 //-------------------------------------------------------------------------
@@ -272,7 +291,7 @@ graphMemoryUsage(
     int8_t buffers = (memoryStats.buffers * height) / memoryStats.total;
     int8_t cached = (memoryStats.cached * height) / memoryStats.total;
 
-    IMAGE_T *image = &(trace->image);
+    INDEXED_IMAGE_T *image = &(trace->image);
 
     int16_t index;
 
@@ -302,60 +321,42 @@ graphMemoryUsage(
     int16_t i = 0;
     for (i = 0 ; i < trace->values ; i++)
     {
+        bool gridColumn = (trace->time[i] == 0);
         int16_t j = height - 1;
 
-        int16_t u = 0;
-        for (u = 0 ; u < trace->used[i] ; u++)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j--, trace->usedGridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j--, trace->usedColour);
-            }
-        }
-
-        int16_t b = 0;
-        for (b = 0 ; b < trace->buffers[i] ; b++)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j--, trace->buffersGridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j--, trace->buffersColour);
-            }
-        }
-
-        int16_t c = 0;
-        for (c = 0 ; c < trace->cached[i] ; c++)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j--, trace->cachedGridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j--, trace->cachedColour);
-            }
-        }
-
-        for ( ; j >= 0 ; j--)
-        {
-            if (((j % 20) == 0) || (trace->time[i] == 0))
-            {
-                setPixelRGB565(image, i, j, trace->gridColour);
-            }
-            else
-            {
-                setPixelRGB565(image, i, j, trace->background);
-            }
-        }
+        j = drawTraceSegment(image,
+                             i,
+                             j,
+                             trace->used[i],
+                             gridColumn,
+                             trace->usedColour,
+                             trace->usedGridColour);
+
+        j = drawTraceSegment(image,
+                             i,
+                             j,
+                             trace->buffers[i],
+                             gridColumn,
+                             trace->buffersColour,
+                             trace->buffersGridColour);
+
+        j = drawTraceSegment(image,
+                             i,
+                             j,
+                             trace->cached[i],
+                             gridColumn,
+                             trace->cachedColour,
+                             trace->cachedGridColour);
+
+        drawTraceSegment(image,
+                         i,
+                         j,
+                         j + 1,
+                         gridColumn,
+                         trace->background,
+                         trace->gridColour);
     }
 
-    putImageLcd(lcd, 0, trace->yPosition, &(trace->image));
+    putIndexedImageLcd(lcd, 0, trace->yPosition, &(trace->image));
 }
 
@@ -32,7 +32,7 @@
 
 #include <stdint.h>
 
-#include "image.h"
+#include "indexedImage.h"
 #include "lcd.h"
 
 //-------------------------------------------------------------------------
@@ -46,16 +46,16 @@ typedef struct
     int8_t *buffers;
     int8_t *cached;
     int8_t *time;
-    IMAGE_T image;
-    uint16_t usedColour;
-    uint16_t usedGridColour;
-    uint16_t buffersColour;
-    uint16_t buffersGridColour;
-    uint16_t cachedColour;
-    uint16_t cachedGridColour;
-    uint16_t foreground;
-    uint16_t background;
-    uint16_t gridColour;
+    INDEXED_IMAGE_T image;
+    uint8_t usedColour;
+    uint8_t usedGridColour;
+    uint8_t buffersColour;
+    uint8_t buffersGridColour;
+    uint8_t cachedColour;
+    uint8_t cachedGridColour;
+    uint8_t foreground;
+    uint8_t background;
+    uint8_t gridColour;
 } MEMORY_TRACE_T;
 
 //-------------------------------------------------------------------------
@@ -0,0 +1,72 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "indexedImage.h"
+#include "trace.h"
+
+//-------------------------------------------------------------------------
+
+int16_t
+drawTraceSegment(
+    INDEXED_IMAGE_T *image,
+    int16_t x,
+    int16_t y,
+    int16_t length,
+    bool gridColumn,
+    uint8_t colour,
+    uint8_t gridColour)
+{
+    if ((length <= 0) || (y < 0))
+    {
+        return y - length;
+    }
+
+    int16_t top = y - length + 1;
+
+    if (gridColumn)
+    {
+        drawVerticalLineIndexed(image, x, top, length, gridColour);
+    }
+    else
+    {
+        drawVerticalLineIndexed(image, x, top, length, colour);
+
+        int16_t j;
+        for (j = y - (y % 20) ; j >= top ; j -= 20)
+        {
+            setPixelIndexed(image, x, j, gridColour);
+        }
+    }
+
+    return top - 1;
+}
+
+//-------------------------------------------------------------------------
+
@@ -8,6 +8,7 @@
 
 #include "image.h"
 #include "lcd.h"
+#include "sprite.h"
 
 //-------------------------------------------------------------------------
 
@@ -43,17 +44,14 @@ triangle(
 //-------------------------------------------------------------------------
 
 void
-triangleImage(
-    LCD_T *lcd,
-    bool dither,
-    int16_t xoffset,
-    int16_t yoffset)
+createTriangleImage(
+    IMAGE_T *image,
+    bool dither)
 {
-    IMAGE_T image;
-    initImage(&image, 128, 128, dither);
+    initImage(image, 128, 128, dither);
 
     RGB8_T white = { 255, 255, 255 };
-    clearImageRGB(&image, &white);
+    clearImageRGB(image, &white);
 
     int16_t y;
     for (y = 0 ; y < 128 ; y++)
@@ -72,11 +70,84 @@ triangleImage(
                 b = (b * 255) / 127;
 
                 RGB8_T rgb = { r, g, b };
-                setPixelRGB(&image, x, y, &rgb);
+                setPixelRGB(image, x, y, &rgb);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// A disc with a soft edge, so that the sprite has opaque, blended and
+// transparent runs.
+//
+
+void
+createDiscSprite(
+    SPRITE_T *sprite,
+    int16_t diameter)
+{
+    uint8_t *rgba = malloc(diameter * diameter * 4);
+
+    if (rgba == NULL)
+    {
+        perror("test: memory exhausted");
+        exit(EXIT_FAILURE);
+    }
+
+    int16_t radius = diameter / 2;
+    int16_t edge = radius / 4;
+
+    int32_t outer = radius * radius;
+    int32_t inner = (radius - edge) * (radius - edge);
+
+    int16_t y;
+    for (y = 0 ; y < diameter ; y++)
+    {
+        int16_t x;
+        for (x = 0 ; x < diameter ; x++)
+        {
+            int16_t dx = x - radius;
+            int16_t dy = y - radius;
+            int32_t d2 = (dx * dx) + (dy * dy);
+
+            int32_t alpha = 0;
+
+            if (d2 <= inner)
+            {
+                alpha = 255;
+            }
+            else if (d2 < outer)
+            {
+                alpha = ((outer - d2) * 255) / (outer - inner);
             }
+
+            uint8_t *pixel = rgba + ((x + (y * diameter)) * 4);
+
+            pixel[0] = 255;
+            pixel[1] = (x * 255) / diameter;
+            pixel[2] = (y * 255) / diameter;
+            pixel[3] = alpha;
         }
     }
 
+    initSpriteRGBA(sprite, rgba, diameter, diameter, diameter * 4, 4);
+
+    free(rgba);
+}
+
+//-------------------------------------------------------------------------
+
+void
+triangleImage(
+    LCD_T *lcd,
+    bool dither,
+    int16_t xoffset,
+    int16_t yoffset)
+{
+    IMAGE_T image;
+    createTriangleImage(&image, dither);
+
     putImageLcd(lcd, xoffset, yoffset, &image);
 
     destroyImage(&image);
@@ -329,6 +400,174 @@ void testImage(
     closeLcd(&lcd);
 }
 
+//-------------------------------------------------------------------------
+//
+// Blit an image onto itself where the two areas overlap, down by 8 rows
+// and then (with a colour key) right by 8 columns, and check that every
+// pixel arrives intact.
+//
+
+bool
+checkSelfBlit(void)
+{
+    IMAGE_T image;
+    initImage(&image, 64, 64, false);
+
+    int16_t i;
+    int16_t j;
+    bool result = true;
+
+    for (j = 0 ; j < image.height ; j++)
+    {
+        fillRGB565(image.buffer + (j * image.width), j, image.width);
+    }
+
+    blitImage(&image, 0, 8, &image, 0, 0, image.width, image.height - 8);
+
+    for (j = 0 ; j < image.height - 8 ; j++)
+    {
+        uint16_t pixel;
+        getPixelRGB565(&image, image.width - 1, j + 8, &pixel);
+
+        if (pixel != j)
+        {
+            result = false;
+        }
+    }
+
+    for (j = 0 ; j < image.height ; j++)
+    {
+        for (i = 0 ; i < image.width ; i++)
+        {
+            image.buffer[i + (j * image.width)] = i + 1;
+        }
+    }
+
+    blitImageColourKey(&image,
+                       8,
+                       0,
+                       &image,
+                       0,
+                       0,
+                       image.width - 8,
+                       image.height,
+                       0);
+
+    for (i = 0 ; i < image.width - 8 ; i++)
+    {
+        uint16_t pixel;
+        getPixelRGB565(&image, i + 8, image.height - 1, &pixel);
+
+        if (pixel != i + 1)
+        {
+            result = false;
+        }
+    }
+
+    destroyImage(&image);
+
+    return result;
+}
+
+//-------------------------------------------------------------------------
+
+void testBlit(
+    uint16_t rotate)
+{
+    LCD_T lcd;
+
+    if (initLcd(&lcd, rotate) == false)
+    {
+        fprintf(stderr, "LCD initialization failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    struct timeval start_time;
+    struct timeval end_time;
+    struct timeval diff;
+
+    printf("testing blit LCD %dx%d - rotation = %d\n",
+           lcd.width,
+           lcd.height,
+           rotate);
+
+    IMAGE_T frame;
+    initImage(&frame, lcd.width, lcd.height, false);
+
+    IMAGE_T triangle;
+    createTriangleImage(&triangle, false);
+
+    SPRITE_T sprite;
+    initSpriteColourKey(&sprite, &triangle, packRGB565(255, 255, 255));
+
+    SPRITE_T disc;
+    createDiscSprite(&disc, 96);
+
+    gettimeofday(&start_time, NULL);
+
+    clearImageRGB565(&frame, packRGB565(0, 0, 0));
+
+    blitImage(&frame, -64, -64, &triangle, 0, 0, 128, 128);
+
+    blitImageColourKey(&frame,
+                       frame.width - 64,
+                       -64,
+                       &triangle,
+                       0,
+                       0,
+                       128,
+                       128,
+                       packRGB565(255, 255, 255));
+
+    int16_t x;
+    for (x = -64 ; x < frame.width ; x += 32)
+    {
+        blitSprite(&frame, x, frame.height - 96, &sprite);
+    }
+
+    blitSprite(&frame,
+               (frame.width - disc.width) / 2,
+               (frame.height - disc.height) / 2,
+               &disc);
+
+    gettimeofday(&end_time, NULL);
+    timersub(&end_time, &start_time, &diff);
+    printf("    blit took - %d.%06d seconds\n",
+           (int)diff.tv_sec,
+           (int)diff.tv_usec);
+
+    printf("    overlapping self blit - %s\n",
+           (checkSelfBlit()) ? "ok" : "FAILED");
+
+    putImageLcd(&lcd, 0, 0, &frame);
+
+    // Only the area under the sprite is sent for each step.
+
+    gettimeofday(&start_time, NULL);
+
+    for (x = 0 ; x < frame.width - disc.width ; x += 8)
+    {
+        blitSprite(&frame, x, 0, &disc);
+        putImageLcdDamaged(&lcd, 0, 0, &frame);
+    }
+
+    gettimeofday(&end_time, NULL);
+    timersub(&end_time, &start_time, &diff);
+    printf("    damaged updates took - %d.%06d seconds\n",
+           (int)diff.tv_sec,
+           (int)diff.tv_usec);
+
+    destroySprite(&disc);
+    destroySprite(&sprite);
+    destroyImage(&triangle);
+    destroyImage(&frame);
+
+    sleep(1);
+    printf("\n");
+
+    closeLcd(&lcd);
+}
+
 //-------------------------------------------------------------------------
 
 void testPwm()
@@ -373,6 +612,7 @@ main(void)
     for (angle = 0 ; angle < 360 ; angle += 90) testFilledBox(angle);
     for (angle = 0 ; angle < 360 ; angle += 90) testSetPixel(angle);
     for (angle = 0 ; angle < 360 ; angle += 90) testImage(angle);
+    for (angle = 0 ; angle < 360 ; angle += 90) testBlit(angle);
 
     testPwm();
 
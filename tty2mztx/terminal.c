@@ -0,0 +1,1000 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "font.h"
+#include "image.h"
+#include "terminal.h"
+#include "textGrid.h"
+
+//-------------------------------------------------------------------------
+//
+// The ANSI colours, normal then bright, as the Linux console shows them.
+//
+
+static const uint8_t ansiPalette[16][3] =
+{
+    {   0,   0,   0 },
+    { 170,   0,   0 },
+    {   0, 170,   0 },
+    { 170,  85,   0 },
+    {   0,   0, 170 },
+    { 170,   0, 170 },
+    {   0, 170, 170 },
+    { 170, 170, 170 },
+    {  85,  85,  85 },
+    { 255,  85,  85 },
+    {  85, 255,  85 },
+    { 255, 255,  85 },
+    {  85,  85, 255 },
+    { 255,  85, 255 },
+    {  85, 255, 255 },
+    { 255, 255, 255 }
+};
+
+//-------------------------------------------------------------------------
+//
+// The DEC special graphics characters ('_' to '~') as Unicode code points.
+// The scan lines are drawn as the horizontal line. Characters the font
+// has no glyph for are left as they are.
+//
+
+static const uint16_t lineDrawing[32] =
+{
+    0x00A0, 0x2666, 0x2592, 0x2409, 0x240C, 0x240D, 0x240A, 0x00B0,
+    0x00B1, 0x2424, 0x240B, 0x2518, 0x2510, 0x250C, 0x2514, 0x253C,
+    0x2500, 0x2500, 0x2500, 0x2500, 0x2500, 0x251C, 0x2524, 0x2534,
+    0x252C, 0x2502, 0x2264, 0x2265, 0x03C0, 0x2260, 0x00A3, 0x00B7
+};
+
+#define TERMINAL_DEFAULT_FOREGROUND 7
+#define TERMINAL_DEFAULT_BACKGROUND 0
+
+//-------------------------------------------------------------------------
+
+static uint16_t
+foregroundColour(
+    const TERMINAL_T *terminal)
+{
+    uint8_t index = (terminal->reverse) ? terminal->background
+                                        : terminal->foreground;
+
+    if (terminal->bold && (index < 8))
+    {
+        index += 8;
+    }
+
+    return terminal->palette[index];
+}
+
+//-------------------------------------------------------------------------
+
+static uint16_t
+backgroundColour(
+    const TERMINAL_T *terminal)
+{
+    uint8_t index = (terminal->reverse) ? terminal->foreground
+                                        : terminal->background;
+
+    return terminal->palette[index];
+}
+
+//-------------------------------------------------------------------------
+//
+// Blank the cells of row from first to last (inclusive) in the current
+// background colour.
+//
+
+static void
+eraseCells(
+    TERMINAL_T *terminal,
+    int16_t row,
+    int16_t first,
+    int16_t last)
+{
+    uint16_t foreground = foregroundColour(terminal);
+    uint16_t background = backgroundColour(terminal);
+
+    int16_t column;
+    for (column = first ; column <= last ; column++)
+    {
+        setTextGridChar(terminal->grid,
+                        column,
+                        row,
+                        terminal->grid->blank,
+                        foreground,
+                        background);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+scrollUp(
+    TERMINAL_T *terminal,
+    int16_t top,
+    int16_t rows)
+{
+    scrollTextGridUp(terminal->grid,
+                     top,
+                     terminal->bottom,
+                     rows,
+                     backgroundColour(terminal));
+
+    if ((top == 0) && (terminal->bottom == terminal->grid->rows - 1))
+    {
+        terminal->scrolled += rows;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+scrollDown(
+    TERMINAL_T *terminal,
+    int16_t top,
+    int16_t rows)
+{
+    scrollTextGridDown(terminal->grid,
+                       top,
+                       terminal->bottom,
+                       rows,
+                       backgroundColour(terminal));
+}
+
+//-------------------------------------------------------------------------
+//
+// Move down a line, scrolling if the cursor is at the bottom of the
+// scrolling region.
+//
+
+static void
+lineFeed(
+    TERMINAL_T *terminal)
+{
+    terminal->wrapPending = false;
+
+    if (terminal->row == terminal->bottom)
+    {
+        scrollUp(terminal, terminal->top, 1);
+    }
+    else if (terminal->row < terminal->grid->rows - 1)
+    {
+        ++(terminal->row);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+reverseLineFeed(
+    TERMINAL_T *terminal)
+{
+    terminal->wrapPending = false;
+
+    if (terminal->row == terminal->top)
+    {
+        scrollDown(terminal, terminal->top, 1);
+    }
+    else if (terminal->row > 0)
+    {
+        --(terminal->row);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+moveCursor(
+    TERMINAL_T *terminal,
+    int16_t column,
+    int16_t row)
+{
+    TEXT_GRID_T *grid = terminal->grid;
+
+    terminal->column = (column < 0) ? 0
+                     : (column >= grid->columns) ? grid->columns - 1
+                     : column;
+
+    terminal->row = (row < 0) ? 0
+                  : (row >= grid->rows) ? grid->rows - 1
+                  : row;
+
+    terminal->wrapPending = false;
+}
+
+//-------------------------------------------------------------------------
+//
+// A character written in the last column leaves the cursor there until
+// the next character, which goes on the next line.
+//
+
+static void
+putCharacter(
+    TERMINAL_T *terminal,
+    uint32_t glyph)
+{
+    if (terminal->wrapPending)
+    {
+        terminal->column = 0;
+        lineFeed(terminal);
+    }
+
+    setTextGridChar(terminal->grid,
+                    terminal->column,
+                    terminal->row,
+                    glyph,
+                    foregroundColour(terminal),
+                    backgroundColour(terminal));
+
+    if (terminal->column < terminal->grid->columns - 1)
+    {
+        ++(terminal->column);
+    }
+    else
+    {
+        terminal->wrapPending = true;
+    }
+}
+
+//-------------------------------------------------------------------------
+//
+// Put the glyphs of the UTF-8 bytes collected so far. An incomplete or
+// invalid sequence is taken byte by byte, as code page 437 characters.
+//
+
+static void
+flushUtf8(
+    TERMINAL_T *terminal)
+{
+    const FONT_T *font = terminal->grid->font;
+    const char *string = terminal->utf8;
+
+    terminal->utf8[terminal->utf8Length] = '\0';
+
+    while (*string != '\0')
+    {
+        int32_t glyph = nextGlyphFont(font, &string);
+
+        putCharacter(terminal,
+                     (glyph != -1) ? glyph : terminal->grid->blank);
+    }
+
+    terminal->utf8Length = 0;
+    terminal->utf8Expected = 0;
+}
+
+//-------------------------------------------------------------------------
+
+static void
+putAscii(
+    TERMINAL_T *terminal,
+    uint8_t c)
+{
+    const FONT_T *font = terminal->grid->font;
+    int32_t glyph = -1;
+
+    bool lineDrawingSet = (terminal->shiftOut) ? terminal->g1LineDrawing
+                                               : terminal->g0LineDrawing;
+
+    if (lineDrawingSet && (c >= '_') && (c <= '~'))
+    {
+        glyph = findGlyphFont(font, lineDrawing[c - '_']);
+    }
+
+    if (glyph == -1)
+    {
+        glyph = findGlyphFont(font, c);
+    }
+
+    putCharacter(terminal, (glyph != -1) ? glyph : terminal->grid->blank);
+}
+
+//-------------------------------------------------------------------------
+//
+// Collect the bytes of a UTF-8 sequence, putting its glyph once it is
+// complete.
+//
+
+static void
+putUtf8(
+    TERMINAL_T *terminal,
+    uint8_t c)
+{
+    if (terminal->utf8Length == 0)
+    {
+        if ((c & 0xE0) == 0xC0)
+        {
+            terminal->utf8Expected = 2;
+        }
+        else if ((c & 0xF0) == 0xE0)
+        {
+            terminal->utf8Expected = 3;
+        }
+        else if ((c & 0xF8) == 0xF0)
+        {
+            terminal->utf8Expected = 4;
+        }
+        else
+        {
+            terminal->utf8Expected = 1;
+        }
+    }
+
+    terminal->utf8[terminal->utf8Length++] = c;
+
+    if (terminal->utf8Length == terminal->utf8Expected)
+    {
+        flushUtf8(terminal);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static int16_t
+parameter(
+    const TERMINAL_T *terminal,
+    int16_t index,
+    int16_t defaultValue)
+{
+    if ((index >= terminal->parameterCount) ||
+        (terminal->parameters[index] == 0))
+    {
+        return defaultValue;
+    }
+
+    return terminal->parameters[index];
+}
+
+//-------------------------------------------------------------------------
+
+static void
+selectGraphicRendition(
+    TERMINAL_T *terminal)
+{
+    if (terminal->parameterCount == 0)
+    {
+        terminal->parameterCount = 1;
+        terminal->parameters[0] = 0;
+    }
+
+    int16_t i;
+    for (i = 0 ; i < terminal->parameterCount ; i++)
+    {
+        int16_t value = terminal->parameters[i];
+
+        if (value == 0)
+        {
+            terminal->foreground = TERMINAL_DEFAULT_FOREGROUND;
+            terminal->background = TERMINAL_DEFAULT_BACKGROUND;
+            terminal->bold = false;
+            terminal->reverse = false;
+        }
+        else if (value == 1)
+        {
+            terminal->bold = true;
+        }
+        else if (value == 7)
+        {
+            terminal->reverse = true;
+        }
+        else if (value == 22)
+        {
+            terminal->bold = false;
+        }
+        else if (value == 27)
+        {
+            terminal->reverse = false;
+        }
+        else if ((value >= 30) && (value <= 37))
+        {
+            terminal->foreground = value - 30;
+        }
+        else if (value == 39)
+        {
+            terminal->foreground = TERMINAL_DEFAULT_FOREGROUND;
+        }
+        else if ((value >= 40) && (value <= 47))
+        {
+            terminal->background = value - 40;
+        }
+        else if (value == 49)
+        {
+            terminal->background = TERMINAL_DEFAULT_BACKGROUND;
+        }
+        else if ((value >= 90) && (value <= 97))
+        {
+            terminal->foreground = value - 90 + 8;
+        }
+        else if ((value >= 100) && (value <= 107))
+        {
+            terminal->background = value - 100 + 8;
+        }
+        else if ((value == 38) || (value == 48))
+        {
+            // Extended colours: 5;n picks from the 256 colour palette,
+            // 2;r;g;b is direct colour. Only the 16 ANSI colours can be
+            // shown, the arguments are skipped either way.
+
+            int16_t mode = (i + 1 < terminal->parameterCount)
+                         ? terminal->parameters[i + 1]
+                         : 0;
+
+            if (mode == 5)
+            {
+                if (i + 2 < terminal->parameterCount)
+                {
+                    int16_t colour = terminal->parameters[i + 2];
+
+                    if (colour < 16)
+                    {
+                        if (value == 38)
+                        {
+                            terminal->foreground = colour;
+                        }
+                        else
+                        {
+                            terminal->background = colour;
+                        }
+                    }
+                }
+
+                i += 2;
+            }
+            else if (mode == 2)
+            {
+                i += 4;
+            }
+            else
+            {
+                i = terminal->parameterCount;
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+controlSequence(
+    TERMINAL_T *terminal,
+    uint8_t final)
+{
+    TEXT_GRID_T *grid = terminal->grid;
+
+    int16_t count = parameter(terminal, 0, 1);
+    int16_t column = terminal->column;
+    int16_t row = terminal->row;
+
+    if (terminal->private)
+    {
+        // Only showing and hiding the cursor (DECTCEM) is supported.
+
+        if ((parameter(terminal, 0, 0) == 25) &&
+            ((final == 'h') || (final == 'l')))
+        {
+            terminal->cursorVisible = (final == 'h');
+        }
+
+        return;
+    }
+
+    switch (final)
+    {
+    case 'A':
+
+        moveCursor(terminal, column, row - count);
+        break;
+
+    case 'B':
+
+        moveCursor(terminal, column, row + count);
+        break;
+
+    case 'C':
+
+        moveCursor(terminal, column + count, row);
+        break;
+
+    case 'D':
+
+        moveCursor(terminal, column - count, row);
+        break;
+
+    case 'E':
+
+        moveCursor(terminal, 0, row + count);
+        break;
+
+    case 'F':
+
+        moveCursor(terminal, 0, row - count);
+        break;
+
+    case 'G':
+    case '`':
+
+        moveCursor(terminal, count - 1, row);
+        break;
+
+    case 'd':
+
+        moveCursor(terminal, column, count - 1);
+        break;
+
+    case 'H':
+    case 'f':
+
+        moveCursor(terminal,
+                   parameter(terminal, 1, 1) - 1,
+                   parameter(terminal, 0, 1) - 1);
+        break;
+
+    case 'J':
+    {
+        int16_t mode = parameter(terminal, 0, 0);
+        int16_t first = (mode == 0) ? row + 1 : 0;
+        int16_t last = (mode == 1) ? row - 1 : grid->rows - 1;
+
+        if (mode == 0)
+        {
+            eraseCells(terminal, row, column, grid->columns - 1);
+        }
+        else if (mode == 1)
+        {
+            eraseCells(terminal, row, 0, column);
+        }
+
+        int16_t j;
+        for (j = first ; j <= last ; j++)
+        {
+            eraseCells(terminal, j, 0, grid->columns - 1);
+        }
+
+        break;
+    }
+    case 'K':
+    {
+        int16_t mode = parameter(terminal, 0, 0);
+
+        eraseCells(terminal,
+                   row,
+                   (mode == 0) ? column : 0,
+                   (mode == 1) ? column : grid->columns - 1);
+
+        break;
+    }
+    case 'L':
+
+        if ((row >= terminal->top) && (row <= terminal->bottom))
+        {
+            scrollDown(terminal, row, count);
+        }
+
+        break;
+
+    case 'M':
+
+        if ((row >= terminal->top) && (row <= terminal->bottom))
+        {
+            scrollUp(terminal, row, count);
+        }
+
+        break;
+
+    case 'S':
+
+        scrollUp(terminal, terminal->top, count);
+        break;
+
+    case 'T':
+
+        scrollDown(terminal, terminal->top, count);
+        break;
+
+    case '@':
+    case 'P':
+    {
+        TEXT_CELL_T *cells = grid->cells + (row * grid->columns);
+        int16_t remaining = grid->columns - column;
+
+        if (count < 0)
+        {
+            count = 0;
+        }
+        else if (count > remaining)
+        {
+            count = remaining;
+        }
+
+        if (final == '@')
+        {
+            memmove(cells + column + count,
+                    cells + column,
+                    (remaining - count) * sizeof(TEXT_CELL_T));
+
+            eraseCells(terminal, row, column, column + count - 1);
+        }
+        else
+        {
+            memmove(cells + column,
+                    cells + column + count,
+                    (remaining - count) * sizeof(TEXT_CELL_T));
+
+            eraseCells(terminal,
+                       row,
+                       grid->columns - count,
+                       grid->columns - 1);
+        }
+
+        break;
+    }
+    case 'X':
+
+        eraseCells(terminal, row, column, column + count - 1);
+        break;
+
+    case 'm':
+
+        selectGraphicRendition(terminal);
+        break;
+
+    case 'r':
+    {
+        int16_t top = parameter(terminal, 0, 1) - 1;
+        int16_t bottom = parameter(terminal, 1, grid->rows) - 1;
+
+        if ((top >= 0) && (top < bottom) && (bottom < grid->rows))
+        {
+            terminal->top = top;
+            terminal->bottom = bottom;
+            moveCursor(terminal, 0, 0);
+        }
+
+        break;
+    }
+    case 's':
+
+        terminal->savedColumn = column;
+        terminal->savedRow = row;
+        break;
+
+    case 'u':
+
+        moveCursor(terminal, terminal->savedColumn, terminal->savedRow);
+        break;
+
+    default:
+
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+static void
+escapeSequence(
+    TERMINAL_T *terminal,
+    uint8_t c)
+{
+    terminal->state = TERMINAL_STATE_GROUND;
+
+    switch (c)
+    {
+    case '[':
+
+        terminal->state = TERMINAL_STATE_CSI;
+        terminal->private = false;
+        terminal->parameterCount = 0;
+        terminal->parameters[0] = 0;
+
+        break;
+
+    case '(':
+
+        terminal->state = TERMINAL_STATE_CHARSET_G0;
+        break;
+
+    case ')':
+
+        terminal->state = TERMINAL_STATE_CHARSET_G1;
+        break;
+
+    case '7':
+
+        terminal->savedColumn = terminal->column;
+        terminal->savedRow = terminal->row;
+        break;
+
+    case '8':
+
+        moveCursor(terminal, terminal->savedColumn, terminal->savedRow);
+        break;
+
+    case 'D':
+
+        lineFeed(terminal);
+        break;
+
+    case 'E':
+
+        terminal->column = 0;
+        lineFeed(terminal);
+        break;
+
+    case 'M':
+
+        reverseLineFeed(terminal);
+        break;
+
+    case 'c':
+
+        resetTerminal(terminal);
+        break;
+
+    default:
+
+        break;
+    }
+}
+
+//-------------------------------------------------------------------------
+
+void
+initTerminal(
+    TERMINAL_T *terminal,
+    TEXT_GRID_T *grid)
+{
+    terminal->grid = grid;
+
+    int i;
+    for (i = 0 ; i < 16 ; i++)
+    {
+        terminal->palette[i] = packRGB565(ansiPalette[i][0],
+                                          ansiPalette[i][1],
+                                          ansiPalette[i][2]);
+    }
+
+    resetTerminal(terminal);
+}
+
+//-------------------------------------------------------------------------
+
+void
+resetTerminal(
+    TERMINAL_T *terminal)
+{
+    terminal->column = 0;
+    terminal->row = 0;
+    terminal->savedColumn = 0;
+    terminal->savedRow = 0;
+    terminal->top = 0;
+    terminal->bottom = terminal->grid->rows - 1;
+    terminal->wrapPending = false;
+    terminal->cursorVisible = true;
+    terminal->g0LineDrawing = false;
+    terminal->g1LineDrawing = false;
+    terminal->shiftOut = false;
+    terminal->foreground = TERMINAL_DEFAULT_FOREGROUND;
+    terminal->background = TERMINAL_DEFAULT_BACKGROUND;
+    terminal->bold = false;
+    terminal->reverse = false;
+    terminal->state = TERMINAL_STATE_GROUND;
+    terminal->private = false;
+    terminal->parameterCount = 0;
+    terminal->utf8Length = 0;
+    terminal->utf8Expected = 0;
+    terminal->scrolled = 0;
+
+    clearTextGrid(terminal->grid, backgroundColour(terminal));
+    setTextGridCursor(terminal->grid, 0, 0, true);
+}
+
+//-------------------------------------------------------------------------
+
+void
+writeTerminal(
+    TERMINAL_T *terminal,
+    const uint8_t *buffer,
+    size_t length)
+{
+    size_t i;
+    for (i = 0 ; i < length ; i++)
+    {
+        uint8_t c = buffer[i];
+
+        // Anything but a continuation byte ends a UTF-8 sequence.
+
+        if ((terminal->utf8Length > 0) && ((c & 0xC0) != 0x80))
+        {
+            flushUtf8(terminal);
+        }
+
+        // Control characters act in the middle of escape sequences too.
+
+        if (c == 0x1B)
+        {
+            terminal->state = TERMINAL_STATE_ESCAPE;
+            continue;
+        }
+        else if (c < 0x20)
+        {
+            switch (c)
+            {
+            case '\a':
+
+                break;
+
+            case '\b':
+
+                moveCursor(terminal, terminal->column - 1, terminal->row);
+                break;
+
+            case '\t':
+
+                moveCursor(terminal,
+                           (terminal->column + 8) & ~7,
+                           terminal->row);
+                break;
+
+            case '\n':
+            case '\v':
+            case '\f':
+
+                lineFeed(terminal);
+                break;
+
+            case '\r':
+
+                terminal->column = 0;
+                terminal->wrapPending = false;
+                break;
+
+            case 0x0E:
+
+                terminal->shiftOut = true;
+                break;
+
+            case 0x0F:
+
+                terminal->shiftOut = false;
+                break;
+
+            case 0x18:
+            case 0x1A:
+
+                terminal->state = TERMINAL_STATE_GROUND;
+                break;
+
+            default:
+
+                break;
+            }
+
+            continue;
+        }
+
+        //-----------------------------------------------------------------
+
+        switch (terminal->state)
+        {
+        case TERMINAL_STATE_GROUND:
+
+            if (c >= 0x80)
+            {
+                putUtf8(terminal, c);
+            }
+            else if (c != 0x7F)
+            {
+                putAscii(terminal, c);
+            }
+
+            break;
+
+        case TERMINAL_STATE_ESCAPE:
+
+            escapeSequence(terminal, c);
+            break;
+
+        case TERMINAL_STATE_CHARSET_G0:
+
+            terminal->g0LineDrawing = (c == '0');
+            terminal->state = TERMINAL_STATE_GROUND;
+            break;
+
+        case TERMINAL_STATE_CHARSET_G1:
+
+            terminal->g1LineDrawing = (c == '0');
+            terminal->state = TERMINAL_STATE_GROUND;
+            break;
+
+        case TERMINAL_STATE_CSI:
+
+            if ((c >= '0') && (c <= '9'))
+            {
+                if (terminal->parameterCount == 0)
+                {
+                    terminal->parameterCount = 1;
+                }
+
+                int16_t *value =
+                    &(terminal->parameters[terminal->parameterCount - 1]);
+                int16_t digit = c - '0';
+
+                // Checked before multiplying, so that a long parameter
+                // stops at the largest value rather than wrapping.
+
+                if (*value <= (TERMINAL_MAX_PARAMETER_VALUE - digit) / 10)
+                {
+                    *value = (*value * 10) + digit;
+                }
+                else
+                {
+                    *value = TERMINAL_MAX_PARAMETER_VALUE;
+                }
+            }
+            else if (c == ';')
+            {
+                if (terminal->parameterCount == 0)
+                {
+                    terminal->parameterCount = 1;
+                }
+
+                if (terminal->parameterCount < TERMINAL_MAX_PARAMETERS)
+                {
+                    terminal->parameters[terminal->parameterCount++] = 0;
+                }
+            }
+            else if (c == '?')
+            {
+                terminal->private = true;
+            }
+            else if ((c >= 0x40) && (c <= 0x7E))
+            {
+                controlSequence(terminal, c);
+                terminal->state = TERMINAL_STATE_GROUND;
+            }
+
+            break;
+        }
+    }
+
+    setTextGridCursor(terminal->grid,
+                      terminal->column,
+                      terminal->row,
+                      terminal->cursorVisible);
+}
+
+//-------------------------------------------------------------------------
+
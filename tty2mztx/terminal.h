@@ -0,0 +1,119 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+//-------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "textGrid.h"
+
+//-------------------------------------------------------------------------
+
+#define TERMINAL_MAX_PARAMETERS 16
+#define TERMINAL_MAX_PARAMETER_VALUE 9999
+#define TERMINAL_MAX_UTF8_LENGTH 4
+
+//-------------------------------------------------------------------------
+
+typedef enum
+{
+    TERMINAL_STATE_GROUND,
+    TERMINAL_STATE_ESCAPE,
+    TERMINAL_STATE_CSI,
+    TERMINAL_STATE_CHARSET_G0,
+    TERMINAL_STATE_CHARSET_G1
+} TERMINAL_STATE_T;
+
+//-------------------------------------------------------------------------
+//
+// A subset of a VT100 (with ANSI colours) that writes into the cells of a
+// text grid. Whenever the whole screen scrolls up a line, scrolled is
+// incremented, so that the display can be scrolled rather than redrawn.
+// The caller clears it.
+//
+// Output is UTF-8. Bytes that are not part of a valid sequence are code
+// page 437 characters, as in the strings drawn by font.h.
+//
+// Each of the G0 and G1 character sets is either ASCII or the DEC line
+// drawing set. Shift in (SI) selects G0 and shift out (SO) selects G1.
+//
+
+typedef struct
+{
+    TEXT_GRID_T *grid;
+    int16_t column;
+    int16_t row;
+    int16_t savedColumn;
+    int16_t savedRow;
+    int16_t top;
+    int16_t bottom;
+    bool wrapPending;
+    bool cursorVisible;
+    bool g0LineDrawing;
+    bool g1LineDrawing;
+    bool shiftOut;
+    uint8_t foreground;
+    uint8_t background;
+    bool bold;
+    bool reverse;
+    uint16_t palette[16];
+    TERMINAL_STATE_T state;
+    bool private;
+    int16_t parameters[TERMINAL_MAX_PARAMETERS];
+    int16_t parameterCount;
+    char utf8[TERMINAL_MAX_UTF8_LENGTH + 1];
+    int16_t utf8Length;
+    int16_t utf8Expected;
+    int16_t scrolled;
+} TERMINAL_T;
+
+//-------------------------------------------------------------------------
+
+void
+initTerminal(
+    TERMINAL_T *terminal,
+    TEXT_GRID_T *grid);
+
+void
+resetTerminal(
+    TERMINAL_T *terminal);
+
+void
+writeTerminal(
+    TERMINAL_T *terminal,
+    const uint8_t *buffer,
+    size_t length);
+
+//-------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,534 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <getopt.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "font.h"
+#include "glyphCache.h"
+#include "glyphStore.h"
+#include "image.h"
+#include "lcd.h"
+#include "loadfont.h"
+#include "terminal.h"
+#include "textGrid.h"
+
+//-------------------------------------------------------------------------
+
+#define DEFAULT_FRAME_DURATION 50000
+
+// Enough cells for every glyph of a 256 glyph font in a few colours.
+
+#define GLYPH_CACHE_SIZE 1024
+
+// Glyph bitmaps held for a font opened from a file. The glyph cache is in
+// front of the store, so it only needs the glyphs currently on screen.
+
+#define GLYPH_STORE_SIZE 512
+
+//-------------------------------------------------------------------------
+
+volatile bool run = true;
+
+//-------------------------------------------------------------------------
+
+void
+printUsage(
+    FILE *fp,
+    const char *name)
+{
+    fprintf(fp, "\n");
+    fprintf(fp, "Usage: %s <options> [command [arguments]]\n", name);
+    fprintf(fp, "\n");
+    fprintf(fp, "    --font <file> - PSF or BDF font to draw with\n");
+    fprintf(fp, "    --fps <fps> - set the most frames per second");
+    fprintf(fp,
+            " (default %d frames per second)\n",
+            1000000 / DEFAULT_FRAME_DURATION);
+    fprintf(fp, "    --portrait - display in portrait orientation");
+    fprintf(fp, " (scrolls in hardware)\n");
+    fprintf(fp, "    --smooth - draw the font at half size, anti-aliased\n");
+    fprintf(fp, "    --help - print usage and exit\n");
+    fprintf(fp, "\n");
+    fprintf(fp, "    the command defaults to $SHELL\n");
+    fprintf(fp, "\n");
+}
+
+//-------------------------------------------------------------------------
+
+static void
+signalHandler(
+    int signalNumber)
+{
+    switch (signalNumber)
+    {
+    case SIGINT:
+    case SIGTERM:
+
+        run = false;
+        break;
+    };
+}
+
+//-------------------------------------------------------------------------
+//
+// Send part of the image to the LCD when the LCD is scrolled by offset
+// lines. The part is split in two if it wraps around the bottom of the
+// LCD.
+//
+
+static void
+putScrolledPartLcd(
+    LCD_T *lcd,
+    int16_t x,
+    int16_t y,
+    int16_t offset,
+    IMAGE_T *image,
+    const IMAGE_DAMAGE_T *part)
+{
+    int16_t line = (y + part->yMin + offset) % lcd->height;
+    int16_t lines = part->yMax - part->yMin + 1;
+
+    if ((line + lines) <= lcd->height)
+    {
+        putImagePartLcd(lcd, x, line - part->yMin, image, part);
+    }
+    else
+    {
+        IMAGE_DAMAGE_T top = *part;
+        IMAGE_DAMAGE_T bottom = *part;
+
+        top.yMax = part->yMin + (lcd->height - line) - 1;
+        bottom.yMin = top.yMax + 1;
+
+        putImagePartLcd(lcd, x, line - top.yMin, image, &top);
+        putImagePartLcd(lcd, x, -(bottom.yMin), image, &bottom);
+    }
+}
+
+//-------------------------------------------------------------------------
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+    const char *program = basename(argv[0]);
+
+    suseconds_t frameDuration =  DEFAULT_FRAME_DURATION;
+    char *fontfile = NULL;
+    uint16_t rotate = 90;
+    bool smooth = false;
+
+    //---------------------------------------------------------------------
+
+    static const char *sopts = "+F:f:hps";
+    static struct option lopts[] = 
+    {
+        { "font", required_argument, NULL, 'F' },
+        { "fps", required_argument, NULL, 'f' },
+        { "help", no_argument, NULL, 'h' },
+        { "portrait", no_argument, NULL, 'p' },
+        { "smooth", no_argument, NULL, 's' },
+        { NULL, no_argument, NULL, 0 }
+    };
+
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, sopts, lopts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'F':
+
+            fontfile = optarg;
+
+            break;
+
+        case 'f':
+        {
+            int fps = atoi(optarg);
+
+            if (fps > 0)
+            {
+                frameDuration = 1000000 / fps;
+            }
+
+            break;
+        }
+        case 'h':
+
+            printUsage(stdout, program);
+            exit(EXIT_SUCCESS);
+
+            break;
+
+        case 'p':
+
+            rotate = 0;
+
+            break;
+
+        case 's':
+
+            smooth = true;
+
+            break;
+
+        default:
+
+            printUsage(stderr, program);
+            exit(EXIT_FAILURE);
+
+            break;
+        }
+    }
+
+    char *shell[] = { getenv("SHELL"), NULL };
+
+    if (shell[0] == NULL)
+    {
+        shell[0] = "/bin/sh";
+    }
+
+    char **command = (optind < argc) ? argv + optind : shell;
+
+    //---------------------------------------------------------------------
+
+    FONT_T loadedFont;
+    const FONT_T *font = &defaultFont;
+
+    if (fontfile != NULL)
+    {
+        if (openFont(fontfile, GLYPH_STORE_SIZE, &loadedFont) == false)
+        {
+            fprintf(stderr, "%s: cannot load font %s\n", program, fontfile);
+            exit(EXIT_FAILURE);
+        }
+
+        font = &loadedFont;
+    }
+
+    // Anti-aliased glyphs are blended once into the glyph cache, rather
+    // than each time they are drawn.
+
+    FONT_T smoothFont;
+
+    if (smooth)
+    {
+        if (initAntiAliasedFont(&smoothFont, font, 2) == false)
+        {
+            fprintf(stderr, "%s: cannot smooth font\n", program);
+            exit(EXIT_FAILURE);
+        }
+
+        font = &smoothFont;
+    }
+
+    GLYPH_CACHE_T cache;
+    initGlyphCache(&cache, GLYPH_CACHE_SIZE);
+
+    //---------------------------------------------------------------------
+
+    if (access("/dev/mem", R_OK | W_OK) == -1)
+    {
+        fprintf(stderr,
+                "%s: read and write access to /dev/mem required\n",
+                program);
+        exit(EXIT_FAILURE);
+    }
+
+    LCD_T lcd;
+
+    if (initLcd(&lcd, rotate) == false)
+    {
+        fprintf(stderr, "LCD initialization failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    //---------------------------------------------------------------------
+
+    TEXT_GRID_T grid;
+    initTextGrid(&grid,
+                 lcd.width / font->width,
+                 lcd.height / font->height,
+                 0,
+                 font);
+
+    grid.cache = &cache;
+
+    IMAGE_T image;
+    initImage(&image,
+              grid.columns * font->width,
+              grid.rows * font->height,
+              false);
+
+    int16_t xOffset = (lcd.width - image.width) / 2;
+    int16_t yOffset = (lcd.height - image.height) / 2;
+
+    TERMINAL_T terminal;
+    initTerminal(&terminal, &grid);
+
+    // Line feeds at the bottom of the screen scroll the LCD, so that only
+    // the new line need be sent. The grid has to fill the LCD from top to
+    // bottom for this to work.
+
+    bool hardwareScroll = (image.height == lcd.height) &&
+                          scrollLcd(&lcd, 0);
+    int16_t scrollOffset = 0;
+
+    //---------------------------------------------------------------------
+
+    struct winsize size;
+    memset(&size, 0, sizeof(size));
+
+    size.ws_col = grid.columns;
+    size.ws_row = grid.rows;
+    size.ws_xpixel = image.width;
+    size.ws_ypixel = image.height;
+
+    int master = -1;
+    pid_t child = forkpty(&master, NULL, NULL, &size);
+
+    if (child == -1)
+    {
+        perror("forkpty");
+        closeLcd(&lcd);
+        exit(EXIT_FAILURE);
+    }
+    else if (child == 0)
+    {
+        setenv("TERM", "vt100", 1);
+        execvp(command[0], command);
+
+        perror(command[0]);
+        _exit(127);
+    }
+
+    //---------------------------------------------------------------------
+
+    // Keys pressed are passed through to the command.
+
+    bool forward = isatty(STDIN_FILENO);
+    struct termios original;
+
+    if (forward)
+    {
+        tcgetattr(STDIN_FILENO, &original);
+
+        struct termios raw = original;
+        cfmakeraw(&raw);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+
+    //---------------------------------------------------------------------
+
+    if (signal(SIGINT, signalHandler) == SIG_ERR)
+    {
+        perror("installing SIGINT signal handler");
+        run = false;
+    }
+
+    if (signal(SIGTERM, signalHandler) == SIG_ERR)
+    {
+        perror("installing SIGTERM signal handler");
+        run = false;
+    }
+
+    //---------------------------------------------------------------------
+
+    // Output is drawn at most once a frame, so a burst of output is drawn
+    // (and scrolled) in one go.
+
+    uint8_t buffer[4096];
+    bool changed = true;
+
+    struct timeval lastDraw;
+    timerclear(&lastDraw);
+
+    while (run)
+    {
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(master, &readSet);
+
+        if (forward)
+        {
+            FD_SET(STDIN_FILENO, &readSet);
+        }
+
+        struct timeval timeout = { 0, frameDuration };
+
+        int ready = select(master + 1, &readSet, NULL, NULL, &timeout);
+
+        if ((ready == -1) && (errno != EINTR))
+        {
+            break;
+        }
+
+        if ((ready > 0) && FD_ISSET(master, &readSet))
+        {
+            ssize_t length = read(master, buffer, sizeof(buffer));
+
+            if (length <= 0)
+            {
+                // The command has finished.
+
+                break;
+            }
+
+            writeTerminal(&terminal, buffer, length);
+            changed = true;
+        }
+
+        if ((ready > 0) && forward && FD_ISSET(STDIN_FILENO, &readSet))
+        {
+            ssize_t length = read(STDIN_FILENO, buffer, sizeof(buffer));
+
+            if (length > 0)
+            {
+                write(master, buffer, length);
+            }
+        }
+
+        //-----------------------------------------------------------------
+
+        struct timeval now;
+        struct timeval elapsed;
+
+        gettimeofday(&now, NULL);
+        timersub(&now, &lastDraw, &elapsed);
+
+        if ((changed == false) ||
+            ((elapsed.tv_sec == 0) && (elapsed.tv_usec < frameDuration)))
+        {
+            continue;
+        }
+
+        lastDraw = now;
+        changed = false;
+
+        //-----------------------------------------------------------------
+
+        if (hardwareScroll &&
+            (terminal.scrolled > 0) &&
+            (terminal.scrolled < grid.rows))
+        {
+            rollTextGrid(&grid, &image, 0, terminal.scrolled);
+
+            scrollOffset = (scrollOffset + (terminal.scrolled * font->height))
+                         % lcd.height;
+
+            scrollLcd(&lcd, scrollOffset);
+        }
+
+        terminal.scrolled = 0;
+
+        int16_t count = drawTextGrid(&grid, &image, 0, 0);
+
+        int16_t i;
+        for (i = 0 ; i < count ; i++)
+        {
+            putScrolledPartLcd(&lcd,
+                               xOffset,
+                               yOffset,
+                               scrollOffset,
+                               &image,
+                               &(grid.dirty[i]));
+        }
+
+        resetImageDamage(&image);
+    }
+
+    //---------------------------------------------------------------------
+
+    if (forward)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &original);
+    }
+
+    close(master);
+    kill(child, SIGHUP);
+    waitpid(child, NULL, 0);
+
+    //---------------------------------------------------------------------
+
+    destroyTextGrid(&grid);
+    destroyGlyphCache(&cache);
+    destroyImage(&image);
+
+    if (smooth)
+    {
+        destroyFont(&smoothFont);
+    }
+
+    if (fontfile != NULL)
+    {
+        const GLYPH_STORE_T *store = loadedFont.store;
+
+        fprintf(stderr,
+                "%s: font glyphs %u hits, %u misses\n",
+                program,
+                store->hits,
+                store->misses);
+
+        destroyFont(&loadedFont);
+    }
+
+    //---------------------------------------------------------------------
+
+    if (hardwareScroll)
+    {
+        scrollLcd(&lcd, 0);
+    }
+
+    clearLcd(&lcd, packRGB(0, 0, 0));
+    closeLcd(&lcd);
+
+    //---------------------------------------------------------------------
+
+    return 0 ;
+}
+
+//-------------------------------------------------------------------------
+
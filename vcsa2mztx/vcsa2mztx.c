@@ -0,0 +1,560 @@
+//-------------------------------------------------------------------------
+//
+// The MIT License (MIT)
+//
+// Copyright (c) 2014 Andrew Duncan
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the
+// "Software"), to deal in the Software without restriction, including
+// without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to
+// permit persons to whom the Software is furnished to do so, subject to
+// the following conditions:
+//
+// The above copyright notice and this permission notice shall be included
+// in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+// OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+// CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+// TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+// SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//
+//-------------------------------------------------------------------------
+
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <bsd/libutil.h>
+
+#include <sys/time.h>
+
+#include "font.h"
+#include "image.h"
+#include "lcd.h"
+#include "loadfont.h"
+#include "syslogUtilities.h"
+#include "textGrid.h"
+
+//-------------------------------------------------------------------------
+
+#define DEFAULT_FRAME_DURATION 100000
+
+//-------------------------------------------------------------------------
+//
+// /dev/vcsaN holds a four byte header (lines, columns and the cursor
+// column and row) followed by a character and an attribute byte for each
+// cell. Both the lines and columns are bytes, so this is the largest it
+// can be.
+//
+
+#define VCSA_HEADER_SIZE 4
+#define VCSA_MAXIMUM_SIZE (VCSA_HEADER_SIZE + (2 * 255 * 255))
+
+//-------------------------------------------------------------------------
+//
+// The attribute byte is in VGA text mode order. The foreground is the low
+// four bits, the background the next three.
+//
+
+static const uint8_t vgaPalette[16][3] =
+{
+    {   0,   0,   0 },
+    {   0,   0, 170 },
+    {   0, 170,   0 },
+    {   0, 170, 170 },
+    { 170,   0,   0 },
+    { 170,   0, 170 },
+    { 170,  85,   0 },
+    { 170, 170, 170 },
+    {  85,  85,  85 },
+    {  85,  85, 255 },
+    {  85, 255,  85 },
+    {  85, 255, 255 },
+    { 255,  85,  85 },
+    { 255,  85, 255 },
+    { 255, 255,  85 },
+    { 255, 255, 255 }
+};
+
+//-------------------------------------------------------------------------
+
+volatile bool run = true;
+
+//-------------------------------------------------------------------------
+
+void
+printUsage(
+    FILE *fp,
+    const char *name)
+{
+    fprintf(fp, "\n");
+    fprintf(fp, "Usage: %s <options>\n", name);
+    fprintf(fp, "\n");
+    fprintf(fp, "    --console <n> - mirror /dev/vcsa<n>");
+    fprintf(fp, " (default is the foreground console)\n");
+    fprintf(fp, "    --daemon - start in the background as a daemon\n");
+    fprintf(fp, "    --font <file> - PSF or BDF font to draw with\n");
+    fprintf(fp, "    --fps <fps> - set how many times a second the console");
+    fprintf(fp,
+            " is read (default %d)\n",
+            1000000 / DEFAULT_FRAME_DURATION);
+    fprintf(fp, "    --pidfile <pidfile> - create and lock PID file (if being run as a daemon)\n");
+    fprintf(fp, "    --portrait - display in portrait orientation\n");
+    fprintf(fp, "    --help - print usage and exit\n");
+    fprintf(fp, "\n");
+}
+
+//-------------------------------------------------------------------------
+
+static void
+signalHandler(
+    int signalNumber)
+{
+    switch (signalNumber)
+    {
+    case SIGINT:
+    case SIGTERM:
+
+        run = false;
+        break;
+    };
+}
+
+//-------------------------------------------------------------------------
+//
+// When the console is bigger than the LCD, move the window onto it (as
+// little as possible) to keep the cursor in view.
+//
+
+static int16_t
+followCursor(
+    int16_t first,
+    int16_t cursor,
+    int16_t window,
+    int16_t size)
+{
+    if (cursor < first)
+    {
+        first = cursor;
+    }
+    else if (cursor >= (first + window))
+    {
+        first = cursor - window + 1;
+    }
+
+    if (first > (size - window))
+    {
+        first = size - window;
+    }
+
+    if (first < 0)
+    {
+        first = 0;
+    }
+
+    return first;
+}
+
+//-------------------------------------------------------------------------
+
+int
+main(
+    int argc,
+    char *argv[])
+{
+    const char *program = basename(argv[0]);
+
+    suseconds_t frameDuration =  DEFAULT_FRAME_DURATION;
+    bool isDaemon =  false;
+    char *pidfile = NULL;
+    char *fontfile = NULL;
+    char device[32] = "/dev/vcsa";
+    uint16_t rotate = 90;
+
+    //---------------------------------------------------------------------
+
+    static const char *sopts = "c:dF:f:hp:P";
+    static struct option lopts[] = 
+    {
+        { "console", required_argument, NULL, 'c' },
+        { "daemon", no_argument, NULL, 'd' },
+        { "font", required_argument, NULL, 'F' },
+        { "fps", required_argument, NULL, 'f' },
+        { "help", no_argument, NULL, 'h' },
+        { "pidfile", required_argument, NULL, 'p' },
+        { "portrait", no_argument, NULL, 'P' },
+        { NULL, no_argument, NULL, 0 }
+    };
+
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, sopts, lopts, NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+
+            snprintf(device, sizeof(device), "/dev/vcsa%d", atoi(optarg));
+
+            break;
+
+        case 'd':
+
+            isDaemon = true;
+            break;
+
+        case 'F':
+
+            fontfile = optarg;
+
+            break;
+
+        case 'f':
+        {
+            int fps = atoi(optarg);
+
+            if (fps > 0)
+            {
+                frameDuration = 1000000 / fps;
+            }
+
+            break;
+        }
+        case 'h':
+
+            printUsage(stdout, program);
+            exit(EXIT_SUCCESS);
+
+            break;
+
+        case 'p':
+
+            pidfile = optarg;
+
+            break;
+
+        case 'P':
+
+            rotate = 0;
+
+            break;
+
+        default:
+
+            printUsage(stderr, program);
+            exit(EXIT_FAILURE);
+
+            break;
+        }
+    }
+
+    //---------------------------------------------------------------------
+
+    FONT_T loadedFont;
+    const FONT_T *font = &defaultFont;
+
+    if (fontfile != NULL)
+    {
+        if (loadFont(fontfile, &loadedFont) == false)
+        {
+            fprintf(stderr, "%s: cannot load font %s\n", program, fontfile);
+            exit(EXIT_FAILURE);
+        }
+
+        font = &loadedFont;
+    }
+
+    //---------------------------------------------------------------------
+
+    struct pidfh *pfh = NULL;
+
+    if (isDaemon)
+    {
+        if (pidfile != NULL)
+        {
+            pid_t otherpid;
+            pfh = pidfile_open(pidfile, 0600, &otherpid);
+
+            if (pfh == NULL)
+            {
+                fprintf(stderr,
+                        "%s is already running %jd\n",
+                        program,
+                        (intmax_t)otherpid);
+                exit(EXIT_FAILURE);
+            }
+        }
+        
+        if (daemon(0, 0) == -1)
+        {
+            fprintf(stderr, "Cannot daemonize\n");
+            exitAndRemovePidFile(EXIT_FAILURE, pfh);
+        }
+
+        if (pfh)
+        {
+            pidfile_write(pfh);
+        }
+
+        openlog(program, LOG_PID, LOG_USER);
+    }
+
+    //---------------------------------------------------------------------
+
+    if (signal(SIGINT, signalHandler) == SIG_ERR)
+    {
+        perrorLog(isDaemon, program, "installing SIGINT signal handler");
+        exitAndRemovePidFile(EXIT_FAILURE, pfh);
+    }
+
+    //---------------------------------------------------------------------
+
+    if (signal(SIGTERM, signalHandler) == SIG_ERR)
+    {
+        perrorLog(isDaemon, program, "installing SIGTERM signal handler");
+        exitAndRemovePidFile(EXIT_FAILURE, pfh);
+    }
+
+    //---------------------------------------------------------------------
+
+    int vcsafd = open(device, O_RDONLY);
+
+    if (vcsafd == -1)
+    {
+        perrorLog(isDaemon, program, "cannot open console");
+        exitAndRemovePidFile(EXIT_FAILURE, pfh);
+    }
+
+    uint8_t *vcsa = malloc(VCSA_MAXIMUM_SIZE);
+
+    if (vcsa == NULL)
+    {
+        perrorLog(isDaemon, program, "failed to create console buffer");
+        exitAndRemovePidFile(EXIT_FAILURE, pfh);
+    }
+
+    //---------------------------------------------------------------------
+
+    LCD_T lcd;
+
+    if (initLcd(&lcd, rotate) == false)
+    {
+        messageLog(isDaemon,
+                   program,
+                   LOG_ERR,
+                   "LCD initialization failed");
+        exitAndRemovePidFile(EXIT_FAILURE, pfh);
+    }
+
+    //---------------------------------------------------------------------
+
+    uint16_t palette[16];
+
+    int i;
+    for (i = 0 ; i < 16 ; i++)
+    {
+        palette[i] = packRGB565(vgaPalette[i][0],
+                                vgaPalette[i][1],
+                                vgaPalette[i][2]);
+    }
+
+    //---------------------------------------------------------------------
+
+    // The grid is created (and recreated if the console changes size) as
+    // the console is read.
+
+    TEXT_GRID_T grid;
+    IMAGE_T image;
+
+    memset(&grid, 0, sizeof(grid));
+    memset(&image, 0, sizeof(image));
+
+    int16_t lines = 0;
+    int16_t columns = 0;
+    int16_t firstColumn = 0;
+    int16_t firstRow = 0;
+    int16_t xOffset = 0;
+    int16_t yOffset = 0;
+
+    //---------------------------------------------------------------------
+
+    struct timeval start_time;
+    struct timeval end_time;
+    struct timeval elapsed_time;
+
+    //---------------------------------------------------------------------
+
+    while (run)
+    {
+        gettimeofday(&start_time, NULL);
+
+        //-----------------------------------------------------------------
+
+        ssize_t length = pread(vcsafd, vcsa, VCSA_MAXIMUM_SIZE, 0);
+
+        if (length < VCSA_HEADER_SIZE)
+        {
+            perrorLog(isDaemon, program, "cannot read console");
+            break;
+        }
+
+        if ((vcsa[0] != lines) || (vcsa[1] != columns))
+        {
+            lines = vcsa[0];
+            columns = vcsa[1];
+
+            int16_t gridColumns = lcd.width / font->width;
+            int16_t gridRows = lcd.height / font->height;
+
+            if (gridColumns > columns)
+            {
+                gridColumns = columns;
+            }
+
+            if (gridRows > lines)
+            {
+                gridRows = lines;
+            }
+
+            destroyTextGrid(&grid);
+            destroyImage(&image);
+
+            if ((gridColumns > 0) && (gridRows > 0))
+            {
+                initTextGrid(&grid, gridColumns, gridRows, 0, font);
+                initImage(&image,
+                          gridColumns * font->width,
+                          gridRows * font->height,
+                          false);
+            }
+
+            xOffset = (lcd.width - image.width) / 2;
+            yOffset = (lcd.height - image.height) / 2;
+
+            firstColumn = 0;
+            firstRow = 0;
+
+            clearLcd(&lcd, packRGB(0, 0, 0));
+        }
+
+        if ((grid.columns == 0) ||
+            (grid.rows == 0) ||
+            (length < (VCSA_HEADER_SIZE + (2 * lines * columns))))
+        {
+            usleep(frameDuration);
+            continue;
+        }
+
+        //-----------------------------------------------------------------
+
+        int16_t x = (vcsa[2] < columns) ? vcsa[2] : columns - 1;
+        int16_t y = (vcsa[3] < lines) ? vcsa[3] : lines - 1;
+
+        firstColumn = followCursor(firstColumn, x, grid.columns, columns);
+        firstRow = followCursor(firstRow, y, grid.rows, lines);
+
+        int16_t row;
+        for (row = 0 ; row < grid.rows ; row++)
+        {
+            const uint8_t *cell = vcsa
+                                + VCSA_HEADER_SIZE
+                                + (2 * (firstColumn
+                                        + ((firstRow + row) * columns)));
+
+            int16_t column;
+            for (column = 0 ; column < grid.columns ; column++)
+            {
+                uint8_t attribute = cell[1];
+
+                setTextGridChar(&grid,
+                                column,
+                                row,
+                                cell[0],
+                                palette[attribute & 0x0F],
+                                palette[(attribute >> 4) & 0x07]);
+
+                cell += 2;
+            }
+        }
+
+        //-----------------------------------------------------------------
+
+        setTextGridCursor(&grid, x - firstColumn, y - firstRow, true);
+
+        int16_t count = drawTextGrid(&grid, &image, 0, 0);
+
+        for (i = 0 ; i < count ; i++)
+        {
+            putImagePartLcd(&lcd, xOffset, yOffset, &image, &(grid.dirty[i]));
+        }
+
+        resetImageDamage(&image);
+
+        //-----------------------------------------------------------------
+
+        gettimeofday(&end_time, NULL);
+        timersub(&end_time, &start_time, &elapsed_time);
+
+        if (elapsed_time.tv_sec == 0)
+        {
+            if (elapsed_time.tv_usec < frameDuration)
+            {
+                usleep(frameDuration -  elapsed_time.tv_usec);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+
+    close(vcsafd);
+    free(vcsa);
+
+    destroyTextGrid(&grid);
+    destroyImage(&image);
+
+    if (font == &loadedFont)
+    {
+        destroyFont(&loadedFont);
+    }
+
+    //---------------------------------------------------------------------
+
+    clearLcd(&lcd, packRGB(0, 0, 0));
+    closeLcd(&lcd);
+
+    //---------------------------------------------------------------------
+
+    messageLog(isDaemon, program, LOG_INFO, "exiting");
+
+    if (isDaemon)
+    {
+        closelog();
+    }
+
+    if (pfh)
+    {
+        pidfile_remove(pfh);
+    }
+
+    //---------------------------------------------------------------------
+
+    return 0 ;
+}
+
+//-------------------------------------------------------------------------
+
@@ -48,9 +48,11 @@
 #include <sys/mman.h>
 #include <sys/time.h>
 
+#include "bilinear.h"
 #include "image.h"
 #include "lcd.h"
 #include "syslogUtilities.h"
+#include "workerPool.h"
 #include "yuv.h"
 
 //-------------------------------------------------------------------------
@@ -68,6 +70,13 @@ typedef struct
     uint8_t *buffer;
 } VIDEO_BUFFER_T;
 
+typedef struct
+{
+    IMAGE_T *image;
+    const uint8_t *yuyv;
+    bool greyscale;
+} CONVERT_JOB_T;
+
 //-------------------------------------------------------------------------
 
 volatile bool run = true;
@@ -82,6 +91,7 @@ printUsage(
     fprintf(fp, "\n");
     fprintf(fp, "Usage: %s <options>\n", name);
     fprintf(fp, "\n");
+    fprintf(fp, "    --bilinear - scale the video to fit the LCD\n");
     fprintf(fp, "    --daemon - start in the background as a daemon\n");
     fprintf(fp, "    --fps <fps> - set desired frames per second");
     fprintf(fp, " (default %d frames per second)\n", DEFAULT_FPS);
@@ -114,6 +124,19 @@ signalHandler(
 
 //-------------------------------------------------------------------------
 
+static void
+convertJob(
+    void *context,
+    int32_t start,
+    int32_t end)
+{
+    const CONVERT_JOB_T *job = context;
+
+    convertRowsYUYV(job->image, job->yuyv, job->greyscale, start, end);
+}
+
+//-------------------------------------------------------------------------
+
 bool
 initVideo(
     bool isDaemon,
@@ -227,6 +250,7 @@ main(
 {
     const char *program = basename(argv[0]);
 
+    bool bilinear = false;
     bool greyscale = false;
     int width = DEFAULT_WIDTH;
     int height = DEFAULT_HEIGHT;
@@ -238,9 +262,10 @@ main(
 
     //---------------------------------------------------------------------
 
-    static const char *sopts = "df:ghH:p:s:W:";
+    static const char *sopts = "bdf:ghH:p:s:W:";
     static struct option lopts[] = 
     {
+        { "bilinear", no_argument, NULL, 'b' },
         { "daemon", no_argument, NULL, 'd' },
         { "fps", required_argument, NULL, 'f' },
         { "greyscale", no_argument, NULL, 'g' },
@@ -258,6 +283,12 @@ main(
     {
         switch (opt)
         {
+        case 'b':
+
+            bilinear = true;
+
+            break;
+
         case 'd':
 
             isDaemon = true;
@@ -440,8 +471,46 @@ main(
         exitAndRemovePidFile(EXIT_FAILURE, pfh);
     }
 
-    int16_t xOffset = (lcd.width - width) / 2;
-    int16_t yOffset = (lcd.height - height) / 2;
+    // With --bilinear each frame is scaled to fit the LCD before it is
+    // sent, otherwise it is shown at the size it was captured.
+
+    BILINEAR_T bl;
+    IMAGE_T scaled;
+    IMAGE_T *shown = &image;
+
+    if (bilinear)
+    {
+        initBilinear(&bl, lcd.width, lcd.height, width, height, true);
+
+        if (initImage(&scaled,
+                      bl.destinationWidth,
+                      bl.destinationHeight,
+                      false) == false)
+        {
+            close(vfd);
+
+            exitAndRemovePidFile(EXIT_FAILURE, pfh);
+        }
+
+        shown = &scaled;
+    }
+
+    int16_t xOffset = (lcd.width - shown->width) / 2;
+    int16_t yOffset = (lcd.height - shown->height) / 2;
+
+    WORKER_POOL_T pool;
+
+    if (initWorkerPool(&pool, 0) == false)
+    {
+        messageLog(isDaemon,
+                   program,
+                   LOG_ERR,
+                   "cannot start worker threads");
+
+        close(vfd);
+
+        exitAndRemovePidFile(EXIT_FAILURE, pfh);
+    }
 
     //---------------------------------------------------------------------
 
@@ -616,51 +685,27 @@ main(
 
         if ((frame % sample) == 0)
         {
-            uint8_t *yuyv = videoBuffers[buffer.index].buffer;
+            CONVERT_JOB_T job =
+            {
+                &image,
+                videoBuffers[buffer.index].buffer,
+                greyscale
+            };
 
-            int y;
-            for (y = 0 ; y < height ; y++)
+            runWorkerPool(&pool, convertJob, &job, image.height);
+
+            if (bilinear)
             {
-                int x;
-                for (x = 0 ; x < width ; x++)
-                {
-                    size_t offset =  2 * (x + (y * width));
-
-                    RGB8_T rgb;
-
-                    if (greyscale)
-                    {
-                        uint8_t grey = yuyv[offset];
-
-                        rgb.red = grey;
-                        rgb.green = grey;
-                        rgb.blue = grey;
-                    }
-                    else
-                    {
-                        YUV8_T yuv;
-
-                        yuv.y = yuyv[offset];
-
-                        if (offset % 4)
-                        {
-                            yuv.u = yuyv[offset - 1];
-                            yuv.v = yuyv[offset + 1];
-                        }
-                        else
-                        {
-                            yuv.u = yuyv[offset + 1];
-                            yuv.v = yuyv[offset + 3];
-                        }
-
-                        yuvToRgb(&yuv, &rgb);
-                    }
-
-                    setPixelRGB(&image, x, y, &rgb);
-                }
+                resizeBilinear(&bl,
+                               scaled.buffer,
+                               scaled.width * sizeof(uint16_t),
+                               image.buffer,
+                               image.width * sizeof(uint16_t));
             }
 
-            putImageLcd(&lcd, xOffset, yOffset, &image);
+            damageImage(shown, 0, 0, shown->width, shown->height);
+
+            putImageLcd(&lcd, xOffset, yOffset, shown);
         }
 
         ++frame;
@@ -695,8 +740,15 @@ main(
 
     //---------------------------------------------------------------------
 
+    destroyWorkerPool(&pool);
     destroyImage(&image);
 
+    if (bilinear)
+    {
+        destroyBilinear(&bl);
+        destroyImage(&scaled);
+    }
+
     //---------------------------------------------------------------------
 
     buf_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
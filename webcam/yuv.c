@@ -130,3 +130,60 @@ lookupYUV555toRGB565(
     return lookup->lookup[yuv];
 }
 
+//-------------------------------------------------------------------------
+//
+// No damage is recorded, so that bands of rows can be converted by
+// different threads at the same time.
+//
+
+void
+convertRowsYUYV(
+    IMAGE_T *image,
+    const uint8_t *yuyv,
+    bool greyscale,
+    int16_t start,
+    int16_t end)
+{
+    int16_t y;
+    for (y = start ; y < end ; y++)
+    {
+        int16_t x;
+        for (x = 0 ; x < image->width ; x++)
+        {
+            size_t offset =  2 * (x + (y * image->width));
+
+            RGB8_T rgb;
+
+            if (greyscale)
+            {
+                uint8_t grey = yuyv[offset];
+
+                rgb.red = grey;
+                rgb.green = grey;
+                rgb.blue = grey;
+            }
+            else
+            {
+                YUV8_T yuv;
+
+                yuv.y = yuyv[offset];
+
+                if (offset % 4)
+                {
+                    yuv.u = yuyv[offset - 1];
+                    yuv.v = yuyv[offset + 1];
+                }
+                else
+                {
+                    yuv.u = yuyv[offset + 1];
+                    yuv.v = yuyv[offset + 3];
+                }
+
+                yuvToRgb(&yuv, &rgb);
+            }
+
+            image->setPixel(image, x, y, &rgb);
+        }
+    }
+}
+
@@ -77,4 +77,17 @@ lookupYUV555toRGB565(
 
 //-------------------------------------------------------------------------
 
+// Convert rows start to end - 1 of a packed YUYV frame the same size as
+// the image. The caller must damage the image.
+
+void
+convertRowsYUYV(
+    IMAGE_T *image,
+    const uint8_t *yuyv,
+    bool greyscale,
+    int16_t start,
+    int16_t end);
+
+//-------------------------------------------------------------------------
+
 #endif